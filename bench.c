@@ -0,0 +1,385 @@
+/*
+* Benchmark suite for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Program description: Times every stepping engine (board of Cells, bit-packed board with each SIMD kernel the CPU
+                        supports, sparse plane, HashLife and the nibble-packed Generations board) for every thread count given on:
+                            - random square boards from 64x64 up to 32768x32768 at densities from 5% to 50%
+                            - the pattern files shipped with the game (run with their own boundary conditions)
+                        Each case is run for whole batches of generations until at least --min-time seconds have
+                        elapsed. The time per cell per generation (cells of the board, whatever the engine stores)
+                        and an estimate of the memory bandwidth (bytes each engine must read and write per
+                        generation) are printed and written to a JSON file to compare between releases.
+                        The bit-packed board is also timed advancing each --block T generations per pass over the
+                        board (temporal blocking), its bandwidth estimate divided by T as the board is only read
+                        and written once a pass. Cases needing more than --max-memory bytes are skipped.
+                        Every case runs the rule given by --rule (B3/S23 by default), to compare the specialised
+                        kernels with the general ones.
+                        A Generations rule (e.g. B2/S/C3) is only run by the Generations board.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "conway.h"
+#include "bitboard.h"
+#include "sparse.h"
+#include "hashlife.h"
+#include "rules.h"
+#include "generations.h"
+#include "engine.h"
+#include "board_memory.h"
+
+#define BENCH_OUTPUT "bench.json" // Default file to write the results to
+#define MAX_THREAD_COUNTS 16 // Most thread counts that can be given with --threads
+#define MAX_BLOCKS 16 // Most temporal blocking depths that can be given with --block
+#define MAX_BATCH ((long long)1 << 20) // Most generations run in one batch
+
+static const int board_sizes[] = {64, 256, 1024, 4096, 16384, 32768};
+static const double densities[] = {0.05, 0.10, 0.25, 0.50};
+static const char *pattern_files[] = {"pulsar.txt", "Penta-decathlon.txt", "glider.txt", "spaceship.txt",
+                                      "glider_gun.txt", "die_hard.txt"};
+
+#define N_SIZES (int)(sizeof(board_sizes)/sizeof(board_sizes[0]))
+#define N_DENSITIES (int)(sizeof(densities)/sizeof(densities[0]))
+#define N_PATTERNS (int)(sizeof(pattern_files)/sizeof(pattern_files[0]))
+
+// Define a structure with alias 'BenchCase' for one timed run
+typedef struct bench_case{
+    const char *workload; // "random" or the pattern file
+    int n_rows, n_cols;
+    double density; // fraction of cells alive at the start (random boards only)
+    int fixed_bounds; // boundary conditions of the bounded engines
+    int engine, kernel, n_threads;
+    int block; // generations the bit-packed board advances per pass (see step_bitboard_blocked), 1 for the others
+    unsigned birth_mask, survive_mask; // rule run (see parse_rule)
+    int n_states; // states of a Generations rule, 2 for a Life-like rule
+    long long n_generations;
+    double seconds;
+    double ns_per_cell; // nanoseconds per cell per generation
+    double bandwidth; // estimated bytes per second read and written, negative if not estimated
+    long long cells_alive; // after the last generation
+}BenchCase;
+
+static double now_seconds(void){
+    // Wall clock time in seconds
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9*(double)t.tv_nsec;
+}
+
+static BitBoard* random_bitboard(int n, double density, uint64_t seed, ThreadPool *pool){
+    // Create a n*n bit-packed board with each cell alive with probability density (same board for the same seed)
+    BitBoard *bb = create_bitboard(n, n);
+    fill_bitboard_random(bb, seed, density, pool);
+    return bb;
+}
+
+static double engine_memory(int engine, int n_rows, int n_cols){
+    // Estimate of the bytes an engine needs for a n_rows*n_cols board (the sparse plane may grow beyond this)
+    switch (engine){
+        case ENGINE_BOARD:
+            return 2.0 * ((double)n_rows + 2) * ((double)n_cols + 2) * sizeof(Cell);
+        case ENGINE_BITBOARD:
+            return 2.0 * n_rows * ((n_cols + BITS_PER_WORD - 1) / BITS_PER_WORD) * sizeof(uint64_t);
+        case ENGINE_SPARSE:
+            return (((double)n_rows / CHUNK_SIZE) + 2) * (((double)n_cols / CHUNK_SIZE) + 2) * sizeof(Chunk);
+        case ENGINE_GENERATIONS:
+            return 2.0 * n_rows * ((n_cols + CELLS_PER_GEN_WORD - 1) / CELLS_PER_GEN_WORD) * sizeof(uint64_t);
+        default:
+            return (double)HASHLIFE_DEFAULT_MEMORY;
+    }
+}
+
+static double bytes_per_generation(int engine, const void *state, int n_rows, int n_cols){
+    /*
+    Estimate the bytes an engine reads and writes in one generation, negative if there is no sensible estimate.
+    - board: the Cells of the active tiles are read once and the next generation written once
+    - bitboard, generations: the current generation is read once and the next written once
+    - sparse: each chunk is read, its next generation written and copied back
+    */
+    switch (engine){
+        case ENGINE_BOARD:
+            return 2.0 * ((const Board *)state)->n_active_tiles * TILE_SIZE * TILE_SIZE * sizeof(Cell);
+        case ENGINE_BITBOARD:
+        case ENGINE_GENERATIONS:
+            return engine_memory(engine, n_rows, n_cols);
+        case ENGINE_SPARSE:
+            return 4.0 * ((const SparsePlane *)state)->n_chunks * CHUNK_SIZE * sizeof(uint64_t);
+        default: // HashLife mostly follows pointers through its node store
+            return -1;
+    }
+}
+
+static void run_case(BenchCase *bc, const BitBoard *start, double min_time, ThreadPool *pool){
+    /*
+    Time one engine from a starting board, running batches of generations (doubling in size) until at least min_time
+    seconds have passed. Fills in the results of bc.
+    */
+    int fixed_bounds = engine_ops(bc->engine)->unbounded ? INFINITE_BOUNDS : bc->fixed_bounds;
+    PatternInfo window = {PATTERN_NATIVE, start->n_rows, start->n_cols, 0, 0, fixed_bounds, "", 0, 1};
+    set_board_memory_pool(pool); // the engine's board is placed in memory by the threads stepping it
+    Engine *engine = create_engine(bc->engine, &window, fixed_bounds, bc->birth_mask, bc->survive_mask, bc->n_states);
+    BitBoard *copy = create_bitboard(start->n_rows, start->n_cols); // copy the starting board into the engine (not timed)
+    copy_bitboard(start, copy);
+    engine->ops->load_cells(engine, copy, NULL);
+    if (bc->engine == ENGINE_BITBOARD){
+        set_bitboard_kernel(bc->kernel);
+        engine->block = bc->block;
+    }
+
+    long long n_generations = 0, batch = 1;
+    double seconds = 0, bytes = 0;
+    while (seconds < min_time){
+        double batch_bytes = 0;
+        double t0 = now_seconds();
+        if (engine->ops->leaps){ // jumps the whole batch at once
+            bc->cells_alive = engine->ops->step(engine, batch, pool);
+        }
+        for (long long g = 0, n_step; g < batch && !engine->ops->leaps; g += n_step){
+            n_step = (batch - g < bc->block) ? batch - g : bc->block; // a block at a time (1 unless bit-packed)
+            if (bc->engine == ENGINE_SPARSE){
+                batch_bytes += bytes_per_generation(ENGINE_SPARSE, engine->state, 0, 0); // chunks before the step
+            }
+            bc->cells_alive = engine->ops->step(engine, n_step, pool);
+            if (bc->engine == ENGINE_BOARD){
+                batch_bytes += bytes_per_generation(ENGINE_BOARD, engine->state, 0, 0); // tiles active in the step
+            }
+        }
+        seconds += now_seconds() - t0;
+        n_generations += batch;
+        if (bc->engine == ENGINE_BITBOARD || bc->engine == ENGINE_HASHLIFE || bc->engine == ENGINE_GENERATIONS){
+            batch_bytes = batch * bytes_per_generation(bc->engine, NULL, start->n_rows, start->n_cols) / bc->block;
+        }
+        bytes += batch_bytes;
+        if (batch < MAX_BATCH){
+            batch *= 2;
+        }
+    }
+
+    bc->n_generations = n_generations;
+    bc->seconds = seconds;
+    bc->ns_per_cell = 1e9 * seconds / ((double)n_generations * start->n_rows * start->n_cols);
+    bc->bandwidth = (bytes >= 0) ? bytes / seconds : -1;
+    free_engine(engine);
+}
+
+static void print_case(const BenchCase *bc){
+    // Print one result as a row of the results table
+    char workload[64];
+    if (strcmp(bc->workload, "random") == 0){
+        snprintf(workload, sizeof(workload), "random %d%%", (int)(100*bc->density + 0.5));
+    }else{
+        snprintf(workload, sizeof(workload), "%s", bc->workload);
+    }
+    char bandwidth[32] = "-";
+    if (bc->bandwidth >= 0){
+        snprintf(bandwidth, sizeof(bandwidth), "%.2f", bc->bandwidth / 1e9);
+    }
+    printf("%-20s %6dx%-6d %-11s %-7s %3d %5d %12lld %11.4g %9s\n", workload, bc->n_rows, bc->n_cols,
+           engine_name(bc->engine), (bc->engine == ENGINE_BITBOARD) ? bitboard_kernel_name(bc->kernel) : "-",
+           bc->n_threads, bc->block, bc->n_generations, bc->ns_per_cell, bandwidth);
+    fflush(stdout);
+}
+
+static void write_case(FILE *file, const BenchCase *bc, int first){
+    // Write one result as a JSON object
+    fprintf(file, "%s\n    {\"workload\": \"%s\", \"n_rows\": %d, \"n_cols\": %d, \"density\": %.2f, ",
+            first ? "" : ",", bc->workload, bc->n_rows, bc->n_cols, bc->density);
+    fprintf(file, "\"bounds\": \"%s\", \"engine\": \"%s\", \"kernel\": \"%s\", \"threads\": %d, ",
+            (bc->engine == ENGINE_SPARSE || bc->engine == ENGINE_HASHLIFE) ? "infinite" : (bc->fixed_bounds ? "fixed" : "torus"),
+            engine_name(bc->engine), (bc->engine == ENGINE_BITBOARD) ? bitboard_kernel_name(bc->kernel) : "",
+            bc->n_threads);
+    fprintf(file, "\"block\": %d, \"generations\": %lld, \"seconds\": %.6f, \"ns_per_cell_gen\": %.6g, ",
+            bc->block, bc->n_generations, bc->seconds, bc->ns_per_cell);
+    if (bc->bandwidth >= 0){
+        fprintf(file, "\"bandwidth_gb_s\": %.4g, ", bc->bandwidth / 1e9);
+    }else{
+        fprintf(file, "\"bandwidth_gb_s\": null, ");
+    }
+    fprintf(file, "\"cells_alive\": %lld}", bc->cells_alive);
+}
+
+static void run_engines(BenchCase *base, const BitBoard *start, const int *thread_counts, int n_thread_counts,
+                        ThreadPool **pools, const int *blocks, int n_blocks, double min_time, double max_memory,
+                        int with_hashlife, FILE *file, int *n_results){
+    // Time every engine (and every kernel and blocking depth of the bit-packed board) for every thread count from
+    // the same start
+    for (int engine = ENGINE_BOARD; engine <= ENGINE_GENERATIONS; engine++){
+        if ((engine == ENGINE_HASHLIFE && !with_hashlife)
+            || (engine != ENGINE_GENERATIONS && base->n_states > 2) // only the Generations board has decaying states
+            || ((engine == ENGINE_SPARSE || engine == ENGINE_HASHLIFE) && (base->birth_mask & 1)) // B0 fills the plane
+            || engine_memory(engine, start->n_rows, start->n_cols) > max_memory){
+            continue;
+        }
+        for (int kernel = 0; kernel < ((engine == ENGINE_BITBOARD) ? N_KERNELS : 1); kernel++){
+            if (engine == ENGINE_BITBOARD && !bitboard_kernel_supported(kernel)){
+                continue;
+            }
+            for (int t = 0; t < n_thread_counts; t++){
+                if (engine == ENGINE_HASHLIFE && t > 0){ // HashLife is single threaded
+                    break;
+                }
+                for (int b = 0; b < ((engine == ENGINE_BITBOARD) ? n_blocks : 1); b++){
+                    BenchCase bc = *base;
+                    bc.engine = engine;
+                    bc.kernel = kernel;
+                    bc.n_threads = (engine == ENGINE_HASHLIFE) ? 1 : thread_counts[t];
+                    bc.block = (engine == ENGINE_BITBOARD) ? blocks[b] : 1;
+                    run_case(&bc, start, min_time, pools[t]);
+                    print_case(&bc);
+                    write_case(file, &bc, *n_results == 0);
+                    (*n_results)++;
+                }
+            }
+        }
+    }
+}
+
+static void print_usage(const char *program){
+    // Print the command line options
+    printf("Usage: %s [--output FILE] [--threads N[,N...]] [--min-time S] [--max-size N] [--max-memory MB] [--rule B/S[/C]]\n",
+           program);
+    printf("       %*s [--block T[,T...]] [--quick]\n", (int)strlen(program), "");
+    printf("  --output FILE   JSON file to write the results to (default %s)\n", BENCH_OUTPUT);
+    printf("  --threads LIST  thread counts to time, comma separated (default 1 and the number of processors)\n");
+    printf("  --min-time S    seconds to run each case for at least (default 0.2)\n");
+    printf("  --max-size N    largest random board (default %d)\n", board_sizes[N_SIZES-1]);
+    printf("  --max-memory MB skip cases needing more memory than this (default 2048)\n");
+    printf("  --rule B/S[/C]  rule to run, e.g. B36/S23 or B2/S/C3 (default B3/S23)\n");
+    printf("  --block LIST    generations the bit-packed board advances per pass, comma separated (default 1)\n");
+    printf("  --quick         same as --max-size 1024 --min-time 0.05\n");
+}
+
+int main(int argc, char *argv[]){
+
+    const char *output = BENCH_OUTPUT;
+    int thread_counts[MAX_THREAD_COUNTS];
+    int n_thread_counts = 0;
+    int blocks[MAX_BLOCKS] = {1};
+    int n_blocks = 0;
+    double min_time = 0.2, max_memory = 2048.0 * 1024 * 1024;
+    int max_size = board_sizes[N_SIZES-1];
+    unsigned birth_mask = LIFE_BIRTH, survive_mask = LIFE_SURVIVE;
+    int n_states = 2;
+
+    for (int k = 1; k < argc; k++){
+        if (strcmp(argv[k], "--output") == 0 && k+1 < argc){
+            output = argv[++k];
+        }else if (strcmp(argv[k], "--threads") == 0 && k+1 < argc){
+            for (char *s = strtok(argv[++k], ","); s != NULL; s = strtok(NULL, ",")){
+                if (n_thread_counts == MAX_THREAD_COUNTS || atoi(s) < 1){
+                    printf("[ERROR]: Give up to %d thread counts greater than 0\n", MAX_THREAD_COUNTS);
+                    exit(EXIT_FAILURE);
+                }
+                thread_counts[n_thread_counts++] = atoi(s);
+            }
+        }else if (strcmp(argv[k], "--block") == 0 && k+1 < argc){
+            for (char *s = strtok(argv[++k], ","); s != NULL; s = strtok(NULL, ",")){
+                if (n_blocks == MAX_BLOCKS || atoi(s) < 1){
+                    printf("[ERROR]: Give up to %d blocking depths greater than 0\n", MAX_BLOCKS);
+                    exit(EXIT_FAILURE);
+                }
+                blocks[n_blocks++] = atoi(s);
+            }
+        }else if (strcmp(argv[k], "--min-time") == 0 && k+1 < argc){
+            min_time = atof(argv[++k]);
+        }else if (strcmp(argv[k], "--max-size") == 0 && k+1 < argc){
+            max_size = atoi(argv[++k]);
+        }else if (strcmp(argv[k], "--max-memory") == 0 && k+1 < argc){
+            max_memory = atof(argv[++k]) * 1024 * 1024;
+        }else if (strcmp(argv[k], "--rule") == 0 && k+1 < argc){
+            if (!parse_generations_rule(argv[++k], &birth_mask, &survive_mask, &n_states)){
+                printf("[ERROR]: Unknown rule %s, give it as B/S or B/S/C, e.g. B3/S23 or B2/S/C3\n", argv[k]);
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--quick") == 0){
+            max_size = 1024;
+            min_time = 0.05;
+        }else if (strcmp(argv[k], "--help") == 0){
+            print_usage(argv[0]);
+            return 0;
+        }else{
+            printf("[ERROR]: Unknown option %s\n", argv[k]);
+            print_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (n_thread_counts == 0){ // single threaded and all processors
+        thread_counts[n_thread_counts++] = 1;
+        if (default_n_threads() > 1){
+            thread_counts[n_thread_counts++] = default_n_threads();
+        }
+    }
+    if (n_blocks == 0){ // one generation at a time
+        n_blocks = 1;
+    }
+    ThreadPool *pools[MAX_THREAD_COUNTS];
+    for (int t = 0; t < n_thread_counts; t++){
+        pools[t] = (thread_counts[t] > 1) ? create_thread_pool(thread_counts[t]) : NULL;
+    }
+
+    FILE *file = fopen(output, "w");
+    if (file == NULL){
+        printf("[ERROR]: Could not open %s\n", output);
+        exit(EXIT_FAILURE);
+    }
+    int best_kernel = best_bitboard_kernel();
+    char rule[RULE_STRING_LENGTH];
+    generations_rule_string(birth_mask, survive_mask, n_states, rule);
+    fprintf(file, "{\n  \"timestamp\": %lld,\n  \"processors\": %d,\n  \"best_kernel\": \"%s\",\n  \"min_time\": %g,\n",
+            (long long)time(NULL), default_n_threads(), bitboard_kernel_name(best_kernel), min_time);
+    int specialised = (n_states == 2 && bitboard_rule_specialised(birth_mask, survive_mask)); // bit-packed kernels
+    fprintf(file, "  \"rule\": \"%s\",\n  \"rule_specialised\": %s,\n", rule, specialised ? "true" : "false");
+    fprintf(file, "  \"results\": [");
+
+    printf("Rule %s (%s kernels)\n", rule, specialised ? "specialised" : "general");
+    printf("%-20s %13s %-11s %-7s %3s %5s %12s %11s %9s\n", "workload", "size", "engine", "kernel", "thr",
+           "block", "generations", "ns/cell/gen", "GB/s");
+    int n_results = 0;
+
+    // Random boards, toroidal
+    for (int s = 0; s < N_SIZES && board_sizes[s] <= max_size; s++){
+        for (int d = 0; d < N_DENSITIES; d++){
+            BitBoard *start = random_bitboard(board_sizes[s], densities[d], 12345 + 1000*s + d,
+                                             pools[n_thread_counts - 1]); // the same board for any pool
+            BenchCase base = {"random", board_sizes[s], board_sizes[s], densities[d], 0, 0, 0, 0, 1, birth_mask,
+                              survive_mask, n_states, 0, 0, 0, 0, 0};
+            run_engines(&base, start, thread_counts, n_thread_counts, pools, blocks, n_blocks, min_time, max_memory, 0,
+                        file, &n_results);
+            free_bitboard(start);
+        }
+    }
+
+    // Pattern files, with the boundary conditions in their header
+    for (int p = 0; p < N_PATTERNS; p++){
+        FILE *test = fopen(pattern_files[p], "r"); // load_board stops the program on a missing file, so skip them here
+        if (test == NULL){
+            printf("Skipping %s (not found)\n", pattern_files[p]);
+            continue;
+        }
+        fclose(test);
+        int fixed_bounds;
+        Board *board = load_board(pattern_files[p], &fixed_bounds, 0);
+        BitBoard *start = bitboard_from_cells(board);
+        free_board(board);
+        BenchCase base = {pattern_files[p], start->n_rows, start->n_cols, 0, (fixed_bounds == 1), 0, 0, 0, 1,
+                          birth_mask, survive_mask, n_states, 0, 0, 0, 0, 0};
+        run_engines(&base, start, thread_counts, n_thread_counts, pools, blocks, n_blocks, min_time, max_memory, 1,
+                    file, &n_results);
+        free_bitboard(start);
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    set_bitboard_kernel(best_kernel);
+    for (int t = 0; t < n_thread_counts; t++){
+        free_thread_pool(pools[t]);
+    }
+    printf("%d results written to %s\n", n_results, output);
+    return 0;
+}
@@ -0,0 +1,529 @@
+/*
+* Bit-packed board for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Each word holds 64 horizontally adjacent cells. For a word c with the words above (a) and below (b), the eight
+ neighbours of every bit are the words a, b and the west/east shifted copies of a, c and b. These eight words are
+ added together with full adders, bit-sliced, to give the neighbour count of all 64 cells as four bit planes
+ (s3 s2 s1 s0). The rules are then applied by matching the bit planes against the birth and survival masks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "cycle.h"
+#include "bitboard_kernel.h"
+#include "board_memory.h"
+
+BitBoard* create_bitboard(int n_rows, int n_cols){
+    /*
+    Creates a n_rows*n_cols bit-packed board with all cells dead.
+    - Error checks for memory overflow
+    - Return pointer to the empty board.
+    */
+    BitBoard *bb = (BitBoard *)malloc(sizeof(BitBoard));
+    if (bb == NULL){ // Error check for memory
+        printf("[ERROR] Out of memory whilst creating the bit-packed board\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bb->n_rows = n_rows;
+    bb->n_cols = n_cols;
+    bb->n_words = (n_cols + BITS_PER_WORD - 1) / BITS_PER_WORD; // round up to whole words
+
+    bb->cells = alloc_board_rows(n_rows, bb->n_words); // all dead, each row cleared by the thread stepping it
+    bb->next = alloc_board_rows(n_rows, bb->n_words);
+    bb->hash = bb->shape = 0;
+    clear_step_counts(&bb->counts);
+    bb->count_changes = 0;
+    return bb;
+}
+
+void free_bitboard(BitBoard *bb){
+    // Free the dynamically allocated memory for the bit-packed board
+    free_board_rows(bb->cells, bb->n_rows, bb->n_words);
+    free_board_rows(bb->next, bb->n_rows, bb->n_words);
+    free(bb);
+}
+
+int get_bitboard_cell(const BitBoard *bb, int i, int j){
+    // Return the state (ALIVE or DEAD) of the cell at row i, column j
+    return (bb->cells[(size_t)i*bb->n_words + j/BITS_PER_WORD] >> (j % BITS_PER_WORD)) & 1;
+}
+
+void set_bitboard_cell(BitBoard *bb, int i, int j, int alive){
+    // Set the state (ALIVE or DEAD) of the cell at row i, column j
+    uint64_t *word = &bb->cells[(size_t)i*bb->n_words + j/BITS_PER_WORD];
+    uint64_t bit = 1ULL << (j % BITS_PER_WORD);
+    if (alive == ALIVE){
+        *word |= bit;
+    }else{
+        *word &= ~bit;
+    }
+}
+
+long long count_bitboard(const BitBoard *bb){
+    // Return the number of living cells on the board (padding bits are always dead)
+    long long cells_alive = 0;
+    size_t n_total = (size_t)bb->n_rows * bb->n_words;
+    for (size_t k = 0; k < n_total; k++){
+        cells_alive += __builtin_popcountll(bb->cells[k]);
+    }
+    return cells_alive;
+}
+
+BitBoard* bitboard_from_cells(const Board *board){
+    /*
+    Create a bit-packed copy of a board of Cells.
+    Inputs: board - pointer to the board (declared by create_board)
+    */
+    BitBoard *bb = create_bitboard(board->n_rows, board->n_cols);
+    cells_to_bitboard(board, bb);
+    return bb;
+}
+
+void cells_to_bitboard(const Board *board, BitBoard *bb){
+    /*
+    Copy the states of a board of Cells into a bit-packed board of the same size.
+    Inputs: board - pointer to the board (declared by create_board)
+            bb - bit-packed board to copy into, every word is overwritten
+    */
+    for (int i = 0; i < board->n_rows; i++){
+        uint64_t *row = bb->cells + (size_t)i*bb->n_words;
+        for (int w = 0; w < bb->n_words; w++){ // build each word before storing it
+            int j_end = (w*BITS_PER_WORD + BITS_PER_WORD < board->n_cols) ? w*BITS_PER_WORD + BITS_PER_WORD : board->n_cols;
+            uint64_t word = 0;
+            for (int j = w*BITS_PER_WORD; j < j_end; j++){
+                word |= (uint64_t)(CELL(board,i,j).alive == ALIVE) << (j % BITS_PER_WORD);
+            }
+            row[w] = word;
+        }
+    }
+}
+
+void bitboard_to_cells(const BitBoard *bb, Board *board){
+    /*
+    Copy the states of a bit-packed board back into a board of Cells of the same size.
+    Inputs: bb - bit-packed board to copy from
+            board - pointer to the board (declared by create_board)
+    */
+    for (int i = 0; i < bb->n_rows; i++){
+        for (int j = 0; j < bb->n_cols; j++){
+            CELL(board,i,j).alive = get_bitboard_cell(bb, i, j);
+        }
+    }
+}
+
+// Shared by the stripes of fill_bitboard_random
+typedef struct fill_task{
+    BitBoard *bb;
+    uint64_t keys[DENSITY_BITS]; // one random stream for each bit of the density
+    uint32_t level; // density in units of 2^-DENSITY_BITS
+    long long *cells_alive; // living cells counted by each stripe
+}FillTask;
+
+static void fill_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Fill one horizontal stripe of the board with random cells.
+    - Word w of row i is made from the counter i*n_words + w of each stream alone, so the stripes need no shared
+      generator state and the board does not depend on how the rows are split
+    - A random word has each bit set with probability 1/2. Working up from the lowest set bit of the density,
+      each bit of the density ORs (bit set) or ANDs (bit clear) in another random word, so after the top bit each
+      cell is alive with probability level / 2^DENSITY_BITS. A density of 1/2 takes a single word
+    */
+    FillTask *task = (FillTask *)arg;
+    BitBoard *bb = task->bb;
+    int row_begin, row_end;
+    stripe_range(bb->n_rows, stripe, n_stripes, &row_begin, &row_end);
+
+    int low_bit = (task->level == 0) ? DENSITY_BITS : __builtin_ctz(task->level);
+    int spare = bb->n_words*BITS_PER_WORD - bb->n_cols;
+    uint64_t last_mask = (spare == 0) ? ~0ULL : (~0ULL >> spare); // padding bits of the last word are kept dead
+    long long cells_alive = 0;
+    for (int i = row_begin; i < row_end; i++){
+        uint64_t *row = &bb->cells[(size_t)i*bb->n_words];
+        uint64_t counter = (uint64_t)i*bb->n_words;
+        memset(row, 0, bb->n_words*sizeof(uint64_t));
+        for (int b = low_bit; b < DENSITY_BITS; b++){
+            uint64_t key = task->keys[b];
+            if ((task->level >> b) & 1){
+                for (int w = 0; w < bb->n_words; w++){ // branch free inner loops, vectorised by the compiler
+                    row[w] |= mix_hash(key + (counter + w)*HASH_STEP);
+                }
+            }else{
+                for (int w = 0; w < bb->n_words; w++){
+                    row[w] &= mix_hash(key + (counter + w)*HASH_STEP);
+                }
+            }
+        }
+        row[bb->n_words - 1] &= last_mask;
+        for (int w = 0; w < bb->n_words; w++){
+            cells_alive += __builtin_popcountll(row[w]);
+        }
+    }
+    task->cells_alive[stripe] = cells_alive;
+}
+
+long long fill_bitboard_random(BitBoard *bb, uint64_t seed, double density, ThreadPool *pool){
+    /*
+    Replace the cells of the bit-packed board with random cells. Return the number of living cells.
+    Inputs: bb - bit-packed board (declared by create_bitboard)
+            seed - the same seed and density always give the same board, whatever the number of threads
+            density - probability of each cell being alive (0 to 1), rounded to a multiple of 2^-DENSITY_BITS
+            pool - threads to split the board between in horizontal stripes (NULL for a single thread)
+    - Random words come from a counter-based generator: the splitmix64 output function applied to the key of a
+      stream plus the counter of the word, so any word can be made without generating the words before it
+    */
+    if (density <= 0.0){
+        density = 0.0;
+    }else if (density >= 1.0){
+        density = 1.0;
+    }
+    uint64_t level = (uint64_t)(density * (1 << DENSITY_BITS) + 0.5);
+
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_alive[n_stripes];
+    FillTask task;
+    task.bb = bb;
+    task.level = (uint32_t)level;
+    task.cells_alive = stripe_alive;
+    for (int b = 0; b < DENSITY_BITS; b++){
+        task.keys[b] = mix_hash(seed + (uint64_t)b*HASH_STEP);
+    }
+
+    if (level >> DENSITY_BITS){ // density 1, every cell alive
+        int spare = bb->n_words*BITS_PER_WORD - bb->n_cols;
+        for (int i = 0; i < bb->n_rows; i++){
+            uint64_t *row = &bb->cells[(size_t)i*bb->n_words];
+            memset(row, 0xFF, bb->n_words*sizeof(uint64_t));
+            row[bb->n_words - 1] = (spare == 0) ? ~0ULL : (~0ULL >> spare);
+        }
+        return (long long)bb->n_rows * bb->n_cols;
+    }
+
+    run_thread_pool(pool, fill_stripe, &task);
+
+    long long cells_alive = 0;
+    for (int k = 0; k < n_stripes; k++){ // combine the counts of each stripe
+        cells_alive += stripe_alive[k];
+    }
+    return cells_alive;
+}
+
+static void step_row_words(const BitBoard *bb, const uint64_t *a, const uint64_t *c, const uint64_t *b,
+                           uint64_t *out, int fixed_bounds, unsigned birth_mask, unsigned survive_mask,
+                           RowKernel row_kernel){
+    /*
+    Calculate the next generation out of a row c of the board from the rows above (a) and below (b) it.
+    - Columns are wrapped toroidally, with fixed boundaries the first and last columns are copied unchanged
+    */
+    int n_words = bb->n_words;
+    int last = n_words - 1; // index of the last word in the row
+    int last_bit = (bb->n_cols - 1) % BITS_PER_WORD; // bit of the last column in the last word
+    uint64_t last_mask = (last_bit == BITS_PER_WORD-1) ? ~0ULL : ((1ULL << (last_bit+1)) - 1);
+
+    // Interior words take their west/east neighbour bits from the adjacent words (scalar or SIMD kernel)
+    if (last > 1){
+        row_kernel(a, c, b, out, 1, last, birth_mask, survive_mask);
+    }
+
+    // The first and last words wrap around to the other end of the row
+    for (int w = 0; w <= last; w += (last > 0 ? last : 1)){
+        uint64_t a_west = (w > 0) ? a[w-1] >> 63 : (a[last] >> last_bit) & 1;
+        uint64_t c_west = (w > 0) ? c[w-1] >> 63 : (c[last] >> last_bit) & 1;
+        uint64_t b_west = (w > 0) ? b[w-1] >> 63 : (b[last] >> last_bit) & 1;
+        uint64_t a_east = (w < last) ? a[w+1] << 63 : (a[0] & 1) << last_bit;
+        uint64_t c_east = (w < last) ? c[w+1] << 63 : (c[0] & 1) << last_bit;
+        uint64_t b_east = (w < last) ? b[w+1] << 63 : (b[0] & 1) << last_bit;
+        out[w] = step_word((a[w] << 1) | a_west, a[w], (a[w] >> 1) | a_east,
+                           (c[w] << 1) | c_west, c[w], (c[w] >> 1) | c_east,
+                           (b[w] << 1) | b_west, b[w], (b[w] >> 1) | b_east,
+                           birth_mask, survive_mask);
+    }
+    out[last] &= last_mask; // keep padding bits dead
+
+    if (fixed_bounds){ // first and last columns are frozen
+        uint64_t first_bit = 1ULL, end_bit = 1ULL << last_bit;
+        out[0] = (out[0] & ~first_bit) | (c[0] & first_bit);
+        out[last] = (out[last] & ~end_bit) | (c[last] & end_bit);
+    }
+}
+
+static long long tally_row(const BitBoard *bb, int i, const uint64_t *c, const uint64_t *out, int fixed_bounds,
+                           RowTally row_tally, uint64_t *row_hash, StepCounts *counts){
+    /*
+    Count the living cells of row i of the next generation out, stepped from c. Return the number of living cells.
+    - *row_hash is set to a hash of the words of the row and its position
+    - The births and deaths of the row are added to counts, and its bounding box widened to the row's living cells
+    - With fixed boundaries the outer ring of cells is not counted
+    */
+    int n_words = bb->n_words;
+    int last = n_words - 1;
+    int last_bit = (bb->n_cols - 1) % BITS_PER_WORD;
+    long long tally[3]; // frozen cells never change, so are never births or deaths
+    uint64_t key = mix_hash(HASH_SEED + (uint64_t)i); // key of the row, stepped along its words
+    *row_hash = mix_hash(row_tally(c, out, n_words, key, tally) ^ key);
+    long long cells_alive = tally[0];
+    uint64_t first_word = out[0], last_word = out[last]; // living cells of the end words, for the bounding box
+    if (fixed_bounds){ // frozen cells are not counted
+        cells_alive -= (out[0] & 1) + ((out[last] >> last_bit) & 1);
+        if (bb->n_cols == 1){ // the same cell was subtracted twice
+            cells_alive += out[0] & 1;
+        }
+        first_word &= ~1ULL;
+        last_word &= ~(1ULL << last_bit);
+        if (last == 0){
+            first_word = last_word = first_word & last_word;
+        }
+    }
+    counts->births += tally[1];
+    counts->deaths += tally[2];
+    if (cells_alive > 0){ // columns of the first and last living cells in the row
+        int w_first = 0, w_last = last;
+        uint64_t word_first = first_word, word_last = last_word;
+        while (word_first == 0){
+            word_first = (++w_first == last) ? last_word : out[w_first];
+        }
+        while (word_last == 0){
+            word_last = (--w_last == 0) ? first_word : out[w_last];
+        }
+        long long col_first = (long long)w_first*BITS_PER_WORD + __builtin_ctzll(word_first);
+        long long col_last = (long long)w_last*BITS_PER_WORD + (BITS_PER_WORD-1 - __builtin_clzll(word_last));
+        counts->min_row = (i < counts->min_row) ? i : counts->min_row;
+        counts->max_row = i; // rows are stepped in order
+        counts->min_col = (col_first < counts->min_col) ? col_first : counts->min_col;
+        counts->max_col = (col_last > counts->max_col) ? col_last : counts->max_col;
+    }
+    return cells_alive;
+}
+
+static long long step_row(BitBoard *bb, int i, int fixed_bounds, unsigned birth_mask, unsigned survive_mask,
+                          RowKernel row_kernel, RowTally row_tally, uint64_t *row_hash, StepCounts *counts){
+    /*
+    Calculate row i of the next generation from the current generation. Return the number of living cells in the row.
+    - Rows and columns are wrapped toroidally, as in update_board
+    - With fixed boundaries the outer ring of cells is copied unchanged and not counted, as in update_board
+    - *row_hash is set to a hash of the words of the row and its position (see tally_row)
+    */
+    int n_words = bb->n_words;
+    const uint64_t *c = bb->cells + (size_t)i*n_words;
+    uint64_t *out = bb->next + (size_t)i*n_words;
+
+    if (fixed_bounds && (i == 0 || i == bb->n_rows-1)){ // top and bottom rows are frozen
+        memcpy(out, c, n_words*sizeof(uint64_t));
+        *row_hash = 0;
+        return 0;
+    }
+
+    const uint64_t *a = bb->cells + (size_t)(i == 0 ? bb->n_rows-1 : i-1)*n_words; // row above (toroidal)
+    const uint64_t *b = bb->cells + (size_t)(i == bb->n_rows-1 ? 0 : i+1)*n_words; // row below (toroidal)
+    step_row_words(bb, a, c, b, out, fixed_bounds, birth_mask, survive_mask, row_kernel);
+    return tally_row(bb, i, c, out, fixed_bounds, row_tally, row_hash, counts);
+}
+
+// Shared by the stripes of step_bitboard
+typedef struct step_task{
+    BitBoard *bb;
+    int fixed_bounds;
+    unsigned birth_mask, survive_mask;
+    RowKernel row_kernel;
+    RowTally row_tally;
+    long long *cells_alive; // living cells counted by each stripe
+    uint64_t *hash, *shape; // hash and shape of each stripe
+    StepCounts *counts; // births, deaths and bounding box of each stripe
+    int n_generations; // generations each band of rows is advanced by (step_bitboard_blocked)
+}StepTask;
+
+static void step_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Calculate one horizontal stripe of the next generation.
+    - The stripe only reads the current generation (including the edge rows of the stripes above and below it,
+      wrapping between the first and last stripe) and only writes its own rows of the next generation,
+      so the stripes need no locks between them
+    */
+    StepTask *task = (StepTask *)arg;
+    int row_begin, row_end;
+    stripe_range(task->bb->n_rows, stripe, n_stripes, &row_begin, &row_end);
+
+    long long cells_alive = 0;
+    uint64_t hash = 0, shape = 0;
+    StepCounts *counts = &task->counts[stripe];
+    clear_step_counts(counts);
+    for (int i = row_begin; i < row_end; i++){
+        uint64_t row_hash;
+        long long row_alive = step_row(task->bb, i, task->fixed_bounds, task->birth_mask, task->survive_mask,
+                                       task->row_kernel, task->row_tally, &row_hash, counts);
+        cells_alive += row_alive;
+        hash += row_hash;
+        shape += mix_hash(SHAPE_SEED + (uint64_t)row_alive); // rows keep their populations when translated
+    }
+    task->cells_alive[stripe] = cells_alive;
+    task->hash[stripe] = hash;
+    task->shape[stripe] = shape;
+}
+
+long long step_bitboard(BitBoard *bb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool){
+    /*
+    Advance the bit-packed board by one generation. Return the number of living cells after the update.
+    Inputs: bb - bit-packed board (declared by create_bitboard)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries)
+            birth_mask, survive_mask - the game rule (see parse_rule)
+            pool - threads to split the board between in horizontal stripes (NULL for a single thread)
+    - Gives the same generation and living cell count as update_board
+    - Leave bb->hash, a hash of the words of the new generation, and bb->shape, a hash of the populations of its rows
+      which is the same wherever the pattern is on a toroidal board
+    - Leave bb->counts, the bounding box of the living cells of the generation (excluding fixed boundaries) and,
+      if bb->count_changes is set, its births and deaths (otherwise -1), counted as each row is hashed
+    */
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_alive[n_stripes];
+    uint64_t stripe_hash[n_stripes], stripe_shape[n_stripes];
+    StepCounts stripe_counts[n_stripes];
+    StepTask task = {bb, fixed_bounds, birth_mask, survive_mask, bitboard_row_kernel(birth_mask, survive_mask), // scalar or SIMD kernel, specialised for common rules (see bitboard_simd.c)
+                     bitboard_row_tally(bb->count_changes), stripe_alive, stripe_hash, stripe_shape, stripe_counts, 1};
+
+    run_thread_pool(pool, step_stripe, &task);
+
+    long long cells_alive = 0;
+    bb->hash = bb->shape = 0;
+    clear_step_counts(&bb->counts);
+    for (int k = 0; k < n_stripes; k++){ // combine the counts of each stripe
+        cells_alive += stripe_alive[k];
+        bb->hash += stripe_hash[k];
+        bb->shape += stripe_shape[k];
+        add_step_counts(&bb->counts, &stripe_counts[k]);
+    }
+    if (!bb->count_changes){
+        bb->counts.births = bb->counts.deaths = -1;
+    }
+
+    uint64_t *swap = bb->cells; // the next generation becomes the current one
+    bb->cells = bb->next;
+    bb->next = swap;
+    return cells_alive;
+}
+
+static int block_rows(const BitBoard *bb, int depth){
+    // Rows of each band of step_bitboard_blocked, so its two buffers (band and halo) fit in BLOCK_BYTES
+    int n_rows = (int)(BLOCK_BYTES / (2 * bb->n_words * sizeof(uint64_t))) - 2*depth;
+    return (n_rows > MIN_BLOCK_ROWS) ? n_rows : MIN_BLOCK_ROWS;
+}
+
+static void step_blocked_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Advance one horizontal stripe by task->n_generations (T) generations, a band of rows at a time.
+    - The band is copied into a buffer with T rows either side of it (wrapping toroidally), then stepped T times
+      between two buffers small enough to stay in cache. Each step leaves one row less of the halo correct at
+      either end, so after T steps the band itself is exact and only it is written back to the next generation
+    - The halo rows are calculated by the bands either side as well, which costs 2T rows of each band per step
+    - The last step is counted and hashed row by row as step_stripe does, so the counts are those of the last
+      generation
+    */
+    StepTask *task = (StepTask *)arg;
+    const BitBoard *bb = task->bb;
+    int depth = task->n_generations, n_words = bb->n_words;
+    int row_begin, row_end;
+    stripe_range(bb->n_rows, stripe, n_stripes, &row_begin, &row_end);
+
+    long long cells_alive = 0;
+    uint64_t hash = 0, shape = 0;
+    StepCounts *counts = &task->counts[stripe];
+    clear_step_counts(counts);
+    int band = block_rows(bb, depth);
+    size_t height = (size_t)((band < row_end - row_begin) ? band : row_end - row_begin) + 2*depth;
+    uint64_t *buffer = (row_begin < row_end) ? (uint64_t *)malloc(2 * height * n_words * sizeof(uint64_t)) : NULL;
+    if (row_begin < row_end && buffer == NULL){
+        printf("[ERROR] Out of memory whilst stepping the bit-packed board\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int band_begin = row_begin; band_begin < row_end; band_begin += band){
+        int band_end = (band_begin + band < row_end) ? band_begin + band : row_end;
+        int n_band = (band_end - band_begin) + 2*depth; // rows in the buffer, row k is board row band_begin-depth+k
+        uint64_t *src = buffer, *dst = buffer + height*n_words;
+        for (int k = 0; k < n_band; k++){
+            int i = ((band_begin - depth + k) % bb->n_rows + bb->n_rows) % bb->n_rows;
+            memcpy(src + (size_t)k*n_words, bb->cells + (size_t)i*n_words, n_words*sizeof(uint64_t));
+        }
+        for (int t = 1; t <= depth; t++){
+            for (int k = t; k < n_band - t; k++){ // rows still correct after t steps
+                int i = ((band_begin - depth + k) % bb->n_rows + bb->n_rows) % bb->n_rows;
+                const uint64_t *c = src + (size_t)k*n_words;
+                uint64_t *out = dst + (size_t)k*n_words;
+                uint64_t row_hash = 0;
+                long long row_alive = 0;
+                if (task->fixed_bounds && (i == 0 || i == bb->n_rows-1)){ // top and bottom rows are frozen
+                    memcpy(out, c, n_words*sizeof(uint64_t));
+                }else{
+                    step_row_words(bb, c - n_words, c, c + n_words, out, task->fixed_bounds, task->birth_mask,
+                                   task->survive_mask, task->row_kernel);
+                    if (t == depth){
+                        row_alive = tally_row(bb, i, c, out, task->fixed_bounds, task->row_tally, &row_hash, counts);
+                    }
+                }
+                if (t == depth){
+                    cells_alive += row_alive;
+                    hash += row_hash;
+                    shape += mix_hash(SHAPE_SEED + (uint64_t)row_alive);
+                }
+            }
+            uint64_t *swap = src;
+            src = dst;
+            dst = swap;
+        }
+        memcpy(bb->next + (size_t)band_begin*n_words, src + (size_t)depth*n_words,
+               (size_t)(band_end - band_begin)*n_words*sizeof(uint64_t));
+    }
+    free(buffer);
+    task->cells_alive[stripe] = cells_alive;
+    task->hash[stripe] = hash;
+    task->shape[stripe] = shape;
+}
+
+long long step_bitboard_blocked(BitBoard *bb, int n_generations, int fixed_bounds, unsigned birth_mask,
+                                unsigned survive_mask, ThreadPool *pool){
+    /*
+    Advance the bit-packed board by n_generations at once with temporal blocking. Return the number of living cells.
+    Inputs: bb - bit-packed board (declared by create_bitboard)
+            n_generations - generations to advance (the depth T of the blocks), 1 is the same as step_bitboard
+            fixed_bounds, birth_mask, survive_mask, pool - as for step_bitboard
+    - Each band of rows is read from memory once, stepped T times in cache with a halo of T rows and written once
+      (see step_blocked_stripe), so a board too large for the cache costs a T-th of the memory traffic of T calls
+      to step_bitboard, for 2T extra rows calculated per band and step
+    - Gives the same board as T calls to step_bitboard, and leaves the same hash, shape and counts as the last one
+    */
+    if (n_generations <= 1){
+        return step_bitboard(bb, fixed_bounds, birth_mask, survive_mask, pool);
+    }
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_alive[n_stripes];
+    uint64_t stripe_hash[n_stripes], stripe_shape[n_stripes];
+    StepCounts stripe_counts[n_stripes];
+    StepTask task = {bb, fixed_bounds, birth_mask, survive_mask, bitboard_row_kernel(birth_mask, survive_mask),
+                     bitboard_row_tally(bb->count_changes), stripe_alive, stripe_hash, stripe_shape, stripe_counts,
+                     n_generations};
+
+    run_thread_pool(pool, step_blocked_stripe, &task);
+
+    long long cells_alive = 0;
+    bb->hash = bb->shape = 0;
+    clear_step_counts(&bb->counts);
+    for (int k = 0; k < n_stripes; k++){ // combine the counts of each stripe
+        cells_alive += stripe_alive[k];
+        bb->hash += stripe_hash[k];
+        bb->shape += stripe_shape[k];
+        add_step_counts(&bb->counts, &stripe_counts[k]);
+    }
+    if (!bb->count_changes){
+        bb->counts.births = bb->counts.deaths = -1;
+    }
+
+    uint64_t *swap = bb->cells; // the last generation becomes the current one
+    bb->cells = bb->next;
+    bb->next = swap;
+    return cells_alive;
+}
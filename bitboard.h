@@ -0,0 +1,71 @@
+/*
+* Bit-packed board for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Alternative board representation storing 64 cells in each uint64_t word (1 bit per cell).
+              Column j of a row lives in bit (j % 64) of word (j / 64). Rows are padded to a whole number of words,
+              the padding bits are always kept dead.
+              The generation step sums the 8 neighbours of a whole word at once using bitwise full adders
+              and applies the birth/survival rules with pure bit operations, giving the same result as update_board.
+              step_bitboard_blocked advances several generations per pass over memory (temporal blocking), for
+              boards too large for the cache.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#include "conway.h"
+#include "thread_pool.h"
+
+#define BITS_PER_WORD 64 // Cells stored in each word of the bit-packed board
+#define DENSITY_BITS 16 // Bits of the density used by fill_bitboard_random
+#define BLOCK_BYTES (256 << 10) // Bytes of the buffers each thread steps a band of rows in (step_bitboard_blocked)
+#define MIN_BLOCK_ROWS 16 // Fewest rows in a band of step_bitboard_blocked, however wide the board
+
+// Row kernels used to step the board (see bitboard_simd.c)
+#define KERNEL_SCALAR 0 // one word at a time, any CPU
+#define KERNEL_SSE2 1 // 2 words at a time
+#define KERNEL_AVX2 2 // 4 words at a time
+#define KERNEL_AVX512 3 // 8 words at a time
+#define N_KERNELS 4
+
+// Define a structure with alias 'BitBoard' for a bit-packed board with a buffer for the next generation
+typedef struct bitboard{
+    int n_rows, n_cols; // number of rows and columns of cells
+    int n_words; // number of uint64_t words in each row
+    uint64_t *cells; // current generation, n_rows*n_words words
+    uint64_t *next; // scratch buffer the next generation is written into before the buffers are swapped
+    uint64_t hash; // hash of the cells after the last generation (see step_bitboard)
+    uint64_t shape; // hash of the last generation unchanged by translation (see step_bitboard)
+    StepCounts counts; // births, deaths and bounding box of the last generation (see step_bitboard)
+    int count_changes; // 1 to count births and deaths in counts, which costs two popcounts per word
+}BitBoard;
+
+// Prototype function definitions
+BitBoard* create_bitboard(int n_rows, int n_cols); // all cells dead on creation
+void free_bitboard(BitBoard *bb);
+int get_bitboard_cell(const BitBoard *bb, int i, int j);
+void set_bitboard_cell(BitBoard *bb, int i, int j, int alive);
+long long count_bitboard(const BitBoard *bb); // number of living cells
+BitBoard* bitboard_from_cells(const Board *board);
+void cells_to_bitboard(const Board *board, BitBoard *bb);
+void bitboard_to_cells(const BitBoard *bb, Board *board);
+long long fill_bitboard_random(BitBoard *bb, uint64_t seed, double density, ThreadPool *pool); // number of living cells
+long long step_bitboard(BitBoard *bb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool);
+long long step_bitboard_blocked(BitBoard *bb, int n_generations, int fixed_bounds, unsigned birth_mask,
+                                unsigned survive_mask, ThreadPool *pool); // temporal blocking, n_generations at once
+
+// Kernel selection (bitboard_simd.c)
+int bitboard_kernel_supported(int kernel);
+int best_bitboard_kernel(void); // widest kernel the CPU supports
+int set_bitboard_kernel(int kernel); // force a kernel, 0 if unsupported
+int get_bitboard_kernel(void);
+const char* bitboard_kernel_name(int kernel);
+int find_bitboard_kernel(const char *name); // -1 if no kernel has that name
+int bitboard_rule_specialised(unsigned birth_mask, unsigned survive_mask); // 1 if the kernels are specialised for the rule
+
+#endif // BITBOARD_H
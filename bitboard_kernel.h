@@ -0,0 +1,84 @@
+/*
+* Word kernels shared by the bit-packed board and its SIMD row kernels
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+#ifndef BITBOARD_KERNEL_H
+#define BITBOARD_KERNEL_H
+
+#include <stdint.h>
+
+#include "rules.h"
+
+// Calculate words [w_begin, w_end) of the next generation of row c from the rows above (a) and below (b).
+// Every word in the range must have a word either side of it in the row.
+typedef void (*RowKernel)(const uint64_t *a, const uint64_t *c, const uint64_t *b, uint64_t *out,
+                          int w_begin, int w_end, unsigned birth_mask, unsigned survive_mask);
+
+RowKernel bitboard_row_kernel(unsigned birth_mask, unsigned survive_mask); // kernel for this CPU and rule (bitboard_simd.c)
+
+// Count the living cells of a stepped row out (tally[0]), and its births and deaths (tally[1], tally[2]) from its last
+// generation c if asked to, and return the sum of the mixed words of out XORed with the keys key, key+HASH_STEP, ...
+typedef uint64_t (*RowTally)(const uint64_t *c, const uint64_t *out, int n_words, uint64_t key, long long tally[3]);
+RowTally bitboard_row_tally(int count_changes); // with the POPCNT instruction if the CPU has it (bitboard_simd.c)
+void step_words_scalar(const uint64_t *a, const uint64_t *c, const uint64_t *b, uint64_t *out,
+                       int w_begin, int w_end, unsigned birth_mask, unsigned survive_mask);
+
+static inline void full_adder(uint64_t a, uint64_t b, uint64_t c, uint64_t *sum, uint64_t *carry){
+    // Add three words bitwise, giving the sum (weight 1) and carry (weight 2) bits for all 64 positions at once
+    uint64_t t = a ^ b;
+    *sum = t ^ c;
+    *carry = (a & b) | (t & c);
+}
+
+static inline uint64_t apply_rules(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3, uint64_t alive,
+                                   unsigned birth_mask, unsigned survive_mask){
+    // Return the next state of 64 cells from the bit planes of their neighbour counts
+    if (birth_mask == LIFE_BIRTH && survive_mask == LIFE_SURVIVE){
+        // Classic rules: count of 2 or 3 (s1 set, s2 clear, count 8 has s1 clear) and either 3 or already alive
+        return s1 & ~s2 & (s0 | alive);
+    }
+    uint64_t next = 0;
+    #pragma GCC unroll 9 // with constant masks only the counts the rule uses are left
+    for (int n = 0; n <= 8; n++){ // OR together the cells whose count matches n for every n in the masks
+        if (((birth_mask | survive_mask) >> n) & 1){
+            uint64_t match = ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) & ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3);
+            if ((birth_mask >> n) & 1){
+                next |= match & ~alive;
+            }
+            if ((survive_mask >> n) & 1){
+                next |= match & alive;
+            }
+        }
+    }
+    return next;
+}
+
+static inline uint64_t step_word(uint64_t a_west, uint64_t a, uint64_t a_east,
+                                 uint64_t c_west, uint64_t c, uint64_t c_east,
+                                 uint64_t b_west, uint64_t b, uint64_t b_east,
+                                 unsigned birth_mask, unsigned survive_mask){
+    /*
+    Return the next generation of a word c from its 8 neighbour words, each already aligned so bit k holds
+    the neighbour of bit k of c.
+    - Row above and row below are each added with a full adder, the west and east of c with a half adder
+    - The partial sums are then combined into the four bit planes of the count (0 to 8)
+    */
+    uint64_t sum_a, carry_a, sum_b, carry_b, sum_c, carry_c;
+    full_adder(a_west, a, a_east, &sum_a, &carry_a);
+    full_adder(b_west, b, b_east, &sum_b, &carry_b);
+    sum_c = c_west ^ c_east;
+    carry_c = c_west & c_east;
+
+    uint64_t s0, k1, t1, t2;
+    full_adder(sum_a, sum_b, sum_c, &s0, &k1); // weight 1 bits -> s0, carry k1 of weight 2
+    full_adder(carry_a, carry_b, carry_c, &t1, &t2); // weight 2 bits -> t1, carry t2 of weight 4
+    uint64_t s1 = t1 ^ k1;
+    uint64_t t3 = t1 & k1; // second carry of weight 4
+    uint64_t s2 = t2 ^ t3;
+    uint64_t s3 = t2 & t3;
+
+    return apply_rules(s0, s1, s2, s3, c, birth_mask, survive_mask);
+}
+
+#endif // BITBOARD_KERNEL_H
@@ -0,0 +1,317 @@
+/*
+* SIMD row kernels for the bit-packed board with runtime CPU dispatch
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: The bit-sliced adders in step_word only use AND, OR, XOR and shifts, so the same logic runs on
+              2 (SSE2), 4 (AVX2) or 8 (AVX-512) words at once by using a vector of 64 bit lanes in place of a word.
+              The words either side of each lane are read with unaligned loads offset by one word.
+              The kernels are compiled for their instruction set with the target attribute, so one binary holds
+              all of them. The widest kernel the CPU supports is chosen the first time a board is stepped,
+              unless one was forced with set_bitboard_kernel or by naming it in the environment variable
+              KERNEL_ENV (e.g. CONWAY_KERNEL=sse2) to compare kernels. Other compilers/CPUs only have the scalar kernel.
+              Every kernel is also instantiated for each of the common rules in rule_kernels, with the masks as
+              constants. The loop over neighbour counts in the rule check then folds away at compile time, leaving
+              only the AND/OR terms for the counts the rule uses. Other rules use the general kernels, which test
+              the masks as they go.
+              The tally of each stepped row (living cells, births, deaths and hash) is likewise compiled with and
+              without the POPCNT instruction, as without it every popcount is a call into the compiler's library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "bitboard_kernel.h"
+#include "cycle.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1 // x86 kernels and CPU detection available
+#endif
+
+#define KERNEL_ENV "CONWAY_KERNEL" // environment variable forcing a kernel by name
+
+static int current_kernel = -1; // kernel used by step_bitboard, -1 until chosen
+
+static const char *kernel_names[N_KERNELS] = {"scalar", "sse2", "avx2", "avx512"};
+
+/*
+ Body of the scalar kernel, one word at a time, for the rule BIRTH/SURVIVE: constants in a specialised kernel, the
+ birth_mask and survive_mask arguments in the general one.
+ */
+#define SCALAR_KERNEL_BODY(BIRTH, SURVIVE) \
+    for (int w = w_begin; w < w_end; w++){ \
+        out[w] = step_word((a[w] << 1) | (a[w-1] >> 63), a[w], (a[w] >> 1) | (a[w+1] << 63), \
+                           (c[w] << 1) | (c[w-1] >> 63), c[w], (c[w] >> 1) | (c[w+1] << 63), \
+                           (b[w] << 1) | (b[w-1] >> 63), b[w], (b[w] >> 1) | (b[w+1] << 63), \
+                           BIRTH, SURVIVE); \
+    }
+
+void step_words_scalar(const uint64_t *a, const uint64_t *c, const uint64_t *b, uint64_t *out,
+                       int w_begin, int w_end, unsigned birth_mask, unsigned survive_mask){
+    // Scalar kernel for any rule. Also finishes the words left over by the general SIMD kernels.
+    SCALAR_KERNEL_BODY(birth_mask, survive_mask)
+}
+
+// Define a scalar kernel NAME specialised for the rule with masks BIRTH and SURVIVE (the mask arguments are unused)
+#define DEFINE_SCALAR_KERNEL(NAME, BIRTH, SURVIVE) \
+static void NAME(const uint64_t *a, const uint64_t *c, const uint64_t *b, uint64_t *out, \
+                 int w_begin, int w_end, unsigned birth_mask, unsigned survive_mask){ \
+    (void)birth_mask; \
+    (void)survive_mask; \
+    SCALAR_KERNEL_BODY(BIRTH, SURVIVE) \
+}
+
+#ifdef SIMD_X86
+
+// Vectors of 2, 4 and 8 words. The bitwise operators and shifts act on each 64 bit lane.
+typedef uint64_t vec128 __attribute__((vector_size(16)));
+typedef uint64_t vec256 __attribute__((vector_size(32)));
+typedef uint64_t vec512 __attribute__((vector_size(64)));
+
+/*
+ Define a row kernel NAME compiled for instruction set TARGET using vectors of type VEC, for the rule BIRTH/SURVIVE
+ (as in SCALAR_KERNEL_BODY). The body is step_word with each word replaced by a vector of words, followed by the
+ scalar kernel TAIL for any words left over.
+ */
+#define DEFINE_ROW_KERNEL(NAME, TARGET, VEC, BIRTH, SURVIVE, TAIL) \
+__attribute__((target(TARGET))) \
+static void NAME(const uint64_t *a, const uint64_t *c, const uint64_t *b, uint64_t *out, \
+                 int w_begin, int w_end, unsigned birth_mask, unsigned survive_mask){ \
+    const int lanes = sizeof(VEC) / sizeof(uint64_t); \
+    int w = w_begin; \
+    for (; w + lanes <= w_end; w += lanes){ \
+        VEC a_prev, a0, a_next, c_prev, c0, c_next, b_prev, b0, b_next; \
+        memcpy(&a_prev, a+w-1, sizeof(VEC)); memcpy(&a0, a+w, sizeof(VEC)); memcpy(&a_next, a+w+1, sizeof(VEC)); \
+        memcpy(&c_prev, c+w-1, sizeof(VEC)); memcpy(&c0, c+w, sizeof(VEC)); memcpy(&c_next, c+w+1, sizeof(VEC)); \
+        memcpy(&b_prev, b+w-1, sizeof(VEC)); memcpy(&b0, b+w, sizeof(VEC)); memcpy(&b_next, b+w+1, sizeof(VEC)); \
+        /* align the west and east neighbours of every bit */ \
+        VEC a_west = (a0 << 1) | (a_prev >> 63), a_east = (a0 >> 1) | (a_next << 63); \
+        VEC c_west = (c0 << 1) | (c_prev >> 63), c_east = (c0 >> 1) | (c_next << 63); \
+        VEC b_west = (b0 << 1) | (b_prev >> 63), b_east = (b0 >> 1) | (b_next << 63); \
+        /* rows above and below with full adders, west and east of the cell with a half adder */ \
+        VEC t = a_west ^ a0, sum_a = t ^ a_east, carry_a = (a_west & a0) | (t & a_east); \
+        t = b_west ^ b0; \
+        VEC sum_b = t ^ b_east, carry_b = (b_west & b0) | (t & b_east); \
+        VEC sum_c = c_west ^ c_east, carry_c = c_west & c_east; \
+        /* combine the partial sums into the bit planes of the count */ \
+        t = sum_a ^ sum_b; \
+        VEC s0 = t ^ sum_c, k1 = (sum_a & sum_b) | (t & sum_c); \
+        t = carry_a ^ carry_b; \
+        VEC t1 = t ^ carry_c, t2 = (carry_a & carry_b) | (t & carry_c); \
+        VEC s1 = t1 ^ k1, t3 = t1 & k1; \
+        VEC s2 = t2 ^ t3, s3 = t2 & t3; \
+        VEC next; \
+        if ((BIRTH) == LIFE_BIRTH && (SURVIVE) == LIFE_SURVIVE){ \
+            next = s1 & ~s2 & (s0 | c0); \
+        }else{ \
+            next = c0 ^ c0; \
+            _Pragma("GCC unroll 9") \
+            for (int n = 0; n <= 8; n++){ \
+                if ((((BIRTH) | (SURVIVE)) >> n) & 1){ \
+                    VEC match = ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) & ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3); \
+                    if (((BIRTH) >> n) & 1){ \
+                        next |= match & ~c0; \
+                    } \
+                    if (((SURVIVE) >> n) & 1){ \
+                        next |= match & c0; \
+                    } \
+                } \
+            } \
+        } \
+        memcpy(out+w, &next, sizeof(VEC)); \
+    } \
+    TAIL(a, c, b, out, w, w_end, birth_mask, survive_mask); \
+}
+
+DEFINE_ROW_KERNEL(step_words_sse2, "sse2", vec128, birth_mask, survive_mask, step_words_scalar)
+DEFINE_ROW_KERNEL(step_words_avx2, "avx2", vec256, birth_mask, survive_mask, step_words_scalar)
+DEFINE_ROW_KERNEL(step_words_avx512, "avx512f", vec512, birth_mask, survive_mask, step_words_scalar)
+
+// Define the scalar and SIMD kernels for a rule, named step_words_<kernel>_SUFFIX, and list them in kernel order
+#define DEFINE_RULE_KERNELS(SUFFIX, BIRTH, SURVIVE) \
+DEFINE_SCALAR_KERNEL(step_words_scalar_##SUFFIX, BIRTH, SURVIVE) \
+DEFINE_ROW_KERNEL(step_words_sse2_##SUFFIX, "sse2", vec128, BIRTH, SURVIVE, step_words_scalar_##SUFFIX) \
+DEFINE_ROW_KERNEL(step_words_avx2_##SUFFIX, "avx2", vec256, BIRTH, SURVIVE, step_words_scalar_##SUFFIX) \
+DEFINE_ROW_KERNEL(step_words_avx512_##SUFFIX, "avx512f", vec512, BIRTH, SURVIVE, step_words_scalar_##SUFFIX)
+#define RULE_KERNELS(SUFFIX) \
+    {step_words_scalar_##SUFFIX, step_words_sse2_##SUFFIX, step_words_avx2_##SUFFIX, step_words_avx512_##SUFFIX}
+
+#else
+
+#define DEFINE_RULE_KERNELS(SUFFIX, BIRTH, SURVIVE) DEFINE_SCALAR_KERNEL(step_words_scalar_##SUFFIX, BIRTH, SURVIVE)
+#define RULE_KERNELS(SUFFIX) {step_words_scalar_##SUFFIX, NULL, NULL, NULL}
+
+#endif // SIMD_X86
+
+// Body of the row tally (see RowTally), one multiply per word for the hash. Births and deaths cost two more
+// popcounts per word, so are only counted when COUNT_CHANGES is 1.
+#define ROW_TALLY_BODY(COUNT_CHANGES) \
+    long long cells_alive = 0, births = 0, deaths = 0; \
+    uint64_t hash = 0; \
+    for (int w = 0; w < n_words; w++){ \
+        cells_alive += __builtin_popcountll(out[w]); \
+        if (COUNT_CHANGES){ \
+            births += __builtin_popcountll(out[w] & ~c[w]); \
+            deaths += __builtin_popcountll(c[w] & ~out[w]); \
+        } \
+        uint64_t h = (out[w] ^ (key + (uint64_t)w*HASH_STEP)) * HASH_MULT; \
+        hash += h ^ (h >> 29); \
+    } \
+    tally[0] = cells_alive; \
+    tally[1] = births; \
+    tally[2] = deaths; \
+    return hash;
+
+// Define a row tally NAME compiled with the target attribute ATTRIBUTE (empty for any CPU)
+#define DEFINE_ROW_TALLY(NAME, ATTRIBUTE, COUNT_CHANGES) \
+ATTRIBUTE \
+static uint64_t NAME(const uint64_t *c, const uint64_t *out, int n_words, uint64_t key, long long tally[3]){ \
+    (void)c; \
+    ROW_TALLY_BODY(COUNT_CHANGES) \
+}
+
+DEFINE_ROW_TALLY(tally_row_generic, , 0)
+DEFINE_ROW_TALLY(tally_row_generic_changes, , 1)
+#ifdef SIMD_X86
+DEFINE_ROW_TALLY(tally_row_popcnt, __attribute__((target("popcnt"))), 0)
+DEFINE_ROW_TALLY(tally_row_popcnt_changes, __attribute__((target("popcnt"))), 1)
+#endif // SIMD_X86
+
+DEFINE_RULE_KERNELS(life, LIFE_BIRTH, LIFE_SURVIVE)
+DEFINE_RULE_KERNELS(highlife, HIGHLIFE_BIRTH, HIGHLIFE_SURVIVE)
+DEFINE_RULE_KERNELS(day_night, DAY_NIGHT_BIRTH, DAY_NIGHT_SURVIVE)
+DEFINE_RULE_KERNELS(seeds, SEEDS_BIRTH, SEEDS_SURVIVE)
+
+// Define a structure with alias 'RuleKernels' for the kernels specialised for one rule
+typedef struct rule_kernels{
+    unsigned birth_mask, survive_mask;
+    RowKernel kernels[N_KERNELS]; // indexed by KERNEL_*
+}RuleKernels;
+
+#define N_RULE_KERNELS 4
+
+static const RuleKernels rule_kernels[N_RULE_KERNELS] = {
+    {LIFE_BIRTH, LIFE_SURVIVE, RULE_KERNELS(life)},
+    {HIGHLIFE_BIRTH, HIGHLIFE_SURVIVE, RULE_KERNELS(highlife)},
+    {DAY_NIGHT_BIRTH, DAY_NIGHT_SURVIVE, RULE_KERNELS(day_night)},
+    {SEEDS_BIRTH, SEEDS_SURVIVE, RULE_KERNELS(seeds)},
+};
+
+int bitboard_kernel_supported(int kernel){
+    // Return 1 if this build and CPU can run the kernel, 0 otherwise
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    switch (kernel){
+        case KERNEL_SCALAR: return 1;
+        case KERNEL_SSE2: return __builtin_cpu_supports("sse2") != 0;
+        case KERNEL_AVX2: return __builtin_cpu_supports("avx2") != 0;
+        case KERNEL_AVX512: return __builtin_cpu_supports("avx512f") != 0;
+        default: return 0;
+    }
+#else
+    return kernel == KERNEL_SCALAR;
+#endif
+}
+
+int best_bitboard_kernel(void){
+    // Return the widest kernel supported by the CPU
+    for (int kernel = N_KERNELS-1; kernel > KERNEL_SCALAR; kernel--){
+        if (bitboard_kernel_supported(kernel)){
+            return kernel;
+        }
+    }
+    return KERNEL_SCALAR;
+}
+
+int set_bitboard_kernel(int kernel){
+    /*
+    Force the kernel used to step bit-packed boards.
+    Inputs: kernel - one of KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2, KERNEL_AVX512
+    - Return 1 on success, 0 (leaving the kernel unchanged) if it is not supported on this CPU
+    */
+    if (!bitboard_kernel_supported(kernel)){
+        return 0;
+    }
+    current_kernel = kernel;
+    return 1;
+}
+
+int get_bitboard_kernel(void){
+    // Return the kernel used to step bit-packed boards, choosing one on the first call if none was forced
+    if (current_kernel < 0){
+        const char *forced = getenv(KERNEL_ENV);
+        if (forced != NULL){ // kernel named in the environment
+            int kernel = find_bitboard_kernel(forced);
+            if (kernel < 0 || !set_bitboard_kernel(kernel)){
+                printf("[ERROR] %s=%s - kernel unknown or not supported on this CPU\n", KERNEL_ENV, forced);
+                exit(EXIT_FAILURE);
+            }
+        }else{
+            current_kernel = best_bitboard_kernel();
+        }
+    }
+    return current_kernel;
+}
+
+const char* bitboard_kernel_name(int kernel){
+    // Return the name of a kernel as used on the command line
+    if (kernel < 0 || kernel >= N_KERNELS){
+        return "unknown";
+    }
+    return kernel_names[kernel];
+}
+
+int find_bitboard_kernel(const char *name){
+    // Return the kernel with the given name ("auto" for the widest supported), or -1 if there is none
+    if (strcmp(name, "auto") == 0){
+        return best_bitboard_kernel();
+    }
+    for (int kernel = 0; kernel < N_KERNELS; kernel++){
+        if (strcmp(name, kernel_names[kernel]) == 0){
+            return kernel;
+        }
+    }
+    return -1;
+}
+
+int bitboard_rule_specialised(unsigned birth_mask, unsigned survive_mask){
+    // Return 1 if the kernels have been specialised for the rule, 0 if it uses the general kernels
+    for (int k = 0; k < N_RULE_KERNELS; k++){
+        if (rule_kernels[k].birth_mask == birth_mask && rule_kernels[k].survive_mask == survive_mask){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+RowKernel bitboard_row_kernel(unsigned birth_mask, unsigned survive_mask){
+    // Return the row kernel function for the selected kernel and the rule, specialised if it is a common rule
+    int kernel = get_bitboard_kernel();
+    for (int k = 0; k < N_RULE_KERNELS; k++){
+        if (rule_kernels[k].birth_mask == birth_mask && rule_kernels[k].survive_mask == survive_mask){
+            return rule_kernels[k].kernels[kernel];
+        }
+    }
+#ifdef SIMD_X86
+    switch (kernel){
+        case KERNEL_SSE2: return step_words_sse2;
+        case KERNEL_AVX2: return step_words_avx2;
+        case KERNEL_AVX512: return step_words_avx512;
+    }
+#endif
+    return step_words_scalar;
+}
+
+RowTally bitboard_row_tally(int count_changes){
+    // Return the row tally, counting births and deaths if count_changes is 1, using POPCNT if the CPU has it
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")){
+        return count_changes ? tally_row_popcnt_changes : tally_row_popcnt;
+    }
+#endif
+    return count_changes ? tally_row_generic_changes : tally_row_generic;
+}
@@ -0,0 +1,565 @@
+/*
+* Board of Cells for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: The board is stored in a single allocation holding two grids of (n_rows+2)*(n_cols+2) one byte
+              Cells, the current generation and the next. The outer ring of Cells is a ghost border which fill_halo
+              sets from the boundary conditions before each generation (a copy of the opposite edge of a torus, dead
+              cells, a mirror of the edge or the reversed opposite edge of a Klein bottle), so the neighbour counts
+              are read straight from memory with no wrapping of coords or branches on the edges.
+              update_board makes a single pass: each new row is calculated from the three rows around it in the
+              current grid and written to the next grid, counting the living cells as it goes, then the grids are
+              swapped. No neighbour counts are stored, so each cell costs a byte read and a byte written.
+              update_board only recalculates the tiles around those that changed in the last generation, so the
+              work per generation follows the active parts of the board rather than its area. A skipped tile did not
+              change in the generation before either, so the next grid already holds its cells.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conway.h"
+#include "pattern_io.h"
+#include "cycle.h"
+#include "board_memory.h"
+
+static size_t board_bytes(int n_rows, int n_cols){
+    // Size of the single block holding a board: the structure, both grids of Cells and the tile flags and counts
+    size_t n_cells = ((size_t)n_rows + 2) * ((size_t)n_cols + 2);
+    size_t n_tiles = (size_t)((n_rows + TILE_SIZE - 1) / TILE_SIZE) * ((n_cols + TILE_SIZE - 1) / TILE_SIZE);
+    return sizeof(Board) + 2 * n_cells * sizeof(Cell)
+           + n_tiles * (sizeof(long long) + 2*sizeof(uint64_t) + 6*sizeof(uint8_t));
+}
+
+static void clear_board_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Fill both grids with dead cells in the rows one stripe of update_board steps (see step_stripe), so a large board
+    has its pages first written, and so placed in memory, by the thread which will step them. The first and last
+    stripes also take the ghost rows.
+    */
+    Board *board = (Board *)arg;
+    int tile_row_begin, tile_row_end;
+    stripe_range(board->n_tile_rows, stripe, n_stripes, &tile_row_begin, &tile_row_end);
+    size_t row_begin = (tile_row_begin*TILE_SIZE < board->n_rows) ? (size_t)tile_row_begin*TILE_SIZE + 1
+                                                                   : (size_t)board->n_rows + 1; // rows of the grid
+    size_t row_end = (tile_row_end*TILE_SIZE < board->n_rows) ? (size_t)tile_row_end*TILE_SIZE + 1
+                                                               : (size_t)board->n_rows + 1;
+    row_begin = (stripe == 0) ? 0 : row_begin;
+    row_end = (stripe == n_stripes - 1) ? (size_t)board->n_rows + 2 : row_end;
+    memset(board->cells + row_begin*board->stride, DEAD, (row_end - row_begin)*board->stride*sizeof(Cell));
+    memset(board->next + row_begin*board->stride, DEAD, (row_end - row_begin)*board->stride*sizeof(Cell));
+}
+
+Board* create_board(int n_rows, int n_cols){
+    /*
+    Creates a n_rows*n_cols board of Cells (structure containing info about each cell) with a ghost border.
+    - The Board structure, both grids of Cells and the tile flags and counts are allocated together in one block,
+      on huge pages for a large board (see board_memory.h)
+    - Error checks for memory overflow
+    - All cells set to be dead on declaration, all tiles dirty so the first generation recalculates the whole board
+    - Return the pointer to empty board.
+    */
+    size_t stride = (size_t)n_cols + 2; // one ghost cell either side of each row
+    size_t n_cells = ((size_t)n_rows + 2) * stride; // one ghost row above and below the board
+    int n_tile_rows = (n_rows + TILE_SIZE - 1) / TILE_SIZE; // round up to whole tiles
+    int n_tile_cols = (n_cols + TILE_SIZE - 1) / TILE_SIZE;
+    size_t n_tiles = (size_t)n_tile_rows * n_tile_cols;
+
+    size_t n_bytes = board_bytes(n_rows, n_cols);
+    Board *board = (Board *)alloc_board_memory(n_bytes); // Allocate memory for the whole board
+    board->n_rows = n_rows;
+    board->n_cols = n_cols;
+    board->stride = stride;
+    board->cells = (Cell *)(board + 1); // Cells follow the structure in the same block
+    board->next = board->cells + n_cells;
+    board->n_tile_rows = n_tile_rows;
+    board->n_tile_cols = n_tile_cols;
+    board->tile_alive = (long long *)(board->next + n_cells); // then the tile counts and flags
+    board->tile_hash = (uint64_t *)(board->tile_alive + n_tiles);
+    board->tile_shape = board->tile_hash + n_tiles;
+    board->dirty = (uint8_t *)(board->tile_shape + n_tiles);
+    board->active = board->dirty + n_tiles;
+    board->tile_box = board->active + n_tiles; // 4 per tile
+    board->n_active_tiles = 0;
+
+    // Fill both grids with dead cells to start with, a stripe of rows on each thread that will step them
+    run_thread_pool(board_memory_pool(n_bytes), clear_board_stripe, board);
+    memset(board->tile_alive, 0, n_tiles * sizeof(long long));
+    memset(board->tile_hash, 0, n_tiles * sizeof(uint64_t));
+    memset(board->tile_shape, 0, n_tiles * sizeof(uint64_t));
+    board->hash = board->shape = 0;
+    board->hash_cells = board->count_changes = 0;
+    clear_step_counts(&board->counts);
+    mark_board_dirty(board);
+    return board;
+}
+
+void mark_board_dirty(Board *board){
+    /*
+    Mark every tile as changed so that the next call to update_board recalculates the whole board.
+    Must be called after cells are edited other than by update_board, once the board has been updated.
+    Inputs: board - pointer to the board (declared by create_board)
+    */
+    memset(board->dirty, 1, (size_t)board->n_tile_rows * board->n_tile_cols);
+    for (int k = 0; k < 5; k++){
+        board->last_rules[k] = -1; // no generation calculated with these rules yet
+    }
+}
+
+void fill_halo(Board *board, int fixed_bounds){
+    /*
+    Apply the boundary conditions by setting the ghost border around the board, once for the whole generation.
+    Inputs: board - pointer to the board (declared by create_board)
+            fixed_bounds - type of boundary conditions:
+                0 - toroidal, each ghost cell copies the opposite edge so x and y are wrapped
+                1 - fixed, nothing to do as the outer ring of the board is frozen and never reads the border
+                DEAD_BOUNDS - dead cells all around the board
+                REFLECT_BOUNDS - each ghost cell copies the edge cell next to it, as if the board were mirrored
+                KLEIN_BOUNDS - the sides wrapped as for a torus, the ghost rows copy the opposite edge reversed
+    */
+    int n_rows = board->n_rows, n_cols = board->n_cols;
+    switch (fixed_bounds){
+        case 1:{
+            return;
+        }case DEAD_BOUNDS:{
+            for (int i = 0; i < n_rows; i++){
+                CELL(board,i,-1).alive = DEAD;
+                CELL(board,i,n_cols).alive = DEAD;
+            }
+            memset(&CELL(board,-1,-1), DEAD, board->stride * sizeof(Cell));
+            memset(&CELL(board,n_rows,-1), DEAD, board->stride * sizeof(Cell));
+            return;
+        }case REFLECT_BOUNDS:{
+            for (int i = 0; i < n_rows; i++){
+                CELL(board,i,-1) = CELL(board,i,0);
+                CELL(board,i,n_cols) = CELL(board,i,n_cols-1);
+            }
+            // ghost rows copy the edge row with its ghost columns, so the corners mirror the corner cells
+            memcpy(&CELL(board,-1,-1), &CELL(board,0,-1), board->stride * sizeof(Cell));
+            memcpy(&CELL(board,n_rows,-1), &CELL(board,n_rows-1,-1), board->stride * sizeof(Cell));
+            return;
+        }
+    }
+    for (int i = 0; i < n_rows; i++){ // ghost columns take the opposite column
+        CELL(board,i,-1) = CELL(board,i,n_cols-1);
+        CELL(board,i,n_cols) = CELL(board,i,0);
+    }
+    if (fixed_bounds == KLEIN_BOUNDS){ // ghost rows take the opposite row back to front, ghost columns included
+        for (int j = -1; j <= n_cols; j++){
+            CELL(board,-1,j) = CELL(board,n_rows-1,n_cols-1-j);
+            CELL(board,n_rows,j) = CELL(board,0,n_cols-1-j);
+        }
+        return;
+    }
+    // ghost rows take the opposite row, including its ghost columns so the corners are also wrapped
+    memcpy(&CELL(board,-1,-1), &CELL(board,n_rows-1,-1), board->stride * sizeof(Cell));
+    memcpy(&CELL(board,n_rows,-1), &CELL(board,0,-1), board->stride * sizeof(Cell));
+}
+
+void print_board(const Board *board){
+    /*
+    Print the alive/dead state for the whole board to the console.
+    Inputs: board - pointer to the board (declared by create_board)
+    - Each row is built in a buffer and printed in one call
+    */
+    char *line = (char *)malloc(2*(size_t)board->n_cols + 1); // 2 characters per cell and a newline
+    if (line == NULL){
+        printf("[ERROR] Out of memory whilst printing the board\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < board->n_rows; i++){ // loop over rows and cols
+        for (int j = 0; j < board->n_cols; j++){
+            if (CELL(board,i,j).alive == ALIVE){ // If cell is alive print a 'o'
+                line[2*j] = 'o';
+            }else if (CELL(board,i,j).alive == DEAD){ // If cell is dead print blank space
+                line[2*j] = ' ';
+            }else{ // catch errors
+                printf("[ERROR] print_board - Encountered invalid value for board.alive");
+                exit(EXIT_FAILURE);
+            }
+            line[2*j+1] = ' ';
+        }
+        line[2*board->n_cols] = NEWLINE_CHAR;
+        fwrite(line, 1, 2*(size_t)board->n_cols + 1, stdout);
+    }
+    free(line);
+}
+
+// Shared by the stripes of update_board
+typedef struct update_task{
+    Board *board;
+    int fixed_bounds;
+    unsigned birth_mask, survive_mask;
+    long long *births, *deaths; // cells born and cells died in each stripe
+}UpdateTask;
+
+static void tile_range(int n, int tile, int *begin, int *end){
+    // Set the first row (or column) of a tile and one past its last row (or column), on a board with n rows (or columns)
+    *begin = tile * TILE_SIZE;
+    *end = (*begin + TILE_SIZE < n) ? *begin + TILE_SIZE : n;
+}
+
+static void step_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Calculate the next generation of the active tiles in one stripe of tile rows, flag the tiles which change and
+    count their living cells.
+    - Each new row is made in one pass over the rows above, through and below it in the current grid. The sum of
+      each column of three cells is kept rolling along the row, so every cell is read once per row it is used in
+      and the neighbour count is never stored
+    - The new state of each cell is looked up in a table indexed by its state and number of neighbours, built from
+      the rule's masks, so there is no branch on the rule per cell
+    - Cells within the fixed boundaries are copied to the next grid unchanged, every other topology is already in
+      the ghost border (see fill_halo) so the loop is the same for all of them
+    - If board->hash_cells is set, each tile's part of the board hash is the XOR of a key for the position of every
+      living cell. Its part of the shape is the sum of a key for every cell's new state and old number of
+      neighbours, which does not depend on where the cell is, so a translated board has the same shape. Otherwise
+      neither is worked out, which saves a hash per cell
+    - If board->count_changes is set, births and deaths are counted for the stripe and the bounding box of the
+      living cells kept for each tile. Tiles which are skipped do not change, so they have no births or deaths and
+      keep their boxes. Only the living cells and whether each tile changed are always worked out
+    */
+    UpdateTask *task = (UpdateTask *)arg;
+    Board *board = task->board;
+    int frozen = (task->fixed_bounds == 1); // width of the frozen outer ring
+    int hash_cells = board->hash_cells, count_changes = board->count_changes;
+    int tile_row_begin, tile_row_end;
+    stripe_range(board->n_tile_rows, stripe, n_stripes, &tile_row_begin, &tile_row_end);
+    long long births = 0, deaths = 0;
+    uint64_t shape_keys[18]; // key for each state (new) and number of neighbours (old)
+    bool next_state[18]; // next state for each state (old) and number of neighbours
+    for (int k = 0; k < 18; k++){
+        shape_keys[k] = (k == 0) ? 0 : mix_hash(SHAPE_SEED + (uint64_t)k); // empty space adds nothing
+        next_state[k] = (((k < 9 ? task->birth_mask : task->survive_mask) >> (k % 9)) & 1) ? ALIVE : DEAD;
+    }
+
+    for (int ti = tile_row_begin; ti < tile_row_end; ti++){
+        int row_begin, row_end;
+        tile_range(board->n_rows, ti, &row_begin, &row_end);
+        for (int tj = 0; tj < board->n_tile_cols; tj++){
+            int tile = ti*board->n_tile_cols + tj;
+            if (!board->active[tile]){
+                continue;
+            }
+            int col_begin, col_end;
+            tile_range(board->n_cols, tj, &col_begin, &col_end);
+            // columns within the applied boundary conditions, the rest are copied
+            int step_begin = (col_begin < frozen) ? frozen : col_begin;
+            int step_end = (col_end > board->n_cols-frozen) ? board->n_cols-frozen : col_end;
+
+            long long cells_alive = 0; // number of living cells in the tile
+            int changed = 0; // flag for any cell in the tile changing state
+            uint64_t hash = 0, shape = 0;
+            int box[4] = {row_end, row_begin-1, col_end, col_begin-1}; // first/last row and column of living cells
+
+            for (int i = row_begin; i < row_end; i++){
+                const Cell *above = &CELL(board,i-1,0);
+                const Cell *row = &CELL(board,i,0);
+                const Cell *below = &CELL(board,i+1,0);
+                Cell *out = &NEXT_CELL(board,i,0);
+                if (i < frozen || i >= board->n_rows-frozen){ // frozen row
+                    memcpy(out + col_begin, row + col_begin, (size_t)(col_end - col_begin) * sizeof(Cell));
+                    continue;
+                }
+                for (int j = col_begin; j < step_begin; j++){ // frozen first column
+                    out[j] = row[j];
+                }
+                for (int j = step_end; j < col_end; j++){ // frozen last column
+                    out[j] = row[j];
+                }
+
+                // Take 8 cell neighbourhood for each cell 'o' from the column sums either side and through it
+                //[1,2,3
+                // 4,o,5
+                // 6,7,8]
+                int west = above[step_begin-1].alive + row[step_begin-1].alive + below[step_begin-1].alive;
+                int centre = above[step_begin].alive + row[step_begin].alive + below[step_begin].alive;
+                int row_alive = 0, first_col = col_end, last_col = col_begin-1;
+                for (int j = step_begin; j < step_end; j++){ // no branches on the cells, which are unpredictable
+                    int east = above[j+1].alive + row[j+1].alive + below[j+1].alive;
+                    int n_neighbours = west + centre + east - row[j].alive; // 0 to 8
+                    int was_alive = row[j].alive;
+                    int alive = next_state[9*was_alive + n_neighbours]; // born, survives or dies
+                    out[j].alive = alive;
+                    row_alive += alive; // add to living cell count
+                    changed |= alive ^ was_alive;
+                    if (hash_cells){ // the same for every cell, so always predicted
+                        hash ^= mix_hash(HASH_SEED + (uint64_t)i*board->n_cols + j) & -(uint64_t)alive;
+                        shape += shape_keys[9*alive + n_neighbours];
+                    }
+                    if (count_changes){
+                        births += alive & !was_alive;
+                        deaths += was_alive & !alive;
+                        first_col = (alive && j < first_col) ? j : first_col;
+                        last_col = alive ? j : last_col;
+                    }
+                    west = centre;
+                    centre = east;
+                }
+                cells_alive += row_alive;
+                if (row_alive > 0 && count_changes){
+                    box[0] = (i < box[0]) ? i : box[0];
+                    box[1] = i; // rows are in order
+                    box[2] = (first_col < box[2]) ? first_col : box[2];
+                    box[3] = (last_col > box[3]) ? last_col : box[3];
+                }
+            }
+            board->tile_alive[tile] = cells_alive;
+            board->tile_hash[tile] = hash;
+            board->tile_shape[tile] = shape;
+            board->dirty[tile] = changed;
+            uint8_t *tile_box = &board->tile_box[4*(size_t)tile]; // kept relative to the tile's first row and column
+            tile_box[0] = (uint8_t)(box[0] - ti*TILE_SIZE);
+            tile_box[1] = (uint8_t)(box[1] - ti*TILE_SIZE);
+            tile_box[2] = (uint8_t)(box[2] - tj*TILE_SIZE);
+            tile_box[3] = (uint8_t)(box[3] - tj*TILE_SIZE);
+        }
+    }
+    task->births[stripe] = births;
+    task->deaths[stripe] = deaths;
+}
+
+static int find_active_tiles(Board *board, int fixed_bounds){
+    /*
+    Flag the tiles to recalculate this generation: those which changed in the last generation and the 8 tiles around
+    each of them (wrapped toroidally, which covers the edges of every bounded topology). Every other tile and its
+    neighbours are unchanged, so its cells would only be set to the states they already have. Return the number of
+    active tiles.
+    - On a Klein bottle the top and bottom edges are joined reversed, so a change anywhere along one of them
+      activates the whole tile row along the other
+    */
+    int n_tile_rows = board->n_tile_rows, n_tile_cols = board->n_tile_cols;
+    int n_active = 0;
+    uint8_t top_dirty = 0, bottom_dirty = 0; // any tile changed along the top or bottom edge (Klein bottle)
+    if (fixed_bounds == KLEIN_BOUNDS){
+        for (int tj = 0; tj < n_tile_cols; tj++){
+            top_dirty |= board->dirty[tj];
+            bottom_dirty |= board->dirty[(n_tile_rows-1)*n_tile_cols + tj];
+        }
+    }
+    for (int ti = 0; ti < n_tile_rows; ti++){
+        int up = (ti == 0) ? n_tile_rows-1 : ti-1;
+        int down = (ti == n_tile_rows-1) ? 0 : ti+1;
+        for (int tj = 0; tj < n_tile_cols; tj++){
+            int left = (tj == 0) ? n_tile_cols-1 : tj-1;
+            int right = (tj == n_tile_cols-1) ? 0 : tj+1;
+            const uint8_t *d = board->dirty;
+            int active = d[up*n_tile_cols + left] | d[up*n_tile_cols + tj] | d[up*n_tile_cols + right]
+                       | d[ti*n_tile_cols + left] | d[ti*n_tile_cols + tj] | d[ti*n_tile_cols + right]
+                       | d[down*n_tile_cols + left] | d[down*n_tile_cols + tj] | d[down*n_tile_cols + right]
+                       | ((ti == 0) ? bottom_dirty : 0) | ((ti == n_tile_rows-1) ? top_dirty : 0);
+            board->active[ti*n_tile_cols + tj] = (uint8_t)active;
+            n_active += active;
+        }
+    }
+    return n_active;
+}
+
+long long update_board(Board *board, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool){
+    /*
+    Update the board based on the game rules. Return the number of living cells after update.
+    Inputs: board - pointer to the board (declared by create_board)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries, or
+                           DEAD_BOUNDS, REFLECT_BOUNDS or KLEIN_BOUNDS, see fill_halo)
+            birth_mask - dead cells with n neighbours become alive if bit n is set (see parse_rule)
+            survive_mask - living cells with n neighbours stay alive if bit n is set, and die otherwise
+            pool - threads to split the board between in horizontal stripes (NULL for a single thread)
+    - Only the tiles next to a tile which changed in the last generation are recalculated (see find_active_tiles),
+      the number of them is left in board->n_active_tiles
+    - Calculate the next generation into the next grid in one pass, every stripe reading the rows either side of
+      it in the current grid, then swap the grids
+    - Return number of living cells, summed over the tiles
+    - Leave board->hash, a hash of the cells of the new generation, and board->shape, a hash of the old generation
+      which is the same wherever the pattern is on a toroidal board, both combined from the tiles (see step_stripe).
+      Both are 0 unless board->hash_cells is set, and setting it recalculates every tile once
+    - Leave board->counts, the births and deaths of the generation and the bounding box of its living cells
+      (excluding fixed boundaries), from the counts of the stripes and the boxes of the tiles. Unless
+      board->count_changes is set births and deaths are -1 and there is no box, and setting it recalculates every
+      tile once
+    */
+    int rules[5] = {fixed_bounds, (int)birth_mask, (int)survive_mask, board->hash_cells, board->count_changes};
+    if (memcmp(rules, board->last_rules, sizeof(rules)) != 0){ // cells settled under other rules may change, and
+                                                              // skipped tiles may not have been hashed or boxed
+        mark_board_dirty(board);
+        memcpy(board->last_rules, rules, sizeof(rules));
+    }
+    size_t n_tiles = (size_t)board->n_tile_rows * board->n_tile_cols;
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_births[n_stripes], stripe_deaths[n_stripes];
+    UpdateTask task = {board, fixed_bounds, birth_mask, survive_mask, stripe_births, stripe_deaths};
+
+    board->n_active_tiles = find_active_tiles(board, fixed_bounds);
+    memset(board->dirty, 0, n_tiles); // skipped tiles do not change, active tiles are flagged by step_stripe
+    clear_step_counts(&board->counts);
+    if (board->n_active_tiles > 0){
+        fill_halo(board, fixed_bounds); // apply the boundary conditions once for the whole board
+        run_thread_pool(pool, step_stripe, &task); // Calculate the next generation of each active cell
+
+        Cell *swap = board->cells; // the next generation becomes the current one
+        board->cells = board->next;
+        board->next = swap;
+        for (int k = 0; k < n_stripes; k++){
+            board->counts.births += stripe_births[k];
+            board->counts.deaths += stripe_deaths[k];
+        }
+    }
+
+    long long cells_alive = 0; // number of living cells on the board
+    uint64_t hash = 0, shape = 0;
+    for (size_t k = 0; k < n_tiles; k++){
+        cells_alive += board->tile_alive[k];
+        hash ^= board->tile_hash[k];
+        shape += board->tile_shape[k];
+        if (board->count_changes && board->tile_alive[k] > 0){ // widen the box to cover the tile's living cells
+            const uint8_t *tile_box = &board->tile_box[4*k];
+            long long row0 = (long long)(k / board->n_tile_cols) * TILE_SIZE, col0 = (long long)(k % board->n_tile_cols) * TILE_SIZE;
+            StepCounts tile = {0, 0, row0 + tile_box[0], row0 + tile_box[1], col0 + tile_box[2], col0 + tile_box[3]};
+            add_step_counts(&board->counts, &tile);
+        }
+    }
+    if (!board->count_changes){
+        board->counts.births = board->counts.deaths = -1;
+    }
+    board->hash = board->hash_cells ? hash : 0;
+    board->shape = board->hash_cells ? shape : 0;
+    return cells_alive;
+}
+
+void add_living_cell(Board *board, int x, int y){
+    /*
+    Add a living cell to the grid inplace.
+    Inputs: board - pointer to the board (declared by create_board)
+            x, y - coords of living cell to add
+    - Checks to ensure coords of cell don't overflow board
+    - Add living cell in place
+    */
+    x -= 1; y -= 1; // decrement x and y to 'natural' coords starting from 1 as passed by user (indices of array start from 0)
+
+    if (x >= 0 && x < board->n_rows && y >= 0 && y < board->n_cols){ // Error check that coords within bounds of board
+        CELL(board,x,y).alive = ALIVE; // make cell at coords alive.
+        board->dirty[(x/TILE_SIZE)*board->n_tile_cols + y/TILE_SIZE] = 1; // recalculate its tile in the next generation
+    }else{
+        printf("[ERROR] add_living_cell - Overflow error: coords exceed size of grid\n");
+    }
+}
+
+void free_board(Board *board){
+    /*
+    Free the dynamically allocated memory for the board.
+    Inputs: pointer to the board (declared by create_board). The Cells are freed with it as they share one allocation.
+    - A large board's block is kept to be reused by the next board of the same size (see free_board_memory)
+    */
+    free_board_memory(board, board_bytes(board->n_rows, board->n_cols));
+}
+
+Board* load_board(const char *filename, int *fixed_bounds, int echo){
+    /*
+    Read a board from file: either the game's own plain text format (a header row giving the size and boundary
+    conditions, followed by one row of 0's (dead) and 1's (alive) for each row of the board) or a RLE, Life 1.06
+    or plaintext pattern (see pattern_io.h). Return the new board.
+    Inputs: filename - file to read in grid from
+            *fixed_bounds - set to the type of boundary conditions given in the file (INFINITE_BOUNDS for patterns)
+            echo - 1 to print the cell states to the console once read, 0 to read silently
+    - Error checks that the file exists, has a header and only holds a grid of the size given in the header
+    */
+    PatternInfo info;
+    BitBoard *bb = read_pattern(filename, &info); // parsed from a memory mapping of the file
+    Board *board = create_board(bb->n_rows, bb->n_cols);
+    bitboard_to_cells(bb, board);
+    free_bitboard(bb);
+    *fixed_bounds = info.fixed_bounds;
+
+    if (echo){ // one buffered line per row
+        char *line = (char *)malloc(2*(size_t)board->n_cols + 2);
+        if (line == NULL){
+            printf("[ERROR] Out of memory whilst reading the board\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < board->n_rows; i++){
+            for (int j = 0; j < board->n_cols; j++){
+                line[2*j] = (char)(ASCII_ADJUST + CELL(board,i,j).alive);
+                line[2*j+1] = ' ';
+            }
+            line[2*board->n_cols] = NEWLINE_CHAR;
+            line[2*board->n_cols+1] = '\0';
+            fputs(line, stdout);
+        }
+        free(line);
+    }
+    return board;
+}
+
+void write_board(const Board *board, int fixed_bounds, const char *filename){
+    /*
+    Save board state to a file with the header read by load_board.
+    Inputs: board - pointer to the board (declared by create_board)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries, see fill_halo)
+            filename - file to write the board to (overwritten)
+    - Each row is built in memory and written in one call
+    */
+    FILE *file = fopen(filename, "w"); // open file
+
+    if (file == NULL){ // error check file found
+        printf("[ERROR]: Save file %s could not be opened\n",filename);
+        exit(EXIT_FAILURE);
+    }
+    char *line = (char *)malloc((size_t)board->n_cols + 1);
+    if (line == NULL){
+        printf("[ERROR] Out of memory whilst saving the board\n");
+        exit(EXIT_FAILURE);
+    }
+    fprintf(file, "n_rows:%d, n_cols:%d, fixed_bounds:%d\n",board->n_rows,board->n_cols,fixed_bounds); // print header row
+    for (int i = 0; i < board->n_rows; i++){
+        for (int j = 0; j < board->n_cols; j++){
+            line[j] = (char)(ASCII_ADJUST + CELL(board,i,j).alive); // states as '0' and '1'
+        }
+        line[board->n_cols] = NEWLINE_CHAR;
+        fwrite(line, 1, (size_t)board->n_cols + 1, file);
+    }
+    free(line);
+    fclose(file); // close the file
+}
+
+void save_board(const Board *board, int fixed_bounds){
+   /*
+    Ask user whether they want to save the current alive/dead state of cells
+    Save board state to the file given by CUSTOM_BOARD_FILE with corresponding header.
+    Inputs: board - pointer to the board (declared by create_board)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries, see fill_halo)
+    */
+    int save = -1; // flag
+
+    printf("\nWould you like to save the board?\n");
+    printf("\t1: Yes\n");
+    printf("\t0: No\n");
+    scanf("%d",&save); // Take user input
+
+    if (save == 1){
+        printf("Saving grid to %s\n",CUSTOM_BOARD_FILE);
+        write_board(board, fixed_bounds, CUSTOM_BOARD_FILE);
+        printf("Save successful");
+
+    }else if(save != 0){ // Invalid selection
+        printf("[ERROR] Please choose an option from the menu");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static const char *bounds_names[N_BOUNDS] = {"torus", "fixed", "infinite", "dead", "reflect", "klein"};
+
+const char* bounds_name(int fixed_bounds){
+    // Name of a type of boundary conditions, as given to --bounds
+    return (fixed_bounds >= 0 && fixed_bounds < N_BOUNDS) ? bounds_names[fixed_bounds] : "unknown";
+}
+
+int find_bounds(const char *name){
+    // Type of boundary conditions with this name, -1 if there is none
+    for (int k = 0; k < N_BOUNDS; k++){
+        if (strcmp(name, bounds_names[k]) == 0){
+            return k;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,185 @@
+/*
+* Memory for large boards for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ A block of at least HUGE_PAGE_SIZE is always mapped with its length rounded up to a whole number of huge pages,
+ so free_board_memory can work out the length to unmap from the size asked for, and the cache only hands a block
+ to an allocation that rounds up to the same length. The cache is guarded by a lock so a board can be freed on any
+ thread, but the lock is only ever held to look through its few slots.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "board_memory.h"
+
+static ThreadPool *touch_pool = NULL; // threads clearing the grids of large boards
+
+// Define a structure with alias 'CachedBlock' for a freed block kept for reuse
+typedef struct cached_block{
+    void *memory;
+    size_t length; // bytes mapped, a whole number of huge pages
+}CachedBlock;
+
+static CachedBlock cache[BOARD_MEMORY_CACHE]; // oldest first
+static int n_cached = 0;
+static size_t cached_bytes = 0;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t mapped_length(size_t n_bytes){
+    // Length of the mapping for a block of n_bytes, rounded up to whole huge pages
+    return (n_bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+static void* map_huge_pages(size_t length){
+    /*
+    Map length bytes (whole huge pages) of private memory on huge pages. Return NULL if out of memory.
+    - Explicit huge pages are used if the system has reserved enough of them (vm.nr_hugepages)
+    - Otherwise a huge page more is mapped, trimmed so the block starts on a huge page boundary, and advised to be
+      backed by transparent huge pages (which the kernel may or may not do, depending on its settings)
+    */
+#ifdef MAP_HUGETLB
+    void *memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED){
+        return memory;
+    }
+#endif
+    char *raw = (char *)mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED){
+        return NULL;
+    }
+    char *aligned = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > raw){
+        munmap(raw, (size_t)(aligned - raw));
+    }
+    if (raw + HUGE_PAGE_SIZE > aligned){
+        munmap(aligned + length, (size_t)(raw + HUGE_PAGE_SIZE - aligned));
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+void set_board_memory_pool(ThreadPool *pool){
+    /*
+    Set the threads that clear the grids of new large boards, which should be the pool they will be stepped with.
+    Inputs: pool - thread pool (declared by create_thread_pool), NULL to clear them on the calling thread
+    */
+    touch_pool = pool;
+}
+
+ThreadPool* board_memory_pool(size_t n_bytes){
+    // Return the pool to clear a block of n_bytes with, NULL for a block too small to be on huge pages
+    return (n_bytes >= HUGE_PAGE_SIZE) ? touch_pool : NULL;
+}
+
+void* alloc_board_memory(size_t n_bytes){
+    /*
+    Allocate a block for the grids of a board. Its contents are undefined: a new mapping is all zero, but a block
+    from the cache holds whatever board used it last.
+    Inputs: n_bytes - size of the block
+    - Error checks for memory
+    */
+    void *memory = NULL;
+    if (n_bytes < HUGE_PAGE_SIZE){
+        memory = malloc(n_bytes);
+    }else{
+        size_t length = mapped_length(n_bytes);
+        pthread_mutex_lock(&cache_lock);
+        for (int k = n_cached - 1; k >= 0 && memory == NULL; k--){ // newest first
+            if (cache[k].length == length){
+                memory = cache[k].memory;
+                cached_bytes -= length;
+                memmove(&cache[k], &cache[k+1], (n_cached - k - 1)*sizeof(CachedBlock));
+                n_cached--;
+            }
+        }
+        pthread_mutex_unlock(&cache_lock);
+        if (memory == NULL){
+            memory = map_huge_pages(length);
+        }
+    }
+    if (memory == NULL){
+        printf("[ERROR] Out of memory whilst creating the board\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+void free_board_memory(void *memory, size_t n_bytes){
+    /*
+    Free a block from alloc_board_memory, keeping it for the next board of the same size if it is large.
+    Inputs: memory - the block
+            n_bytes - size it was allocated with
+    - Once BOARD_MEMORY_CACHE blocks or BOARD_MEMORY_CACHE_MB megabytes are kept, the oldest ones are unmapped
+    */
+    if (n_bytes < HUGE_PAGE_SIZE){
+        free(memory);
+        return;
+    }
+    size_t length = mapped_length(n_bytes);
+    if (length > ((size_t)BOARD_MEMORY_CACHE_MB << 20)){ // too large to keep
+        munmap(memory, length);
+        return;
+    }
+    pthread_mutex_lock(&cache_lock);
+    while (n_cached == BOARD_MEMORY_CACHE || cached_bytes + length > ((size_t)BOARD_MEMORY_CACHE_MB << 20)){
+        munmap(cache[0].memory, cache[0].length);
+        cached_bytes -= cache[0].length;
+        memmove(&cache[0], &cache[1], (n_cached - 1)*sizeof(CachedBlock));
+        n_cached--;
+    }
+    cache[n_cached].memory = memory;
+    cache[n_cached].length = length;
+    n_cached++;
+    cached_bytes += length;
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// Define a structure with alias 'RowsTask' for rows of words cleared by the stripes of a pool
+typedef struct rows_task{
+    uint64_t *rows;
+    int n_rows, n_words;
+}RowsTask;
+
+static void clear_rows_stripe(void *arg, int stripe, int n_stripes){
+    // Clear the rows of one stripe, split as the bit-packed boards split them to step them (see stripe_range)
+    RowsTask *task = (RowsTask *)arg;
+    int row_begin, row_end;
+    stripe_range(task->n_rows, stripe, n_stripes, &row_begin, &row_end);
+    size_t n_words = (size_t)(row_end - row_begin)*task->n_words;
+    memset(task->rows + (size_t)row_begin*task->n_words, 0, n_words*sizeof(uint64_t));
+}
+
+uint64_t* alloc_board_rows(int n_rows, int n_words){
+    /*
+    Allocate n_rows rows of n_words words for a bit-packed (or nibble-packed) board, all zero.
+    - A large block is cleared by the pool (see set_board_memory_pool), each thread clearing the rows it will step
+    */
+    size_t n_bytes = (size_t)n_rows*n_words*sizeof(uint64_t);
+    RowsTask task = {(uint64_t *)alloc_board_memory(n_bytes), n_rows, n_words};
+    run_thread_pool(board_memory_pool(n_bytes), clear_rows_stripe, &task);
+    return task.rows;
+}
+
+void free_board_rows(uint64_t *rows, int n_rows, int n_words){
+    // Free rows from alloc_board_rows
+    free_board_memory(rows, (size_t)n_rows*n_words*sizeof(uint64_t));
+}
+
+void release_board_memory(void){
+    // Unmap every freed block kept for reuse
+    pthread_mutex_lock(&cache_lock);
+    for (int k = 0; k < n_cached; k++){
+        munmap(cache[k].memory, cache[k].length);
+    }
+    n_cached = 0;
+    cached_bytes = 0;
+    pthread_mutex_unlock(&cache_lock);
+}
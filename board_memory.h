@@ -0,0 +1,42 @@
+/*
+* Memory for large boards for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Allocates the grids of the boards (Board, BitBoard and GenBoard, with their buffers for the next
+              generation) so that a large board does not pay a TLB miss or a trip to another socket's memory for
+              every few rows it steps.
+                - Blocks of at least HUGE_PAGE_SIZE are mapped on 2 MB huge pages: explicit ones if the system has
+                  reserved any, otherwise a mapping aligned to a huge page and advised to use transparent huge pages
+                - Linux places each page on the memory (NUMA) node of the thread that first writes it. The board
+                  code clears a new grid with the threads of the pool set by set_board_memory_pool, each clearing
+                  the rows its stripe will step, so every stripe's rows end up next to the thread stepping them
+                - A freed block is kept (up to BOARD_MEMORY_CACHE of them) and handed out again for the next board
+                  of the same size, so running the same board again does not map, fault in and zero it again
+              Smaller blocks are taken from malloc as before and cleared by the calling thread.
+              Boards are only created by the thread that runs tasks on the pool (see run_thread_pool).
+ */
+
+#ifndef BOARD_MEMORY_H
+#define BOARD_MEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "thread_pool.h"
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20) // Bytes in a huge page, the smallest block mapped on huge pages
+#define BOARD_MEMORY_CACHE 8 // Freed blocks kept for reuse
+#define BOARD_MEMORY_CACHE_MB 1024 // Most memory kept in freed blocks (megabytes)
+
+// Prototype function definitions
+void set_board_memory_pool(ThreadPool *pool); // threads clearing new grids, NULL for the calling thread alone
+ThreadPool* board_memory_pool(size_t n_bytes); // pool to clear a block of n_bytes with (NULL if small)
+void* alloc_board_memory(size_t n_bytes); // contents undefined
+void free_board_memory(void *memory, size_t n_bytes); // n_bytes as allocated
+uint64_t* alloc_board_rows(int n_rows, int n_words); // all zero, cleared stripe by stripe
+void free_board_rows(uint64_t *rows, int n_rows, int n_words);
+void release_board_memory(void); // unmap the freed blocks kept for reuse
+
+#endif // BOARD_MEMORY_H
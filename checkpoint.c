@@ -0,0 +1,438 @@
+/*
+* Binary checkpoints for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ The payload is a flat array of 64 bit words (the rows of a bit-packed board, or each chunk of a sparse plane as its
+ coords and rows). It is compressed as tokens of two uint32 counts, n_zero and n_literal, meaning n_zero zero words
+ followed by the next n_literal words as they are. Empty areas of a board cost 8 bytes per run and a dense board
+ costs at most 8 bytes per 2^32-1 words more than the raw bits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "CONWAYCK"
+#define CHECKPOINT_HEADER_SIZE 72 // bytes before the payload
+#define CHECKPOINT_BUFFER 8192 // words written at once
+
+static uint32_t crc_table[256];
+
+static void make_crc_table(void){
+    // Fill the table for the standard (zlib) CRC-32 polynomial
+    for (uint32_t n = 0; n < 256; n++){
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++){
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[n] = c;
+    }
+}
+
+static uint32_t update_crc(uint32_t crc, const void *data, size_t n){
+    // Add n bytes to a running CRC-32 (start from 0)
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, make_crc_table);
+    const unsigned char *p = (const unsigned char *)data;
+    crc = ~crc;
+    for (size_t k = 0; k < n; k++){
+        crc = crc_table[(crc ^ p[k]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void put_u32(unsigned char *p, uint32_t v){
+    // Store v little-endian
+    for (int k = 0; k < 4; k++){
+        p[k] = (unsigned char)(v >> (8*k));
+    }
+}
+
+static void put_u64(unsigned char *p, uint64_t v){
+    // Store v little-endian
+    for (int k = 0; k < 8; k++){
+        p[k] = (unsigned char)(v >> (8*k));
+    }
+}
+
+static uint32_t get_u32(const unsigned char *p){
+    // Load a little-endian uint32
+    uint32_t v = 0;
+    for (int k = 0; k < 4; k++){
+        v |= (uint32_t)p[k] << (8*k);
+    }
+    return v;
+}
+
+static uint64_t get_u64(const unsigned char *p){
+    // Load a little-endian uint64
+    uint64_t v = 0;
+    for (int k = 0; k < 8; k++){
+        v |= (uint64_t)p[k] << (8*k);
+    }
+    return v;
+}
+
+static void pack_header(unsigned char *header, const CheckpointInfo *info, uint64_t n_words){
+    // Lay out the header fields
+    memcpy(header, CHECKPOINT_MAGIC, 8);
+    put_u32(header + 8, CHECKPOINT_VERSION);
+    put_u32(header + 12, (uint32_t)info->type);
+    put_u32(header + 16, (uint32_t)info->n_rows);
+    put_u32(header + 20, (uint32_t)info->n_cols);
+    put_u32(header + 24, (uint32_t)info->fixed_bounds);
+    put_u32(header + 28, info->birth_mask);
+    put_u32(header + 32, info->survive_mask);
+    put_u32(header + 36, 0); // reserved
+    put_u64(header + 40, info->generation);
+    put_u64(header + 48, (uint64_t)info->row0);
+    put_u64(header + 56, (uint64_t)info->col0);
+    put_u64(header + 64, n_words);
+}
+
+// Output file with the running CRC of what has been written
+typedef struct crc_file{
+    FILE *file;
+    uint32_t crc;
+    int failed;
+}CrcFile;
+
+static void crc_write(CrcFile *out, const void *data, size_t n){
+    // Write n bytes and add them to the CRC
+    out->crc = update_crc(out->crc, data, n);
+    if (fwrite(data, 1, n, out->file) != n){
+        out->failed = 1;
+    }
+}
+
+static void write_words(CrcFile *out, const uint64_t *words, size_t n_words){
+    /*
+    Write the words as tokens of (n_zero, n_literal) followed by the literal words (see top of file).
+    - Literal words are collected in a buffer and written little-endian in blocks
+    */
+    unsigned char buffer[8*CHECKPOINT_BUFFER];
+    unsigned char token[8];
+    size_t k = 0;
+    while (k < n_words){
+        size_t zeros = k;
+        while (zeros < n_words && words[zeros] == 0 && zeros - k < UINT32_MAX){
+            zeros++;
+        }
+        size_t literal = zeros; // literal run ends at the next pair of zero words (a single zero is cheaper inline)
+        while (literal < n_words && literal - zeros < UINT32_MAX
+               && !(words[literal] == 0 && (literal+1 == n_words || words[literal+1] == 0))){
+            literal++;
+        }
+        put_u32(token, (uint32_t)(zeros - k));
+        put_u32(token + 4, (uint32_t)(literal - zeros));
+        crc_write(out, token, 8);
+        for (size_t w = zeros; w < literal; w += CHECKPOINT_BUFFER){
+            size_t n = (literal - w < CHECKPOINT_BUFFER) ? literal - w : CHECKPOINT_BUFFER;
+            for (size_t m = 0; m < n; m++){
+                put_u64(buffer + 8*m, words[w+m]);
+            }
+            crc_write(out, buffer, 8*n);
+        }
+        k = literal;
+    }
+}
+
+static void write_snapshot(const char *path, const CheckpointInfo *info, const uint64_t *words, size_t n_words){
+    /*
+    Write a checkpoint file from a flat array of payload words.
+    - Written to path.tmp, flushed to disk and renamed over path, so path always holds a whole checkpoint
+    */
+    size_t length = strlen(path);
+    char *tmp_path = (char *)malloc(length + 5);
+    if (tmp_path == NULL){
+        printf("[ERROR] Out of memory whilst writing checkpoint %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(tmp_path, path, length);
+    memcpy(tmp_path + length, ".tmp", 5);
+
+    CrcFile out = {fopen(tmp_path, "wb"), 0, 0};
+    if (out.file == NULL){
+        printf("[ERROR]: Checkpoint file %s could not be opened\n", tmp_path);
+        exit(EXIT_FAILURE);
+    }
+    unsigned char header[CHECKPOINT_HEADER_SIZE], trailer[4];
+    pack_header(header, info, (uint64_t)n_words);
+    crc_write(&out, header, CHECKPOINT_HEADER_SIZE);
+    write_words(&out, words, n_words);
+    put_u32(trailer, out.crc);
+    if (fwrite(trailer, 1, 4, out.file) != 4){
+        out.failed = 1;
+    }
+    if (fflush(out.file) != 0 || fsync(fileno(out.file)) != 0){
+        out.failed = 1;
+    }
+    fclose(out.file);
+    if (out.failed || rename(tmp_path, path) != 0){
+        printf("[ERROR]: Writing checkpoint %s failed\n", path);
+        exit(EXIT_FAILURE);
+    }
+    free(tmp_path);
+}
+
+static size_t snapshot_size(const BitBoard *bb, const SparsePlane *plane){
+    // Number of payload words needed for a board or plane
+    if (bb != NULL){
+        return (size_t)bb->n_rows * bb->n_words;
+    }
+    return plane->n_chunks * (2 + CHUNK_SIZE);
+}
+
+static void copy_snapshot(uint64_t *words, const BitBoard *bb, const SparsePlane *plane){
+    // Flatten a board or plane into payload words
+    if (bb != NULL){
+        memcpy(words, bb->cells, (size_t)bb->n_rows * bb->n_words * sizeof(uint64_t));
+        return;
+    }
+    for (size_t k = 0; k < plane->n_chunks; k++){
+        const Chunk *chunk = plane->chunks[k];
+        words[0] = (uint64_t)chunk->row;
+        words[1] = (uint64_t)chunk->col;
+        memcpy(words + 2, chunk->cells, CHUNK_SIZE * sizeof(uint64_t));
+        words += 2 + CHUNK_SIZE;
+    }
+}
+
+void write_checkpoint(const char *path, const CheckpointInfo *info, const BitBoard *bb, const SparsePlane *plane){
+    /*
+    Write a checkpoint now, on the calling thread.
+    Inputs: path - checkpoint file (replaced once the new checkpoint is complete)
+            info - boundary conditions, rule, generation and window to save (type and size are taken from a board)
+            bb, plane - the bit-packed board, or if bb is NULL the sparse plane, to save
+    */
+    size_t n_words = snapshot_size(bb, plane);
+    uint64_t *words = (uint64_t *)malloc((n_words > 0 ? n_words : 1) * sizeof(uint64_t));
+    if (words == NULL){
+        printf("[ERROR] Out of memory whilst writing checkpoint %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    copy_snapshot(words, bb, plane);
+    CheckpointInfo saved = *info;
+    saved.type = (bb != NULL) ? CHECKPOINT_BITBOARD : CHECKPOINT_SPARSE;
+    saved.n_rows = (bb != NULL) ? bb->n_rows : info->n_rows;
+    saved.n_cols = (bb != NULL) ? bb->n_cols : info->n_cols;
+    write_snapshot(path, &saved, words, n_words);
+    free(words);
+}
+
+static void read_exact(FILE *file, void *data, size_t n, uint32_t *crc, const char *path){
+    // Read n bytes and add them to the CRC, the file is truncated if they are not all there
+    if (fread(data, 1, n, file) != n){
+        printf("[ERROR]: Checkpoint %s is truncated\n", path);
+        exit(EXIT_FAILURE);
+    }
+    *crc = update_crc(*crc, data, n);
+}
+
+void read_checkpoint(const char *path, CheckpointInfo *info, BitBoard **bb, SparsePlane **plane){
+    /*
+    Read a checkpoint written by write_checkpoint or a Checkpointer.
+    Inputs: path - checkpoint file
+            *info - set to the boundary conditions, rule and generation saved
+            *bb, *plane - set to the saved board (and *plane to NULL), or the saved plane (and *bb to NULL)
+    - Error checks the magic number, version, size and CRC, so a damaged checkpoint is never resumed from
+    */
+    FILE *file = fopen(path, "rb");
+    if (file == NULL){
+        printf("[ERROR]: Checkpoint %s does not exist\n", path);
+        exit(EXIT_FAILURE);
+    }
+    uint32_t crc = 0;
+    unsigned char header[CHECKPOINT_HEADER_SIZE];
+    read_exact(file, header, CHECKPOINT_HEADER_SIZE, &crc, path);
+    if (memcmp(header, CHECKPOINT_MAGIC, 8) != 0){
+        printf("[ERROR]: %s is not a checkpoint\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (get_u32(header + 8) != CHECKPOINT_VERSION){
+        printf("[ERROR]: Checkpoint %s has version %u, this program reads version %d\n", path,
+               get_u32(header + 8), CHECKPOINT_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    info->type = (int)get_u32(header + 12);
+    info->n_rows = (int)get_u32(header + 16);
+    info->n_cols = (int)get_u32(header + 20);
+    info->fixed_bounds = (int)get_u32(header + 24);
+    info->birth_mask = get_u32(header + 28);
+    info->survive_mask = get_u32(header + 32);
+    info->generation = get_u64(header + 40);
+    info->row0 = (long long)get_u64(header + 48);
+    info->col0 = (long long)get_u64(header + 56);
+    uint64_t n_words = get_u64(header + 64);
+
+    size_t expected = 0; // words the board needs (sparse planes are a whole number of chunks)
+    if (info->type == CHECKPOINT_BITBOARD && info->n_rows > 0 && info->n_cols > 0){
+        expected = (size_t)info->n_rows * ((info->n_cols + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    }
+    if ((info->type == CHECKPOINT_BITBOARD && n_words != expected)
+        || (info->type == CHECKPOINT_SPARSE && n_words % (2 + CHUNK_SIZE) != 0)
+        || (info->type != CHECKPOINT_BITBOARD && info->type != CHECKPOINT_SPARSE)){
+        printf("[ERROR]: Checkpoint %s is damaged (payload does not match the header)\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t *words = (uint64_t *)calloc(n_words > 0 ? n_words : 1, sizeof(uint64_t)); // zero runs are left as they are
+    unsigned char *buffer = (unsigned char *)malloc(8*CHECKPOINT_BUFFER);
+    if (words == NULL || buffer == NULL){
+        printf("[ERROR] Out of memory whilst reading checkpoint %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    uint64_t k = 0;
+    while (k < n_words){
+        unsigned char token[8];
+        read_exact(file, token, 8, &crc, path);
+        uint64_t zeros = get_u32(token), literal = get_u32(token + 4);
+        if (zeros + literal > n_words - k || zeros + literal == 0){
+            printf("[ERROR]: Checkpoint %s is damaged (bad run of words)\n", path);
+            exit(EXIT_FAILURE);
+        }
+        k += zeros;
+        while (literal > 0){
+            size_t n = (literal < CHECKPOINT_BUFFER) ? (size_t)literal : CHECKPOINT_BUFFER;
+            read_exact(file, buffer, 8*n, &crc, path);
+            for (size_t m = 0; m < n; m++){
+                words[k+m] = get_u64(buffer + 8*m);
+            }
+            k += n;
+            literal -= n;
+        }
+    }
+    unsigned char trailer[4];
+    if (fread(trailer, 1, 4, file) != 4 || get_u32(trailer) != crc){
+        printf("[ERROR]: Checkpoint %s is damaged (CRC does not match)\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    free(buffer);
+
+    *bb = NULL;
+    *plane = NULL;
+    if (info->type == CHECKPOINT_BITBOARD){
+        *bb = create_bitboard(info->n_rows, info->n_cols);
+        memcpy((*bb)->cells, words, n_words * sizeof(uint64_t));
+    }else{
+        *plane = create_sparse();
+        for (uint64_t c = 0; c < n_words; c += 2 + CHUNK_SIZE){
+            long long row = (long long)words[c], col = (long long)words[c+1];
+            for (int r = 0; r < CHUNK_SIZE; r++){
+                for (uint64_t word = words[c+2+r]; word != 0; word &= word - 1){
+                    set_sparse_cell(*plane, row*CHUNK_SIZE + r, col*CHUNK_SIZE + __builtin_ctzll(word), ALIVE);
+                }
+            }
+        }
+    }
+    free(words);
+}
+
+static void* writer_main(void *arg){
+    // Wait for snapshots to be posted and write each one, until told to quit
+    Checkpointer *cp = (Checkpointer *)arg;
+    pthread_mutex_lock(&cp->lock);
+    while (1){
+        while (!cp->pending && !cp->quit){
+            pthread_cond_wait(&cp->posted, &cp->lock);
+        }
+        if (!cp->pending){ // quit once nothing is left to write
+            break;
+        }
+        pthread_mutex_unlock(&cp->lock);
+
+        write_snapshot(cp->path, &cp->info, cp->words, cp->n_words); // the stepping loop does not touch the buffer now
+
+        pthread_mutex_lock(&cp->lock);
+        cp->pending = 0;
+        cp->n_written++;
+    }
+    pthread_mutex_unlock(&cp->lock);
+    return NULL;
+}
+
+Checkpointer* create_checkpointer(const char *path){
+    /*
+    Start a background thread writing checkpoints to path.
+    - Error checks for memory and thread creation
+    */
+    Checkpointer *cp = (Checkpointer *)malloc(sizeof(Checkpointer));
+    if (cp == NULL || (cp->path = strdup(path)) == NULL){
+        printf("[ERROR] Out of memory whilst creating the checkpoint writer\n");
+        exit(EXIT_FAILURE);
+    }
+    cp->words = NULL;
+    cp->n_words = cp->max_words = 0;
+    cp->pending = 0;
+    cp->quit = 0;
+    cp->n_written = cp->n_skipped = 0;
+    pthread_mutex_init(&cp->lock, NULL);
+    pthread_cond_init(&cp->posted, NULL);
+    if (pthread_create(&cp->writer, NULL, writer_main, cp) != 0){
+        printf("[ERROR] Could not start the checkpoint writer thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return cp;
+}
+
+int post_checkpoint(Checkpointer *cp, const CheckpointInfo *info, const BitBoard *bb, const SparsePlane *plane){
+    /*
+    Copy the board (or plane) into the writer's buffer and hand it to the writer thread. Return 1 if the checkpoint
+    was posted, 0 if it was skipped because the writer is still busy with the last one.
+    Inputs: cp - checkpoint writer (declared by create_checkpointer)
+            info, bb, plane - as for write_checkpoint
+    - Never waits for the disk, only for the copy of the board
+    */
+    pthread_mutex_lock(&cp->lock);
+    int busy = cp->pending;
+    pthread_mutex_unlock(&cp->lock);
+    if (busy){
+        cp->n_skipped++;
+        return 0;
+    }
+
+    size_t n_words = snapshot_size(bb, plane); // the writer is idle, so the buffer is ours until posted
+    if (n_words > cp->max_words){
+        free(cp->words);
+        cp->max_words = n_words + n_words/4; // room for a growing plane
+        cp->words = (uint64_t *)malloc(cp->max_words * sizeof(uint64_t));
+        if (cp->words == NULL){
+            printf("[ERROR] Out of memory whilst copying a checkpoint\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    copy_snapshot(cp->words, bb, plane);
+    cp->n_words = n_words;
+    cp->info = *info;
+    cp->info.type = (bb != NULL) ? CHECKPOINT_BITBOARD : CHECKPOINT_SPARSE;
+    cp->info.n_rows = (bb != NULL) ? bb->n_rows : info->n_rows;
+    cp->info.n_cols = (bb != NULL) ? bb->n_cols : info->n_cols;
+
+    pthread_mutex_lock(&cp->lock);
+    cp->pending = 1;
+    pthread_cond_signal(&cp->posted);
+    pthread_mutex_unlock(&cp->lock);
+    return 1;
+}
+
+unsigned long free_checkpointer(Checkpointer *cp){
+    // Wait for any checkpoint still being written, stop the writer thread and free it. Return the number written.
+    pthread_mutex_lock(&cp->lock);
+    cp->quit = 1;
+    pthread_cond_signal(&cp->posted);
+    pthread_mutex_unlock(&cp->lock);
+    pthread_join(cp->writer, NULL);
+    pthread_mutex_destroy(&cp->lock);
+    pthread_cond_destroy(&cp->posted);
+    free(cp->words);
+    free(cp->path);
+    unsigned long n_written = cp->n_written;
+    free(cp);
+    return n_written;
+}
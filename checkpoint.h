@@ -0,0 +1,65 @@
+/*
+* Binary checkpoints for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: A checkpoint holds a bit-packed board (or the chunks of a sparse plane) with its boundary conditions,
+              rule and generation counter, so a run can be resumed exactly where it stopped.
+              File layout (little-endian):
+                - header: magic "CONWAYCK", version, payload type, n_rows, n_cols, fixed_bounds, birth_mask,
+                  survive_mask, generation, row0, col0, number of payload words
+                - payload: the board words, compressed as runs of zero words followed by literal words
+                - trailer: CRC-32 of the header and payload
+              A checkpoint is written to a temporary file which is renamed over the old one once complete, so a
+              crash part way through a write never loses the previous checkpoint.
+              A Checkpointer writes checkpoints from a background thread: the stepping loop only copies the board
+              into its buffer and carries on. If the previous checkpoint is still being written the new one is
+              skipped rather than making the loop wait for the disk.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "sparse.h"
+
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_BITBOARD 0 // payload is the n_rows*n_words words of a bit-packed board
+#define CHECKPOINT_SPARSE 1 // payload is the chunks of a sparse plane: row, col, then CHUNK_SIZE words each
+
+// Define a structure with alias 'CheckpointInfo' for what is saved alongside the cells
+typedef struct checkpoint_info{
+    int type; // CHECKPOINT_BITBOARD or CHECKPOINT_SPARSE
+    int n_rows, n_cols; // size of the board, or of the window onto a sparse plane saved by --output
+    long long row0, col0; // pattern file coords of the top left of the board or window
+    int fixed_bounds; // boundary conditions
+    unsigned birth_mask, survive_mask; // game rules (see parse_rule)
+    unsigned long long generation; // generations run to reach this state
+}CheckpointInfo;
+
+// Define a structure with alias 'Checkpointer' for a background thread writing checkpoints
+typedef struct checkpointer{
+    char *path; // checkpoint file, replaced by every checkpoint
+    pthread_t writer;
+    pthread_mutex_t lock;
+    pthread_cond_t posted; // signalled when a snapshot is ready to write
+    CheckpointInfo info; // snapshot being written
+    uint64_t *words;
+    size_t n_words, max_words;
+    int pending; // 1 while a snapshot is waiting or being written
+    int quit;
+    unsigned long n_written, n_skipped; // checkpoints written and skipped because the writer was busy
+}Checkpointer;
+
+// Prototype function definitions
+void write_checkpoint(const char *path, const CheckpointInfo *info, const BitBoard *bb, const SparsePlane *plane);
+void read_checkpoint(const char *path, CheckpointInfo *info, BitBoard **bb, SparsePlane **plane);
+Checkpointer* create_checkpointer(const char *path);
+int post_checkpoint(Checkpointer *cp, const CheckpointInfo *info, const BitBoard *bb, const SparsePlane *plane);
+unsigned long free_checkpointer(Checkpointer *cp); // waits for the last checkpoint, returns the number written
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,100 @@
+/*
+* Shared definitions for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+#ifndef CONWAY_H
+#define CONWAY_H
+
+#include <stdbool.h> // Booleans
+#include <stddef.h> // size_t
+#include <stdint.h>
+
+#include "thread_pool.h"
+
+#define ALIVE 1
+#define DEAD 0
+#define CUSTOM_BOARD_FILE "custom_board.txt" // The file to store the 'custom' board when save is chosen
+#define ASCII_ADJUST 48 // Map ASCII for integers to their denary (48 in ASCII -> 0 )
+#define NEWLINE_CHAR '\n' // The newline char used in files
+#define INFINITE_BOUNDS 2 // fixed_bounds value for an unbounded plane (see sparse.h), the board is a window onto it
+#define DEAD_BOUNDS 3 // fixed_bounds value for a board with dead cells all around it (see fill_halo)
+#define REFLECT_BOUNDS 4 // fixed_bounds value for a board mirrored along each edge
+#define KLEIN_BOUNDS 5 // fixed_bounds value for a Klein bottle, the sides joined as on a torus and the top and bottom joined reversed
+#define N_BOUNDS 6 // types of boundary conditions, 0 toroidal and 1 fixed (outer ring frozen) to KLEIN_BOUNDS
+#define TILE_SIZE 32 // Rows and columns of cells in each tile tracked for changes by update_board
+
+// Define a structure with alias 'StepCounts' for what a generation changed, counted by the update pass itself
+typedef struct step_counts{
+    long long births, deaths; // cells which came alive and cells which died, -1 if the engine does not count them
+    long long min_row, max_row, min_col, max_col; // bounding box of the living cells, min_row > max_row if none
+}StepCounts;
+
+static inline void clear_step_counts(StepCounts *counts){
+    // No births, deaths or living cells
+    counts->births = counts->deaths = 0;
+    counts->min_row = counts->min_col = INT64_MAX;
+    counts->max_row = counts->max_col = INT64_MIN;
+}
+
+static inline void add_step_counts(StepCounts *total, const StepCounts *part){
+    // Add the births and deaths of part of the board to the total and widen the bounding box to cover it
+    total->births += part->births;
+    total->deaths += part->deaths;
+    total->min_row = (part->min_row < total->min_row) ? part->min_row : total->min_row;
+    total->max_row = (part->max_row > total->max_row) ? part->max_row : total->max_row;
+    total->min_col = (part->min_col < total->min_col) ? part->min_col : total->min_col;
+    total->max_col = (part->max_col > total->max_col) ? part->max_col : total->max_col;
+}
+
+// Define a structure with alias 'Cell' for a cell with a state which can be either ALIVE or DEAD (one byte)
+typedef struct cell{
+    bool alive;
+}Cell;
+
+// Define a structure with alias 'Board' for the board of Cells, stored in one contiguous allocation.
+// Each row is padded with a ghost cell at either end and there is a ghost row above and below the board,
+// so that every cell on the board has all 8 neighbours in memory. A second grid of the same layout takes the next
+// generation, then the two are swapped.
+// The board is also divided into TILE_SIZE x TILE_SIZE tiles. Only the tiles next to a tile which changed in the
+// last generation can change in the next one, so update_board skips all the others.
+typedef struct board{
+    int n_rows, n_cols; // number of rows and columns of the board (excluding the ghost border)
+    size_t stride; // number of Cells from one row to the next in memory (n_cols + 2)
+    Cell *cells; // current generation, (n_rows+2)*stride Cells including the ghost border
+    Cell *next; // next generation, written by update_board before the grids are swapped
+    int n_tile_rows, n_tile_cols; // number of tiles down and across the board
+    uint8_t *dirty; // flag for each tile, set if any of its cells changed in the last generation
+    uint8_t *active; // flag for each tile, set if it is recalculated in the current generation
+    long long *tile_alive; // number of living cells in each tile (excluding fixed boundaries)
+    uint64_t *tile_hash, *tile_shape; // parts of hash and shape from each tile (excluding fixed boundaries)
+    uint64_t hash; // hash of the cells after the last generation (see update_board), 0 unless hash_cells is set
+    uint64_t shape; // hash of the last generation unchanged by translation (see update_board)
+    int hash_cells; // 1 to work out hash and shape each generation (for a cycle detector)
+    int count_changes; // 1 to count births and deaths and keep the bounding box in counts (see update_board)
+    int n_active_tiles; // number of tiles recalculated in the last generation
+    uint8_t *tile_box; // bounding box of the living cells in each tile (first/last row, first/last column in the tile)
+    StepCounts counts; // births, deaths and bounding box of the last generation (see update_board)
+    int last_rules[5]; // fixed_bounds, game rules, hash_cells and count_changes of the last generation, all tiles
+                       // are dirty if these change
+}Board;
+
+// Access the cell at row i, column j of the board. Rows and columns -1, n_rows and n_cols are the ghost border.
+#define CELL(board, i, j) ((board)->cells[((size_t)(i)+1)*(board)->stride + (size_t)(j)+1])
+#define NEXT_CELL(board, i, j) ((board)->next[((size_t)(i)+1)*(board)->stride + (size_t)(j)+1]) // same cell in the next grid
+
+// Prototype function definitions (board.c)
+Board* create_board(int n_rows, int n_cols); // set up the board in a single allocation
+void fill_halo(Board *board, int fixed_bounds); // apply the boundary conditions to the ghost border
+void mark_board_dirty(Board *board); // recalculate every tile in the next generation (after editing cells directly)
+void add_living_cell(Board *board, int x, int y);
+void print_board(const Board *board);
+void free_board(Board *board); // free dynamic memory
+long long update_board(Board *board, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool);
+Board* load_board(const char *filename, int *fixed_bounds, int echo); // read a board and its header from file
+void write_board(const Board *board, int fixed_bounds, const char *filename);
+void save_board(const Board *board, int fixed_bounds); // ask the user, then write to CUSTOM_BOARD_FILE
+const char* bounds_name(int fixed_bounds); // torus, fixed, infinite, dead, reflect or klein
+int find_bounds(const char *name); // fixed_bounds value with that name, -1 if there is none
+
+#endif // CONWAY_H
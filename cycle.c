@@ -0,0 +1,238 @@
+/*
+* Detection of still lifes, oscillators and spaceships for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ The tables map each hash to the last generation it was seen at. Entries are never deleted one at a time: every
+ CYCLE_HISTORY generations both tables are emptied and refilled from the ring of recent hashes, so they never hold
+ more than 2*CYCLE_HISTORY entries and a lookup only probes a few slots.
+ A translation is found by lining up the first living cell of the snapshot with each living cell of the current board
+ in turn and checking whether every living cell of the snapshot lands on a living cell. With the same number of
+ living cells this means the boards are equal. Most wrong translations fail on the first few cells.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cycle.h"
+
+CycleDetector* create_cycle_detector(int n_rows, int n_cols, int translations){
+    /*
+    Create a detector for a board of n_rows*n_cols with no generations seen.
+    Inputs: n_rows, n_cols - size of the board
+            translations - 1 to also find patterns which repeat translated (only for toroidal boundaries)
+    - Error checks for memory
+    */
+    CycleDetector *cd = (CycleDetector *)malloc(sizeof(CycleDetector));
+    if (cd == NULL){
+        printf("[ERROR] Out of memory whilst creating the cycle detector\n");
+        exit(EXIT_FAILURE);
+    }
+    cd->n_rows = n_rows;
+    cd->n_cols = n_cols;
+    cd->translations = translations;
+    for (int k = 0; k < CYCLE_TABLE_SIZE; k++){
+        cd->hashes[k].generation = -1;
+        cd->shapes[k].generation = -1;
+    }
+    cd->first_generation = cd->last_generation = cd->rebuilt = -1;
+    cd->snapshot = translations ? create_bitboard(n_rows, n_cols) : NULL;
+    cd->current = translations ? create_bitboard(n_rows, n_cols) : NULL;
+    cd->snapshot_generation = -1;
+    cd->candidate_period = 0;
+    cd->found = 0;
+    cd->start = cd->period = cd->full_period = 0;
+    cd->shift_rows = cd->shift_cols = 0;
+    return cd;
+}
+
+void free_cycle_detector(CycleDetector *cd){
+    // Free the detector and its copies of the board
+    if (cd->snapshot != NULL){
+        free_bitboard(cd->snapshot);
+        free_bitboard(cd->current);
+    }
+    free(cd);
+}
+
+static CycleSlot* find_slot(CycleSlot *table, uint64_t key){
+    // Slot holding key, or the empty slot where it would go
+    size_t k = (size_t)(key >> 32) & (CYCLE_TABLE_SIZE - 1);
+    while (table[k].generation != -1 && table[k].key != key){
+        k = (k + 1) & (CYCLE_TABLE_SIZE - 1);
+    }
+    return &table[k];
+}
+
+static void rebuild_tables(CycleDetector *cd, long long generation){
+    // Empty the tables and refill them with the generations in the ring (before this one)
+    for (int k = 0; k < CYCLE_TABLE_SIZE; k++){
+        cd->hashes[k].generation = -1;
+        cd->shapes[k].generation = -1;
+    }
+    long long oldest = generation - CYCLE_HISTORY + 1;
+    if (oldest < cd->first_generation){
+        oldest = cd->first_generation;
+    }
+    for (long long g = oldest; g < generation; g++){
+        CycleSlot *slot = find_slot(cd->hashes, cd->recent_hash[g % CYCLE_HISTORY]);
+        slot->key = cd->recent_hash[g % CYCLE_HISTORY];
+        slot->generation = g;
+        slot = find_slot(cd->shapes, cd->recent_shape[g % CYCLE_HISTORY]);
+        slot->key = cd->recent_shape[g % CYCLE_HISTORY];
+        slot->generation = g;
+    }
+    cd->rebuilt = generation;
+}
+
+static int find_translation(const BitBoard *a, const BitBoard *b, int *shift_rows, int *shift_cols){
+    /*
+    Find a translation (toroidal) taking board a onto board b. Return 1 if found, 0 if the boards are not translations
+    of each other (or have too many living cells to compare).
+    */
+    long long n_alive = count_bitboard(a);
+    if (n_alive == 0 || n_alive != count_bitboard(b) || n_alive > CYCLE_MAX_TRANSLATE){
+        return 0;
+    }
+    int n_rows = a->n_rows, n_cols = a->n_cols;
+    int *alive_rows = (int *)malloc((size_t)n_alive * 2 * sizeof(int)); // coords of the living cells of a
+    if (alive_rows == NULL){
+        printf("[ERROR] Out of memory whilst comparing boards\n");
+        exit(EXIT_FAILURE);
+    }
+    int *alive_cols = alive_rows + n_alive;
+    long long n = 0;
+    for (int i = 0; i < n_rows; i++){
+        for (int w = 0; w < a->n_words; w++){
+            for (uint64_t word = a->cells[(size_t)i*a->n_words + w]; word != 0; word &= word - 1){
+                alive_rows[n] = i;
+                alive_cols[n++] = w*BITS_PER_WORD + __builtin_ctzll(word);
+            }
+        }
+    }
+
+    int found = 0;
+    for (int i = 0; i < n_rows && !found; i++){ // line the first living cell of a up with each living cell of b
+        for (int w = 0; w < b->n_words && !found; w++){
+            for (uint64_t word = b->cells[(size_t)i*b->n_words + w]; word != 0 && !found; word &= word - 1){
+                int dy = (i - alive_rows[0] + n_rows) % n_rows;
+                int dx = (w*BITS_PER_WORD + __builtin_ctzll(word) - alive_cols[0] + n_cols) % n_cols;
+                long long k = 1;
+                while (k < n_alive && get_bitboard_cell(b, (alive_rows[k] + dy) % n_rows, (alive_cols[k] + dx) % n_cols)){
+                    k++;
+                }
+                if (k == n_alive){
+                    *shift_rows = dy;
+                    *shift_cols = dx;
+                    found = 1;
+                }
+            }
+        }
+    }
+    free(alive_rows);
+    return found;
+}
+
+static long long gcd(long long a, long long b){
+    // Greatest common divisor
+    while (b != 0){
+        long long r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static void cycle_found(CycleDetector *cd, long long start, long long period, int shift_rows, int shift_cols){
+    // Record a cycle, with the number of periods before the translations add up to a whole turn of the torus
+    cd->found = 1;
+    cd->start = start;
+    cd->period = period;
+    cd->shift_rows = shift_rows;
+    cd->shift_cols = shift_cols;
+    long long turns_rows = cd->n_rows / gcd(cd->n_rows, shift_rows); // periods to come back to the same row
+    long long turns_cols = cd->n_cols / gcd(cd->n_cols, shift_cols);
+    cd->full_period = period * (turns_rows / gcd(turns_rows, turns_cols) * turns_cols);
+}
+
+int observe_generation(CycleDetector *cd, long long generation, uint64_t hash, uint64_t shape,
+                       BoardCopy copy, const void *board){
+    /*
+    Add a generation to the history and look for a cycle. Return 1 if a cycle has been found (now or before).
+    Inputs: cd - detector (declared by create_cycle_detector)
+            generation - generation number, one more than the last one seen
+            hash, shape - hashes left by update_board or step_bitboard for this generation
+            copy, board - function copying the board into a BitBoard and the board, only called when checking a
+                          translation
+    - A repeated hash is a cycle starting at the generation it was first seen
+    - A repeated shape starts a check: the board is copied now and compared with the board after each multiple of
+      the period between the shapes (the shapes may repeat more often than the board, as with a glider whose
+      phases have the same cells and neighbours flipped)
+    */
+    if (cd->found){
+        return 1;
+    }
+    if (cd->first_generation < 0){
+        cd->first_generation = cd->rebuilt = generation;
+    }
+    cd->last_generation = generation;
+
+    CycleSlot *slot = find_slot(cd->hashes, hash);
+    if (slot->generation >= 0){ // same board as before
+        cycle_found(cd, slot->generation, generation - slot->generation, 0, 0);
+        return 1;
+    }
+    slot->key = hash;
+    slot->generation = generation;
+
+    if (cd->translations){
+        long long since = generation - cd->snapshot_generation;
+        if (cd->snapshot_generation >= 0 && since % cd->candidate_period == 0){
+            int shift_rows, shift_cols;
+            copy(board, cd->current);
+            if (find_translation(cd->snapshot, cd->current, &shift_rows, &shift_cols)){
+                cycle_found(cd, cd->snapshot_generation, since, shift_rows, shift_cols);
+                return 1;
+            }
+            if (since + cd->candidate_period > CYCLE_HISTORY){
+                cd->snapshot_generation = -1; // give up, wait for the next repeated shape
+            }
+        }
+        slot = find_slot(cd->shapes, shape);
+        if (slot->generation >= 0 && cd->snapshot_generation < 0){
+            cd->candidate_period = generation - slot->generation;
+            cd->snapshot_generation = generation;
+            copy(board, cd->snapshot);
+        }
+        slot->key = shape;
+        slot->generation = generation;
+    }
+
+    cd->recent_hash[generation % CYCLE_HISTORY] = hash;
+    cd->recent_shape[generation % CYCLE_HISTORY] = shape;
+    if (generation + 1 - cd->rebuilt >= CYCLE_HISTORY){
+        rebuild_tables(cd, generation + 1);
+    }
+    return 0;
+}
+
+long long cycle_skip(const CycleDetector *cd, long long remaining){
+    // Generations that can be skipped out of the remaining ones without changing the final board (whole periods)
+    if (!cd->found){
+        return 0;
+    }
+    return remaining - remaining % cd->full_period;
+}
+
+void copy_board(const void *board, BitBoard *bb){
+    // BoardCopy for a Board of Cells
+    cells_to_bitboard((const Board *)board, bb);
+}
+
+void copy_bitboard(const void *board, BitBoard *bb){
+    // BoardCopy for a BitBoard
+    const BitBoard *src = (const BitBoard *)board;
+    memcpy(bb->cells, src->cells, (size_t)src->n_rows * src->n_words * sizeof(uint64_t));
+}
@@ -0,0 +1,78 @@
+/*
+* Detection of still lifes, oscillators and spaceships for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: update_board and step_bitboard leave two 64 bit hashes of each generation:
+                - hash: depends on which cells are alive, so two generations with the same hash are the same board
+                - shape: unchanged when the whole pattern is translated across a toroidal board
+              A CycleDetector remembers the hashes of the last CYCLE_HISTORY generations. A repeated hash means the
+              board has entered a cycle (a still life has period 1). A repeated shape is only a candidate: a copy
+              of the board is kept and compared for every translation with the board after each multiple of the
+              period the shape repeated with, so gliders and spaceships on a torus are found without trusting the
+              weaker shape hash.
+              Once a cycle is known, whole periods of it can be skipped, so a long run only steps the generations
+              left over at the end.
+ */
+
+#ifndef CYCLE_H
+#define CYCLE_H
+
+#include <stdint.h>
+
+#include "bitboard.h"
+
+#define CYCLE_HISTORY 1024 // generations remembered, the longest period found
+#define CYCLE_TABLE_SIZE (4*CYCLE_HISTORY) // slots in each hash table (power of 2), at most half full
+#define CYCLE_MAX_TRANSLATE 65536 // most living cells compared for a translation
+#define HASH_SEED 0x243F6A8885A308D3ULL // added to the position keys of hash
+#define SHAPE_SEED 0x13198A2E03707344ULL // added to the keys of shape
+#define HASH_STEP 0x9E3779B97F4A7C15ULL // step between the keys of neighbouring words of a BitBoard row
+#define HASH_MULT 0xBF58476D1CE4E5B9ULL // odd multiplier mixing each word of a BitBoard row
+
+// Mix the bits of x, so that nearby positions or states get unrelated keys (splitmix64 finaliser)
+static inline uint64_t mix_hash(uint64_t x){
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Copy the current generation of a board (Board or BitBoard) into a bit-packed board of the same size
+typedef void (*BoardCopy)(const void *board, BitBoard *bb);
+
+// Define a structure with alias 'CycleSlot' for a hash seen and the last generation it was seen at
+typedef struct cycle_slot{
+    uint64_t key;
+    long long generation; // -1 for an empty slot
+}CycleSlot;
+
+// Define a structure with alias 'CycleDetector' for the hashes of the recent generations and any cycle found
+typedef struct cycle_detector{
+    int n_rows, n_cols;
+    int translations; // 1 to also look for the board repeating translated (toroidal boards only)
+    CycleSlot hashes[CYCLE_TABLE_SIZE]; // open-addressing tables, linear probing, emptied every CYCLE_HISTORY generations
+    CycleSlot shapes[CYCLE_TABLE_SIZE];
+    uint64_t recent_hash[CYCLE_HISTORY], recent_shape[CYCLE_HISTORY]; // ring of the last generations' hashes
+    long long first_generation, last_generation; // generations seen so far
+    long long rebuilt; // generation the tables were last emptied and refilled from the ring
+    BitBoard *snapshot, *current; // copies compared when checking for a translation
+    long long snapshot_generation, candidate_period; // snapshot_generation is -1 when not checking
+    // Cycle found
+    int found;
+    long long start; // first generation known to be in the cycle
+    long long period; // generations before the board repeats
+    int shift_rows, shift_cols; // translation of the board each period
+    long long full_period; // generations before the board repeats in the same place
+}CycleDetector;
+
+// Prototype function definitions
+CycleDetector* create_cycle_detector(int n_rows, int n_cols, int translations);
+void free_cycle_detector(CycleDetector *cd);
+int observe_generation(CycleDetector *cd, long long generation, uint64_t hash, uint64_t shape,
+                       BoardCopy copy, const void *board); // 1 once a cycle has been found
+long long cycle_skip(const CycleDetector *cd, long long remaining); // whole periods in remaining generations
+void copy_board(const void *board, BitBoard *bb); // BoardCopy for a Board of Cells
+void copy_bitboard(const void *board, BitBoard *bb); // BoardCopy for a BitBoard
+
+#endif // CYCLE_H
@@ -0,0 +1,96 @@
+/*
+* Stepping engines for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: One interface to every engine that can step a board, so the headless runner and the benchmark drive
+              any of them the same way and the engine is picked at runtime by name:
+                - board: board of Cells (update_board), the reference the others are checked against
+                - bitboard: bit-packed board (step_bitboard)
+                - sparse: unbounded plane of chunks (step_sparse)
+                - hashlife: unbounded quadtree (advance_hashlife)
+                - generations: nibble-packed board for multi-state rules (step_gen_board)
+              Each engine fills in an EngineOps table: load a pattern or a bit-packed board, step n generations,
+              count the population, extract a window of cells, save and free. An Engine holds the table with the
+              engine's own board and the rule and boundary conditions it runs. Cells are in board coords for the
+              bounded engines, which always extract their whole board, and in plane coords for the unbounded ones.
+              compare_engines checks two engines hold the same cells, so a new backend can be run side by side
+              with the reference (see --cross-check in main.c).
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+
+#include "conway.h"
+#include "bitboard.h"
+#include "sparse.h"
+#include "pattern_io.h"
+#include "cycle.h"
+#include "thread_pool.h"
+
+// Engines, in the order of engine_name
+#define ENGINE_DEFAULT -1 // bitboard (generations for multi-state rules) for toroidal or fixed boards, sparse for the
+                          // unbounded plane, board for the other topologies
+#define ENGINE_BOARD 0 // board of Cells (update_board)
+#define ENGINE_BITBOARD 1 // bit-packed board (step_bitboard)
+#define ENGINE_SPARSE 2 // unbounded plane of chunks (step_sparse)
+#define ENGINE_HASHLIFE 3 // unbounded quadtree (advance_hashlife)
+#define ENGINE_GENERATIONS 4 // nibble-packed board for multi-state rules (step_gen_board)
+#define N_ENGINES 5
+
+// Define a structure with alias 'Engine' for an engine with its board, rule and boundary conditions
+typedef struct engine{
+    const struct engine_ops *ops; // functions of the engine
+    int id; // ENGINE_*
+    int fixed_bounds; // 0 toroidal, 1 fixed, INFINITE_BOUNDS or another topology (see fill_halo)
+    unsigned birth_mask, survive_mask; // the game rule (see parse_rule)
+    int n_states; // states of a Generations rule, 2 for a Life-like rule
+    long long n_rows, n_cols; // size of the board (for the unbounded engines the window the pattern was read into)
+    long long row0, col0; // plane coords of the top left cell of the window (unbounded engines, 0 otherwise)
+    void *state; // Board, BitBoard, SparsePlane, HashLife or GenBoard
+    BitBoard *bits; // bit-packed copy of a board of Cells for checkpoints (NULL until needed)
+    int count_changes; // 1 to count births and deaths as well as the bounding box (see step_bitboard)
+    const StepCounts *counts; // births, deaths and bounding box of the last step, NULL if the engine does not count them
+    uint64_t hash, shape; // hashes of the last generation (see cycle.h), only set if copy is not NULL
+    BoardCopy copy; // copies state into a bit-packed board for the cycle detector, NULL if generations are not hashed
+    int hashes; // 1 if hash and shape are read (by a cycle detector), the board engine only works them out then
+    double n_stepped; // cells calculated by the last step (active tiles, the whole board or the chunks)
+    double cell_updates; // cells stepped over every step so far (the whole board, the chunks or the window)
+    int block; // generations advanced per pass over the board (temporal blocking, see step_bitboard_blocked), 1 for
+               // one at a time. Only set for an engine with ops->blocks
+}Engine;
+
+// Define a structure with alias 'EngineOps' for what an engine can do and the functions doing it
+typedef struct engine_ops{
+    const char *name;
+    int unbounded; // 1 for the unbounded plane, 0 for toroidal or fixed boundary conditions
+    int topologies; // 1 if it also runs the dead, reflective and Klein bottle borders (see fill_halo)
+    int multi_state; // 1 if it runs Generations rules with more than 2 states
+    int leaps; // 1 if stepping many generations at once is far faster than one at a time (HashLife)
+    int checkpoints; // 1 if it can be checkpointed and resumed
+    int blocks; // 1 if it can advance several generations per pass over the board (see Engine block)
+    void (*load)(Engine *engine, const char *path, PatternInfo *info); // pattern file, header already in info
+    void (*load_cells)(Engine *engine, BitBoard *bb, SparsePlane *plane); // takes over bb or plane (the other NULL)
+    long long (*step)(Engine *engine, long long n_generations, ThreadPool *pool); // returns the living cells
+    long long (*population)(const Engine *engine);
+    void (*extract)(const Engine *engine, BitBoard *bb, long long row0, long long col0); // window at (row0,col0)
+    void (*snapshot)(Engine *engine, const BitBoard **bb, const SparsePlane **plane); // cells to checkpoint (NULL if none)
+    void (*save)(const Engine *engine, const char *path); // pattern file, format from the extension
+    void (*free_state)(Engine *engine);
+}EngineOps;
+
+// Prototype function definitions
+const char* engine_name(int id);
+int find_engine(const char *name); // ENGINE_* with that name, -1 if there is none
+const EngineOps* engine_ops(int id);
+int default_engine(int fixed_bounds, int n_states);
+void check_engine(int id, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, int n_states, int checkpoints);
+Engine* create_engine(int id, const PatternInfo *window, int fixed_bounds, unsigned birth_mask, unsigned survive_mask,
+                      int n_states);
+void free_engine(Engine *engine);
+int compare_engines(const Engine *a, const Engine *b, long long *row, long long *col); // 1 if they hold the same cells
+
+#endif // ENGINE_H
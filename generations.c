@@ -0,0 +1,269 @@
+/*
+* Multi-state Generations board for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ For a word of 16 nibbles, alive_nibbles gives 1 in each nibble holding state 1 and 0 elsewhere. Adding this word to
+ copies of itself shifted one nibble west and east gives the living cells in each row of the 3x3 block around every
+ cell (at most 3), and adding the rows above and below gives the neighbour counts (at most 9 including the cell,
+ which is then taken off). No nibble ever reaches 16, so the additions never carry between cells.
+ The rule is applied with nibble masks (0xF where a condition holds, 0 elsewhere): dead cells are born, living cells
+ survive or start to decay into state 2, and decaying cells move up one state, back to 0 after the last one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "generations.h"
+#include "board_memory.h"
+
+#define NIBBLE_ONES 0x1111111111111111ULL // 1 in every nibble
+#define NIBBLE_LOW 0x7777777777777777ULL // low 3 bits of every nibble
+#define NIBBLE_HIGH 0x8888888888888888ULL // high bit of every nibble
+
+GenBoard* create_gen_board(int n_rows, int n_cols){
+    /*
+    Creates a n_rows*n_cols nibble-packed board with all cells dead.
+    - Error checks for memory overflow
+    - Return pointer to the empty board.
+    */
+    GenBoard *gb = (GenBoard *)malloc(sizeof(GenBoard));
+    if (gb == NULL){ // Error check for memory
+        printf("[ERROR] Out of memory whilst creating the Generations board\n");
+        exit(EXIT_FAILURE);
+    }
+
+    gb->n_rows = n_rows;
+    gb->n_cols = n_cols;
+    gb->n_words = (n_cols + CELLS_PER_GEN_WORD - 1) / CELLS_PER_GEN_WORD; // round up to whole words
+
+    gb->cells = alloc_board_rows(n_rows, gb->n_words); // all dead, each row cleared by the thread stepping it
+    gb->next = alloc_board_rows(n_rows, gb->n_words);
+    return gb;
+}
+
+void free_gen_board(GenBoard *gb){
+    // Free the dynamically allocated memory for the Generations board
+    free_board_rows(gb->cells, gb->n_rows, gb->n_words);
+    free_board_rows(gb->next, gb->n_rows, gb->n_words);
+    free(gb);
+}
+
+int get_gen_cell(const GenBoard *gb, int i, int j){
+    // Return the state of the cell at row i, column j
+    return (int)((gb->cells[(size_t)i*gb->n_words + j/CELLS_PER_GEN_WORD] >> (4*(j % CELLS_PER_GEN_WORD))) & 0xF);
+}
+
+void set_gen_cell(GenBoard *gb, int i, int j, int state){
+    // Set the state of the cell at row i, column j
+    uint64_t *word = &gb->cells[(size_t)i*gb->n_words + j/CELLS_PER_GEN_WORD];
+    int shift = 4*(j % CELLS_PER_GEN_WORD);
+    *word = (*word & ~(0xFULL << shift)) | ((uint64_t)(state & 0xF) << shift);
+}
+
+static inline uint64_t zero_nibbles(uint64_t x){
+    // 1 in each nibble of x which is 0, 0 in the others
+    return (~(((x & NIBBLE_LOW) + NIBBLE_LOW) | x) & NIBBLE_HIGH) >> 3;
+}
+
+static inline uint64_t alive_nibbles(uint64_t x){
+    // 1 in each nibble of x in state 1 (alive), 0 in the others
+    return zero_nibbles(x ^ NIBBLE_ONES);
+}
+
+static inline uint64_t in_counts(uint64_t counts, unsigned mask){
+    // 0xF in each nibble whose count has its bit set in the mask, 0 in the others
+    uint64_t match = 0;
+    #pragma GCC unroll 9
+    for (int n = 0; n <= 8; n++){
+        if ((mask >> n) & 1){
+            match |= zero_nibbles(counts ^ (NIBBLE_ONES * (uint64_t)n));
+        }
+    }
+    return match * 0xF;
+}
+
+GenBoard* gen_board_from_bitboard(const BitBoard *bb){
+    // Create a Generations board of the same size as a bit-packed board, its living cells in state 1
+    GenBoard *gb = create_gen_board(bb->n_rows, bb->n_cols);
+    for (int i = 0; i < bb->n_rows; i++){
+        const uint64_t *row = bb->cells + (size_t)i*bb->n_words;
+        uint64_t *out = gb->cells + (size_t)i*gb->n_words;
+        for (int w = 0; w < gb->n_words; w++){
+            uint64_t bits = (row[w / 4] >> (CELLS_PER_GEN_WORD * (w % 4))) & 0xFFFF; // 16 cells of the word
+            uint64_t word = 0;
+            for (int k = 0; k < CELLS_PER_GEN_WORD; k++){
+                word |= ((bits >> k) & 1) << (4*k);
+            }
+            out[w] = word;
+        }
+    }
+    return gb;
+}
+
+void gen_board_to_bitboard(const GenBoard *gb, BitBoard *bb){
+    // Copy the living cells (state 1) of a Generations board into a bit-packed board of the same size
+    for (int i = 0; i < gb->n_rows; i++){
+        const uint64_t *row = gb->cells + (size_t)i*gb->n_words;
+        uint64_t *out = bb->cells + (size_t)i*bb->n_words;
+        memset(out, 0, (size_t)bb->n_words * sizeof(uint64_t));
+        for (int w = 0; w < gb->n_words; w++){
+            uint64_t alive = alive_nibbles(row[w]);
+            uint64_t bits = 0;
+            for (int k = 0; k < CELLS_PER_GEN_WORD; k++){
+                bits |= ((alive >> (4*k)) & 1) << k;
+            }
+            out[w / 4] |= bits << (CELLS_PER_GEN_WORD * (w % 4));
+        }
+    }
+}
+
+long long count_gen_board(const GenBoard *gb){
+    // Return the number of living cells (state 1)
+    long long cells_alive = 0;
+    for (size_t k = 0; k < (size_t)gb->n_rows * gb->n_words; k++){
+        cells_alive += __builtin_popcountll(alive_nibbles(gb->cells[k]));
+    }
+    return cells_alive;
+}
+
+static void row_sums(const GenBoard *gb, int i, uint64_t *alive, uint64_t *sums){
+    /*
+    Find the living cells of row i (1 per nibble) and the number of living cells in each 1x3 block of the row
+    centred on every cell, wrapping toroidally at the ends of the row.
+    */
+    int last = gb->n_words - 1;
+    int last_nibble = (gb->n_cols - 1) % CELLS_PER_GEN_WORD; // nibble of the last column in the last word
+    const uint64_t *c = gb->cells + (size_t)i*gb->n_words;
+    for (int w = 0; w <= last; w++){
+        alive[w] = alive_nibbles(c[w]);
+    }
+    uint64_t first_cell = alive[0] & 1, last_cell = (alive[last] >> (4*last_nibble)) & 1;
+    for (int w = 0; w <= last; w++){
+        uint64_t west = (alive[w] << 4) | ((w > 0) ? alive[w-1] >> 60 : last_cell);
+        uint64_t east = (alive[w] >> 4) | ((w < last) ? alive[w+1] << 60 : first_cell << (4*last_nibble));
+        sums[w] = alive[w] + west + east;
+    }
+}
+
+// Shared by the stripes of step_gen_board
+typedef struct gen_task{
+    GenBoard *gb;
+    int fixed_bounds;
+    unsigned birth_mask, survive_mask;
+    int n_states;
+    long long *cells_alive; // living cells counted by each stripe
+}GenTask;
+
+static void gen_stripe(void *arg, int stripe, int n_stripes){
+    /*
+    Calculate one horizontal stripe of the next generation.
+    - The row sums of the rows above, in and below the current row are kept in a ring of three buffers, so each
+      row is summed once (the rows either side of the stripe are summed by both stripes)
+    */
+    GenTask *task = (GenTask *)arg;
+    GenBoard *gb = task->gb;
+    int n_words = gb->n_words, n_rows = gb->n_rows;
+    int row_begin, row_end;
+    stripe_range(n_rows, stripe, n_stripes, &row_begin, &row_end);
+    task->cells_alive[stripe] = 0;
+    if (row_begin >= row_end){
+        return;
+    }
+
+    uint64_t *buffer = (uint64_t *)malloc((size_t)6 * n_words * sizeof(uint64_t));
+    if (buffer == NULL){
+        printf("[ERROR] Out of memory whilst stepping the Generations board\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t *alive[3], *sums[3]; // rows above, current and below
+    for (int k = 0; k < 3; k++){
+        alive[k] = buffer + (size_t)(2*k)*n_words;
+        sums[k] = buffer + (size_t)(2*k + 1)*n_words;
+    }
+    row_sums(gb, (row_begin + n_rows - 1) % n_rows, alive[0], sums[0]);
+    row_sums(gb, row_begin, alive[1], sums[1]);
+
+    int last = n_words - 1;
+    int last_nibble = (gb->n_cols - 1) % CELLS_PER_GEN_WORD;
+    uint64_t last_mask = (last_nibble == CELLS_PER_GEN_WORD-1) ? ~0ULL : ((1ULL << (4*(last_nibble+1))) - 1);
+    uint64_t decay_start = (task->n_states > 2) ? 2*NIBBLE_ONES : 0; // state of a living cell which does not survive
+    uint64_t last_state = NIBBLE_ONES * (uint64_t)(task->n_states - 1);
+    long long cells_alive = 0;
+
+    for (int i = row_begin; i < row_end; i++){
+        row_sums(gb, (i + 1) % n_rows, alive[2], sums[2]);
+        const uint64_t *c = gb->cells + (size_t)i*n_words;
+        uint64_t *out = gb->next + (size_t)i*n_words;
+
+        if (task->fixed_bounds && (i == 0 || i == n_rows-1)){ // top and bottom rows are frozen
+            memcpy(out, c, n_words*sizeof(uint64_t));
+        }else{
+            for (int w = 0; w < n_words; w++){
+                uint64_t counts = sums[0][w] + (sums[1][w] - alive[1][w]) + sums[2][w]; // 8 neighbours, at most 8
+                uint64_t is_alive = alive[1][w] * 0xF, is_dead = zero_nibbles(c[w]) * 0xF;
+                uint64_t survives = is_alive & in_counts(counts, task->survive_mask);
+                uint64_t born = is_dead & in_counts(counts, task->birth_mask);
+                uint64_t decaying = ~(is_alive | is_dead) & ~(zero_nibbles(c[w] ^ last_state) * 0xF); // move up a state
+                out[w] = (NIBBLE_ONES & (born | survives)) | (decay_start & is_alive & ~survives)
+                       | ((c[w] & decaying) + (NIBBLE_ONES & decaying));
+            }
+            out[last] &= last_mask; // keep padding nibbles dead
+            if (task->fixed_bounds){ // first and last columns are frozen
+                uint64_t end_nibble = 0xFULL << (4*last_nibble);
+                out[0] = (out[0] & ~0xFULL) | (c[0] & 0xFULL);
+                out[last] = (out[last] & ~end_nibble) | (c[last] & end_nibble);
+            }
+            for (int w = 0; w < n_words; w++){
+                cells_alive += __builtin_popcountll(alive_nibbles(out[w]));
+            }
+            if (task->fixed_bounds){ // frozen cells are not counted
+                cells_alive -= (long long)((alive_nibbles(out[0]) & 1) + ((alive_nibbles(out[last]) >> (4*last_nibble)) & 1));
+                if (gb->n_cols == 1){ // the same cell was subtracted twice
+                    cells_alive += (long long)(alive_nibbles(out[0]) & 1);
+                }
+            }
+        }
+
+        uint64_t *swap = alive[0]; // the row below becomes the current row
+        alive[0] = alive[1];
+        alive[1] = alive[2];
+        alive[2] = swap;
+        swap = sums[0];
+        sums[0] = sums[1];
+        sums[1] = sums[2];
+        sums[2] = swap;
+    }
+    free(buffer);
+    task->cells_alive[stripe] = cells_alive;
+}
+
+long long step_gen_board(GenBoard *gb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, int n_states,
+                         ThreadPool *pool){
+    /*
+    Advance the Generations board by one generation. Return the number of living cells (state 1) after the update.
+    Inputs: gb - Generations board (declared by create_gen_board)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries)
+            birth_mask, survive_mask - the rule (see parse_generations_rule), counting only neighbours in state 1
+            n_states - number of states including dead and alive (2 to GEN_MAX_STATES), 2 for a Life-like rule
+            pool - threads to split the board between in horizontal stripes (NULL for a single thread)
+    - With fixed boundaries the outer ring of cells is copied unchanged and not counted, as in update_board
+    */
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_alive[n_stripes];
+    GenTask task = {gb, fixed_bounds, birth_mask, survive_mask, n_states, stripe_alive};
+
+    run_thread_pool(pool, gen_stripe, &task);
+
+    long long cells_alive = 0;
+    for (int k = 0; k < n_stripes; k++){ // combine the counts of each stripe
+        cells_alive += stripe_alive[k];
+    }
+
+    uint64_t *swap = gb->cells; // the next generation becomes the current one
+    gb->cells = gb->next;
+    gb->next = swap;
+    return cells_alive;
+}
@@ -0,0 +1,47 @@
+/*
+* Multi-state Generations board for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Board for the Generations family of rules (Brian's Brain B2/S/C3, Star Wars B2/S345/C4, ...), where a
+              living cell which does not survive decays through states 2 to n_states-1 before it is dead again.
+              Only cells in state 1 count as neighbours and decaying cells cannot be born into.
+              Each cell is a 4 bit nibble, 16 cells in each uint64_t word (cell j of a row is nibble j % 16 of word
+              j / 16), so any rule of up to GEN_MAX_STATES states takes half a byte per cell. The step works on all 16
+              nibbles of a word at once (SIMD within a register): neighbour counts of 0 to 8 are added nibble by
+              nibble without carrying into the next one, and the rule is applied by comparing whole words of
+              nibbles, so the row loops have no branches and are vectorised by the compiler.
+ */
+
+#ifndef GENERATIONS_H
+#define GENERATIONS_H
+
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "thread_pool.h"
+
+#define GEN_MAX_STATES 16 // states held by a nibble
+#define CELLS_PER_GEN_WORD 16 // nibbles in each word
+
+// Define a structure with alias 'GenBoard' for a nibble-packed board with a buffer for the next generation
+typedef struct gen_board{
+    int n_rows, n_cols; // number of rows and columns of cells
+    int n_words; // number of uint64_t words in each row
+    uint64_t *cells; // current generation, n_rows*n_words words, padding nibbles always 0
+    uint64_t *next; // scratch buffer the next generation is written into before the buffers are swapped
+}GenBoard;
+
+// Prototype function definitions
+GenBoard* create_gen_board(int n_rows, int n_cols); // all cells dead (state 0) on creation
+void free_gen_board(GenBoard *gb);
+int get_gen_cell(const GenBoard *gb, int i, int j); // state 0 to GEN_MAX_STATES-1
+void set_gen_cell(GenBoard *gb, int i, int j, int state);
+GenBoard* gen_board_from_bitboard(const BitBoard *bb); // living cells in state 1
+void gen_board_to_bitboard(const GenBoard *gb, BitBoard *bb); // cells in state 1 alive, the rest dead
+long long count_gen_board(const GenBoard *gb); // number of cells in state 1
+long long step_gen_board(GenBoard *gb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, int n_states,
+                         ThreadPool *pool);
+
+#endif // GENERATIONS_H
@@ -0,0 +1,469 @@
+/*
+* HashLife engine for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ The centre of a level L node (a level L-1 square) only depends on the node itself for 2^(L-2) generations, since
+ no information travels faster than one cell per generation. advance() calculates it from nine overlapping level
+ L-1 sub-squares: each is advanced, the results are regrouped into four level L-1 squares and advanced again.
+ Advancing both times by 2^(L-3) gives 2^(L-2) generations, taking the centre of each sub-square the first time
+ instead gives any smaller power of two. Level 2 nodes (4x4 cells) are stepped one generation directly.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashlife.h"
+
+#define HL_BLOCK_NODES 4096 // nodes allocated at once
+#define HL_MIN_LEVEL 3 // smallest universe
+#define HL_MAX_LEVEL 62 // largest universe (coords must fit in a long long)
+
+typedef struct hl_block{ // block of nodes, chained so they can all be freed
+    struct hl_block *next;
+    HLNode nodes[HL_BLOCK_NODES];
+}HLBlock;
+
+static HLNode* empty_node(HashLife *hl, int level);
+
+static size_t hash_children(const HLNode *nw, const HLNode *ne, const HLNode *sw, const HLNode *se){
+    // Mix the addresses of the four children into a hash value
+    uint64_t h = (uintptr_t)nw;
+    h = (h ^ (h >> 29)) * 0x9E3779B97F4A7C15ULL + (uintptr_t)ne;
+    h = (h ^ (h >> 29)) * 0x9E3779B97F4A7C15ULL + (uintptr_t)sw;
+    h = (h ^ (h >> 29)) * 0x9E3779B97F4A7C15ULL + (uintptr_t)se;
+    return (size_t)(h ^ (h >> 32));
+}
+
+static void resize_table(HashLife *hl, size_t table_size){
+    // Move every node into a new hash table with table_size slots
+    HLNode **table = (HLNode **)calloc(table_size, sizeof(HLNode *));
+    if (table == NULL){
+        printf("[ERROR] Out of memory whilst growing the HashLife node table\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < hl->table_size; k++){
+        HLNode *node = hl->table[k];
+        while (node != NULL){
+            HLNode *next = node->hash_next;
+            size_t slot = hash_children(node->nw, node->ne, node->sw, node->se) & (table_size-1);
+            node->hash_next = table[slot];
+            table[slot] = node;
+            node = next;
+        }
+    }
+    free(hl->table);
+    hl->table = table;
+    hl->table_size = table_size;
+}
+
+static HLNode* alloc_node(HashLife *hl){
+    // Take a node from the free list, or from the newest block (allocating a new block when it is full)
+    if (hl->free_nodes != NULL){
+        HLNode *node = hl->free_nodes;
+        hl->free_nodes = node->hash_next;
+        return node;
+    }
+    if (hl->blocks == NULL || hl->block_used == HL_BLOCK_NODES){
+        HLBlock *block = (HLBlock *)malloc(sizeof(HLBlock));
+        if (block == NULL){
+            printf("[ERROR] Out of memory whilst creating HashLife nodes\n");
+            exit(EXIT_FAILURE);
+        }
+        block->next = (HLBlock *)hl->blocks;
+        hl->blocks = block;
+        hl->block_used = 0;
+    }
+    return &((HLBlock *)hl->blocks)->nodes[hl->block_used++];
+}
+
+static HLNode* find_node(HashLife *hl, HLNode *nw, HLNode *ne, HLNode *sw, HLNode *se){
+    /*
+    Return the canonical node with the given quadrants, creating it if it does not exist yet (hash-consing).
+    Inputs: nw, ne, sw, se - canonical nodes of the same level
+    */
+    size_t slot = hash_children(nw, ne, sw, se) & (hl->table_size-1);
+    for (HLNode *node = hl->table[slot]; node != NULL; node = node->hash_next){
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se){
+            return node;
+        }
+    }
+
+    HLNode *node = alloc_node(hl);
+    node->nw = nw; node->ne = ne; node->sw = sw; node->se = se;
+    node->result = NULL;
+    node->result_k = -1;
+    node->level = nw->level + 1;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->marked = 0;
+    node->hash_next = hl->table[slot];
+    hl->table[slot] = node;
+    hl->n_nodes++;
+
+    if (hl->n_nodes > hl->table_size){ // keep the chains short
+        resize_table(hl, hl->table_size * 2);
+    }
+    return node;
+}
+
+static HLNode* empty_node(HashLife *hl, int level){
+    // Return the node of the given level with no living cells
+    if (level == 0){
+        return &hl->leaves[DEAD];
+    }
+    if (hl->empty[level] == NULL){
+        HLNode *child = empty_node(hl, level-1);
+        hl->empty[level] = find_node(hl, child, child, child, child);
+    }
+    return hl->empty[level];
+}
+
+HashLife* create_hashlife(unsigned birth_mask, unsigned survive_mask, size_t max_memory){
+    /*
+    Create an empty HashLife universe.
+    Inputs: birth_mask, survive_mask - the game rule (see parse_rule), without B0 as empty space has to stay empty
+            max_memory - cap on the memory used by the nodes (bytes), 0 for HASHLIFE_DEFAULT_MEMORY
+    */
+    HashLife *hl = (HashLife *)calloc(1, sizeof(HashLife));
+    if (hl == NULL){
+        printf("[ERROR] Out of memory whilst creating the HashLife universe\n");
+        exit(EXIT_FAILURE);
+    }
+    if (max_memory == 0){
+        max_memory = HASHLIFE_DEFAULT_MEMORY;
+    }
+    hl->max_nodes = max_memory / (sizeof(HLNode) + sizeof(HLNode *)); // node and its share of the table
+    hl->table_size = 1024;
+    hl->table = (HLNode **)calloc(hl->table_size, sizeof(HLNode *));
+    if (hl->table == NULL){
+        printf("[ERROR] Out of memory whilst creating the HashLife universe\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int alive = DEAD; alive <= ALIVE; alive++){
+        hl->leaves[alive].level = 0;
+        hl->leaves[alive].population = alive;
+        hl->leaves[alive].result_k = -1;
+    }
+    hl->birth_mask = birth_mask;
+    hl->survive_mask = survive_mask;
+    hl->root = empty_node(hl, HL_MIN_LEVEL);
+    return hl;
+}
+
+void free_hashlife(HashLife *hl){
+    // Free the universe and all of its nodes
+    HLBlock *block = (HLBlock *)hl->blocks;
+    while (block != NULL){
+        HLBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(hl->table);
+    free(hl);
+}
+
+static HLNode* expand(HashLife *hl, HLNode *root){
+    // Return a node of the next level up with root in its centre and empty space around it
+    HLNode *border = empty_node(hl, root->level-1);
+    return find_node(hl, find_node(hl, border, border, border, root->nw),
+                         find_node(hl, border, border, root->ne, border),
+                         find_node(hl, border, root->sw, border, border),
+                         find_node(hl, root->se, border, border, border));
+}
+
+static HLNode* set_cell(HashLife *hl, HLNode *node, long long top, long long left, long long row, long long col, int alive){
+    // Return node (corner at (top, left)) with the cell at (row, col) set, rebuilding the path down to the cell
+    if (node->level == 0){
+        return &hl->leaves[alive == ALIVE];
+    }
+    long long mid = 1LL << (node->level-1);
+    HLNode *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (row < top + mid && col < left + mid){
+        nw = set_cell(hl, nw, top, left, row, col, alive);
+    }else if (row < top + mid){
+        ne = set_cell(hl, ne, top, left + mid, row, col, alive);
+    }else if (col < left + mid){
+        sw = set_cell(hl, sw, top + mid, left, row, col, alive);
+    }else{
+        se = set_cell(hl, se, top + mid, left + mid, row, col, alive);
+    }
+    return find_node(hl, nw, ne, sw, se);
+}
+
+void set_hashlife_cell(HashLife *hl, long long row, long long col, int alive){
+    /*
+    Set the state (ALIVE or DEAD) of the cell at (row, col), growing the universe if needed.
+    - Rows and columns may be negative, the universe is centred on the corner of cell (0, 0)
+    */
+    while (1){
+        long long half = 1LL << (hl->root->level-1);
+        if (row >= -half && row < half && col >= -half && col < half){
+            break;
+        }
+        if (hl->root->level >= HL_MAX_LEVEL){
+            printf("[ERROR] set_hashlife_cell - coords (%lld,%lld) outside the largest universe\n", row, col);
+            exit(EXIT_FAILURE);
+        }
+        hl->root = expand(hl, hl->root);
+    }
+    long long half = 1LL << (hl->root->level-1);
+    hl->root = set_cell(hl, hl->root, -half, -half, row, col, alive);
+}
+
+int get_hashlife_cell(const HashLife *hl, long long row, long long col){
+    // Return the state (ALIVE or DEAD) of the cell at (row, col)
+    const HLNode *node = hl->root;
+    long long half = 1LL << (node->level-1);
+    if (row < -half || row >= half || col < -half || col >= half){
+        return DEAD;
+    }
+    long long top = -half, left = -half; // corner of the current node
+    while (node->level > 0){
+        if (node->population == 0){
+            return DEAD;
+        }
+        long long mid = 1LL << (node->level-1);
+        int south = row >= top + mid, east = col >= left + mid;
+        node = south ? (east ? node->se : node->sw) : (east ? node->ne : node->nw);
+        top += south ? mid : 0;
+        left += east ? mid : 0;
+    }
+    return (int)node->population;
+}
+
+static HLNode* build_node(HashLife *hl, const BitBoard *bb, int level, long long top, long long left){
+    // Build the node of the given level whose corner is at (top, left) from the cells of a bit-packed board
+    long long size = 1LL << level;
+    if (top >= bb->n_rows || left >= bb->n_cols || top + size <= 0 || left + size <= 0){
+        return empty_node(hl, level); // outside the board
+    }
+    if (level == 0){
+        return &hl->leaves[get_bitboard_cell(bb, (int)top, (int)left)];
+    }
+    if (level == 6){ // 64 cells wide and aligned to a word, skip the square if all its words are empty
+        int any_alive = 0;
+        for (long long i = top; i < top + size && i < bb->n_rows; i++){
+            any_alive |= bb->cells[(size_t)i*bb->n_words + left/BITS_PER_WORD] != 0;
+        }
+        if (!any_alive){
+            return empty_node(hl, level);
+        }
+    }
+    long long half = size / 2;
+    return find_node(hl, build_node(hl, bb, level-1, top, left), build_node(hl, bb, level-1, top, left+half),
+                         build_node(hl, bb, level-1, top+half, left), build_node(hl, bb, level-1, top+half, left+half));
+}
+
+HashLife* hashlife_from_bitboard(const BitBoard *bb, unsigned birth_mask, unsigned survive_mask, size_t max_memory){
+    /*
+    Create a HashLife universe holding the cells of a bit-packed board, with cell (i, j) of the board at row i, column j.
+    Inputs: bb - bit-packed board (declared by create_bitboard)
+            birth_mask, survive_mask - the game rule (see create_hashlife)
+            max_memory - cap on the memory used by the nodes (bytes), 0 for HASHLIFE_DEFAULT_MEMORY
+    */
+    HashLife *hl = create_hashlife(birth_mask, survive_mask, max_memory);
+    int level = HL_MIN_LEVEL;
+    while ((1LL << (level-1)) < bb->n_rows || (1LL << (level-1)) < bb->n_cols){
+        level++;
+    }
+    // the board fills the south east quadrant of the universe, starting at its centre
+    HLNode *border = empty_node(hl, level-1);
+    hl->root = find_node(hl, border, border, border, build_node(hl, bb, level-1, 0, 0));
+    return hl;
+}
+
+static void extract_node(const HLNode *node, long long top, long long left, BitBoard *bb, long long row0, long long col0){
+    // Set the living cells of a node with corner (top, left) that fall within the board, which starts at (row0, col0)
+    long long size = 1LL << node->level;
+    if (node->population == 0 || top >= row0 + bb->n_rows || left >= col0 + bb->n_cols
+        || top + size <= row0 || left + size <= col0){
+        return; // nothing alive or outside the board
+    }
+    if (node->level == 0){
+        set_bitboard_cell(bb, (int)(top - row0), (int)(left - col0), ALIVE);
+        return;
+    }
+    long long half = size / 2;
+    extract_node(node->nw, top, left, bb, row0, col0);
+    extract_node(node->ne, top, left+half, bb, row0, col0);
+    extract_node(node->sw, top+half, left, bb, row0, col0);
+    extract_node(node->se, top+half, left+half, bb, row0, col0);
+}
+
+void hashlife_to_bitboard(const HashLife *hl, BitBoard *bb, long long row0, long long col0){
+    /*
+    Copy a region of the universe into a bit-packed board.
+    Inputs: bb - bit-packed board to fill, its size sets the size of the region
+            row0, col0 - coords in the universe of the top left cell of the region
+    */
+    memset(bb->cells, 0, (size_t)bb->n_rows * bb->n_words * sizeof(uint64_t));
+    long long half = 1LL << (hl->root->level-1);
+    extract_node(hl->root, -half, -half, bb, row0, col0);
+}
+
+uint64_t hashlife_population(const HashLife *hl){
+    // Return the number of living cells in the universe
+    return hl->root->population;
+}
+
+static HLNode* step_level2(HashLife *hl, HLNode *node){
+    // Return the centre 2x2 cells of a 4x4 node after one generation
+    int cells[4][4]; // states of the 16 cells
+    HLNode *quads[4] = {node->nw, node->ne, node->sw, node->se};
+    for (int q = 0; q < 4; q++){
+        int r0 = (q / 2) * 2, c0 = (q % 2) * 2; // corner of the quadrant
+        cells[r0][c0] = (int)quads[q]->nw->population;
+        cells[r0][c0+1] = (int)quads[q]->ne->population;
+        cells[r0+1][c0] = (int)quads[q]->sw->population;
+        cells[r0+1][c0+1] = (int)quads[q]->se->population;
+    }
+    HLNode *centre[4];
+    for (int k = 0; k < 4; k++){
+        int i = 1 + k / 2, j = 1 + k % 2; // centre cell
+        int n_alive_neighbrs = 0;
+        for (int di = -1; di <= 1; di++){
+            for (int dj = -1; dj <= 1; dj++){
+                n_alive_neighbrs += (di != 0 || dj != 0) ? cells[i+di][j+dj] : 0;
+            }
+        }
+        unsigned mask = cells[i][j] ? hl->survive_mask : hl->birth_mask;
+        centre[k] = &hl->leaves[(mask >> n_alive_neighbrs) & 1];
+    }
+    return find_node(hl, centre[0], centre[1], centre[2], centre[3]);
+}
+
+static HLNode* centre_node(HashLife *hl, HLNode *n){
+    // Return the level L-1 square in the centre of a level L node
+    return find_node(hl, n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+static HLNode* centre_horizontal(HashLife *hl, HLNode *w, HLNode *e){
+    // Return the level L square centred on the boundary between two side by side level L nodes
+    return find_node(hl, w->ne, e->nw, w->se, e->sw);
+}
+
+static HLNode* centre_vertical(HashLife *hl, HLNode *n, HLNode *s){
+    // Return the level L square centred on the boundary between two stacked level L nodes
+    return find_node(hl, n->sw, n->se, s->nw, s->ne);
+}
+
+static HLNode* advance(HashLife *hl, HLNode *node, int k){
+    /*
+    Return the centre of a node (level L >= 2) advanced by 2^k generations, where k <= L-2. The result is memoised.
+    */
+    int level = node->level;
+    if (node->population == 0){
+        return empty_node(hl, level-1);
+    }
+    if (node->result != NULL && node->result_k == k){
+        return node->result;
+    }
+
+    HLNode *result;
+    if (level == 2){
+        result = step_level2(hl, node);
+    }else{
+        // nine overlapping level L-1 squares covering the node
+        HLNode *sub[9] = {
+            node->nw, centre_horizontal(hl, node->nw, node->ne), node->ne,
+            centre_vertical(hl, node->nw, node->sw), centre_node(hl, node), centre_vertical(hl, node->ne, node->se),
+            node->sw, centre_horizontal(hl, node->sw, node->se), node->se
+        };
+        HLNode *part[9]; // level L-2 squares, advanced by 2^(L-3) or not at all
+        for (int s = 0; s < 9; s++){
+            part[s] = (k == level-2) ? advance(hl, sub[s], level-3) : centre_node(hl, sub[s]);
+        }
+        int step = (k == level-2) ? level-3 : k; // remaining generations for the second round
+        result = find_node(hl,
+            advance(hl, find_node(hl, part[0], part[1], part[3], part[4]), step),
+            advance(hl, find_node(hl, part[1], part[2], part[4], part[5]), step),
+            advance(hl, find_node(hl, part[3], part[4], part[6], part[7]), step),
+            advance(hl, find_node(hl, part[4], part[5], part[7], part[8]), step));
+    }
+    node->result = result;
+    node->result_k = (int8_t)k;
+    return result;
+}
+
+static void mark_node(HLNode *node, int keep_results){
+    // Mark a node and everything reachable from it as in use
+    if (node == NULL || node->level == 0 || node->marked){
+        return;
+    }
+    node->marked = 1;
+    mark_node(node->nw, keep_results);
+    mark_node(node->ne, keep_results);
+    mark_node(node->sw, keep_results);
+    mark_node(node->se, keep_results);
+    if (keep_results){
+        mark_node(node->result, keep_results);
+    }else{
+        node->result = NULL;
+        node->result_k = -1;
+    }
+}
+
+void collect_hashlife(HashLife *hl, int keep_results){
+    /*
+    Garbage collect the nodes that can no longer be reached from the universe.
+    Inputs: keep_results - 1 to keep the memoised results of the live nodes (and the nodes they use),
+                           0 to drop them so only the current universe is kept
+    */
+    mark_node(hl->root, keep_results);
+    for (int level = 1; level < 64; level++){
+        mark_node(hl->empty[level], keep_results);
+    }
+    for (size_t slot = 0; slot < hl->table_size; slot++){
+        HLNode **link = &hl->table[slot];
+        while (*link != NULL){
+            HLNode *node = *link;
+            if (node->marked){
+                node->marked = 0;
+                link = &node->hash_next;
+            }else{ // unreachable, move to the free list
+                *link = node->hash_next;
+                node->hash_next = hl->free_nodes;
+                hl->free_nodes = node;
+                hl->n_nodes--;
+            }
+        }
+    }
+    hl->n_collections++;
+}
+
+void step_hashlife(HashLife *hl, int k){
+    /*
+    Advance the universe by 2^k generations in one call.
+    - Garbage collects first if the node store is over its memory cap
+    - Grows the universe until the pattern sits in its central quarter with room to spread for 2^k generations,
+      then replaces it with its advanced centre
+    */
+    if (hl->n_nodes > hl->max_nodes){
+        collect_hashlife(hl, 1);
+        if (hl->n_nodes > hl->max_nodes / 2){ // results are taking too much memory, keep only the universe
+            collect_hashlife(hl, 0);
+        }
+    }
+
+    while (hl->root->level < k+3 || hl->root->level < HL_MIN_LEVEL+1
+           || centre_node(hl, centre_node(hl, hl->root))->population != hl->root->population){
+        if (hl->root->level >= HL_MAX_LEVEL){
+            printf("[ERROR] step_hashlife - pattern has outgrown the largest universe\n");
+            exit(EXIT_FAILURE);
+        }
+        hl->root = expand(hl, hl->root);
+    }
+    hl->root = advance(hl, hl->root, k);
+    hl->n_generations += 1ULL << k;
+}
+
+void advance_hashlife(HashLife *hl, unsigned long long n_generations){
+    // Advance the universe any number of generations, one step_hashlife for each set bit of n_generations
+    for (int k = 0; k < 64 && (n_generations >> k) != 0; k++){
+        if ((n_generations >> k) & 1){
+            step_hashlife(hl, k);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+* HashLife engine for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: The universe is a quadtree. A node of level L is a square of 2^L x 2^L cells made of four level L-1
+              children, down to the two level 0 leaves (dead and alive). Nodes are hash-consed: identical squares
+              anywhere in the universe, at any time, are the same node, so repeated structure is stored and
+              stepped once. Each node memoises its centre advanced by 2^k generations, which lets the whole
+              universe jump 2^k generations in one call.
+              The universe is the unbounded plane (it grows as the pattern does), so the boards' toroidal and
+              fixed boundary conditions do not apply.
+              Nodes live in a hash table capped at a configurable amount of memory. When the cap is reached the
+              unreachable nodes are garbage collected between steps, first keeping the memoised results of the
+              live nodes and, if that is not enough, dropping them too.
+ */
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+
+#define HASHLIFE_DEFAULT_MEMORY ((size_t)1 << 30) // default cap on the node store (bytes)
+
+// Define a structure with alias 'HLNode' for a square of 2^level x 2^level cells
+typedef struct hl_node{
+    struct hl_node *nw, *ne, *sw, *se; // quadrants (NULL for the leaves)
+    struct hl_node *result; // centre of the node advanced 2^result_k generations (NULL until calculated)
+    struct hl_node *hash_next; // next node in the same hash table slot
+    uint64_t population; // number of living cells
+    int8_t level;
+    int8_t result_k;
+    uint8_t marked; // reachable flag used by the garbage collector
+}HLNode;
+
+// Define a structure with alias 'HashLife' for the universe and its node store
+typedef struct hashlife{
+    HLNode **table; // hash table of all nodes of level 1 and above
+    size_t table_size; // number of slots (power of 2)
+    size_t n_nodes; // nodes in the table
+    size_t max_nodes; // garbage collect when the table grows past this many nodes
+    HLNode *free_nodes; // nodes freed by the garbage collector, reused before allocating
+    void *blocks; // blocks of nodes allocated so far (freed with the universe)
+    int block_used; // nodes handed out from the newest block
+    HLNode leaves[2]; // level 0 nodes for a DEAD and an ALIVE cell
+    HLNode *empty[64]; // cached empty node of each level
+    HLNode *root; // universe, the cell at row 0, column 0 is just below and right of its centre
+    unsigned birth_mask, survive_mask; // game rules (see parse_rule)
+    unsigned long long n_generations; // generations elapsed
+    int n_collections; // garbage collections run so far
+}HashLife;
+
+// Prototype function definitions
+HashLife* create_hashlife(unsigned birth_mask, unsigned survive_mask, size_t max_memory);
+void free_hashlife(HashLife *hl);
+void set_hashlife_cell(HashLife *hl, long long row, long long col, int alive);
+int get_hashlife_cell(const HashLife *hl, long long row, long long col);
+HashLife* hashlife_from_bitboard(const BitBoard *bb, unsigned birth_mask, unsigned survive_mask, size_t max_memory);
+void hashlife_to_bitboard(const HashLife *hl, BitBoard *bb, long long row0, long long col0);
+uint64_t hashlife_population(const HashLife *hl);
+void step_hashlife(HashLife *hl, int k); // advance 2^k generations
+void advance_hashlife(HashLife *hl, unsigned long long n_generations); // any number of generations
+void collect_hashlife(HashLife *hl, int keep_results); // garbage collect unreachable nodes
+
+#endif // HASHLIFE_H
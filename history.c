@@ -0,0 +1,245 @@
+/*
+* History of past generations for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ A change list is found by XORing each word of the new generation with the last one and writing out the set bits,
+ so recording a generation costs one pass over the bit-packed board. Each change is stored as the position of its
+ bit in the bit-packed board, which replaying turns straight back into a word and a bit with no division.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+
+static size_t segment_bytes(const History *history, const HistorySegment *segment){
+    // Memory held by a segment
+    return (size_t)history->n_rows*history->n_words*sizeof(uint64_t) + history->keyframe_every*sizeof(size_t)
+           + segment->capacity*sizeof(uint32_t);
+}
+
+static void free_segment(History *history, HistorySegment *segment){
+    // Free a segment and take it off the memory held
+    history->n_bytes -= segment_bytes(history, segment);
+    free(segment->keyframe);
+    free(segment->ends);
+    free(segment->changes);
+}
+
+static void forget_oldest(History *history){
+    // Forget the oldest segments until the history fits in max_bytes, always keeping the newest one
+    while (history->n_bytes > history->max_bytes && history->n_segments > 1){
+        free_segment(history, &history->segments[history->first]);
+        history->first++;
+        history->n_segments--;
+    }
+}
+
+static void add_keyframe(History *history, long long generation){
+    // Start a new segment with the generation in history->current as its keyframe
+    if (history->first + history->n_segments == history->max_segments){ // no free slot at the end
+        if (history->first > 0){
+            memmove(history->segments, history->segments + history->first, history->n_segments*sizeof(HistorySegment));
+            history->first = 0;
+        }else{
+            history->max_segments *= 2;
+            history->segments = (HistorySegment *)realloc(history->segments,
+                                                          history->max_segments*sizeof(HistorySegment));
+            if (history->segments == NULL){
+                printf("[ERROR] Out of memory whilst recording the history\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    HistorySegment *segment = &history->segments[history->first + history->n_segments];
+    size_t n_total = (size_t)history->n_rows*history->n_words;
+    segment->generation = generation;
+    segment->n_steps = 0;
+    segment->n_changes = segment->capacity = 0;
+    segment->changes = NULL;
+    segment->keyframe = (uint64_t *)malloc(n_total*sizeof(uint64_t));
+    segment->ends = (size_t *)malloc(history->keyframe_every*sizeof(size_t));
+    if (segment->keyframe == NULL || segment->ends == NULL){
+        printf("[ERROR] Out of memory whilst recording the history\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(segment->keyframe, history->current->cells, n_total*sizeof(uint64_t));
+    history->n_segments++;
+    history->n_bytes += segment_bytes(history, segment);
+    forget_oldest(history);
+}
+
+History* create_history(int n_rows, int n_cols, int keyframe_every, size_t max_bytes){
+    /*
+    Create an empty history for a board.
+    Inputs: n_rows, n_cols - size of the board
+            keyframe_every - generations between keyframes (at least 1)
+            max_bytes - memory the history may hold before the oldest generations are forgotten
+    - Error checks for memory and for a board too big to number its cells in 32 bits
+    */
+    History *history = (History *)malloc(sizeof(History));
+    if (history == NULL){
+        printf("[ERROR] Out of memory whilst creating the history\n");
+        exit(EXIT_FAILURE);
+    }
+    history->n_rows = n_rows;
+    history->n_cols = n_cols;
+    history->n_words = (n_cols + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    if ((uint64_t)n_rows*history->n_words*BITS_PER_WORD > (uint64_t)UINT32_MAX + 1){
+        printf("[ERROR]: A board of %dx%d cells is too big to keep a history of\n", n_rows, n_cols);
+        exit(EXIT_FAILURE);
+    }
+    history->keyframe_every = keyframe_every;
+    history->max_bytes = max_bytes;
+    history->n_bytes = 0;
+    history->first = history->n_segments = 0;
+    history->max_segments = 16;
+    history->segments = (HistorySegment *)malloc(history->max_segments*sizeof(HistorySegment));
+    if (history->segments == NULL){
+        printf("[ERROR] Out of memory whilst creating the history\n");
+        exit(EXIT_FAILURE);
+    }
+    history->last = create_bitboard(n_rows, n_cols);
+    history->current = create_bitboard(n_rows, n_cols);
+    history->newest = -1;
+    return history;
+}
+
+void free_history(History *history){
+    // Free every segment and the history itself
+    for (int s = 0; s < history->n_segments; s++){
+        free_segment(history, &history->segments[history->first + s]);
+    }
+    free(history->segments);
+    free_bitboard(history->last);
+    free_bitboard(history->current);
+    free(history);
+}
+
+void record_generation(History *history, long long generation, BoardCopy copy, const void *board){
+    /*
+    Add a generation to the history.
+    Inputs: history - history of the board (declared by create_history)
+            generation - generation the board is at, normally one after the newest recorded
+            copy - function copying the board into a bit-packed board (copy_board or copy_bitboard)
+            board - the board
+    - The generation is kept as a change list from the one before, unless that generation is not the one before,
+      the segment is full or more cells changed than a keyframe holds, when it becomes a new keyframe
+    */
+    copy(board, history->current);
+    size_t n_total = (size_t)history->n_rows*history->n_words;
+    const uint64_t *now = history->current->cells, *before = history->last->cells;
+    HistorySegment *segment = (history->n_segments > 0) ? &history->segments[history->first + history->n_segments - 1]
+                                                        : NULL;
+
+    int keyframe = (segment == NULL || generation != history->newest + 1
+                    || segment->n_steps == history->keyframe_every);
+    size_t n_changed = 0;
+    size_t max_changed = n_total*sizeof(uint64_t)/sizeof(uint32_t); // changes that fill as much as a keyframe
+    for (size_t k = 0; k < n_total && !keyframe; k++){
+        n_changed += __builtin_popcountll(now[k] ^ before[k]);
+        keyframe = (n_changed > max_changed);
+    }
+
+    if (keyframe){
+        add_keyframe(history, generation);
+    }else{
+        if (segment->n_changes + n_changed > segment->capacity){
+            size_t capacity = (segment->capacity > 0) ? 2*segment->capacity : 1024;
+            while (capacity < segment->n_changes + n_changed){
+                capacity *= 2;
+            }
+            segment->changes = (uint32_t *)realloc(segment->changes, capacity*sizeof(uint32_t));
+            if (segment->changes == NULL){
+                printf("[ERROR] Out of memory whilst recording the history\n");
+                exit(EXIT_FAILURE);
+            }
+            history->n_bytes += (capacity - segment->capacity)*sizeof(uint32_t);
+            segment->capacity = capacity;
+        }
+        uint32_t *changes = segment->changes + segment->n_changes;
+        for (size_t k = 0; k < n_total; k++){
+            uint64_t flips = now[k] ^ before[k];
+            while (flips != 0){ // one change per set bit, lowest first
+                *changes++ = (uint32_t)(k*BITS_PER_WORD + __builtin_ctzll(flips));
+                flips &= flips - 1;
+            }
+        }
+        segment->n_changes += n_changed;
+        segment->ends[segment->n_steps++] = segment->n_changes;
+        forget_oldest(history);
+    }
+
+    BitBoard *swap = history->last; // the generation just copied becomes the newest
+    history->last = history->current;
+    history->current = swap;
+    history->newest = generation;
+}
+
+long long oldest_generation(const History *history){
+    // Return the oldest generation the history holds, -1 if nothing has been recorded
+    return (history->n_segments > 0) ? history->segments[history->first].generation : -1;
+}
+
+static const HistorySegment* find_segment(const History *history, long long generation){
+    // Return the segment holding a generation, NULL if it is not held (binary search on the keyframe generations)
+    if (generation < oldest_generation(history) || generation > history->newest){
+        return NULL;
+    }
+    int low = 0, high = history->n_segments - 1; // the segment is between low and high
+    while (low < high){
+        int mid = (low + high + 1) / 2;
+        if (history->segments[history->first + mid].generation <= generation){
+            low = mid;
+        }else{
+            high = mid - 1;
+        }
+    }
+    return &history->segments[history->first + low];
+}
+
+int seek_history(const History *history, long long generation, BitBoard *bb){
+    /*
+    Rebuild a past generation from the keyframe at or before it and the changes since. Return 1, or 0 if the
+    generation is not held (forgotten, or not run yet).
+    Inputs: history - history of the board (declared by create_history)
+            generation - generation to rebuild
+            bb - bit-packed board of the same size to write the generation into
+    */
+    const HistorySegment *segment = find_segment(history, generation);
+    if (segment == NULL){
+        return 0;
+    }
+    memcpy(bb->cells, segment->keyframe, (size_t)history->n_rows*history->n_words*sizeof(uint64_t));
+    int n_steps = (int)(generation - segment->generation);
+    size_t n_changes = (n_steps > 0) ? segment->ends[n_steps - 1] : 0;
+    for (size_t c = 0; c < n_changes; c++){
+        uint32_t bit = segment->changes[c];
+        bb->cells[bit / BITS_PER_WORD] ^= 1ULL << (bit % BITS_PER_WORD);
+    }
+    return 1;
+}
+
+int rewind_history(History *history, long long generation){
+    /*
+    Make a past generation the newest, forgetting every generation after it, so the board can be run on again
+    from there. Return 1, or 0 if the generation is not held.
+    Inputs: history - history of the board (declared by create_history)
+            generation - generation to go back to
+    */
+    if (!seek_history(history, generation, history->last)){
+        return 0;
+    }
+    while (history->segments[history->first + history->n_segments - 1].generation > generation){
+        free_segment(history, &history->segments[history->first + history->n_segments - 1]);
+        history->n_segments--;
+    }
+    HistorySegment *segment = &history->segments[history->first + history->n_segments - 1];
+    segment->n_steps = (int)(generation - segment->generation);
+    segment->n_changes = (segment->n_steps > 0) ? segment->ends[segment->n_steps - 1] : 0;
+    history->newest = generation;
+    return 1;
+}
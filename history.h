@@ -0,0 +1,62 @@
+/*
+* History of past generations for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Remembers the generations of a board so any recent one can be looked at again without running the
+              board from its start.
+                - A keyframe (bit-packed copy of the whole board) is kept every keyframe_every generations
+                - Every generation after a keyframe only keeps the list of cells that changed (births and deaths),
+                  which for most boards is far smaller than the board. A generation where more cells changed than
+                  a keyframe would hold starts a new keyframe instead
+                - A keyframe and the change lists after it make a segment. Once the history holds more than
+                  max_bytes the oldest segments are forgotten, the newest one is always kept
+              seek_history rebuilds a generation by copying the keyframe at or before it and replaying the change
+              lists up to it, so it costs at most keyframe_every change lists whatever the generation.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "cycle.h"
+
+#define HISTORY_KEYFRAME_EVERY 64 // Default generations between keyframes
+#define HISTORY_MEMORY_MB 64 // Default memory kept for the history (megabytes)
+
+// Define a structure with alias 'HistorySegment' for a keyframe and the changes of the generations after it
+typedef struct history_segment{
+    long long generation; // generation of the keyframe
+    uint64_t *keyframe; // n_rows*n_words words
+    int n_steps; // generations recorded after the keyframe
+    size_t *ends; // cells changed up to the end of each step, keyframe_every entries
+    uint32_t *changes; // bit i*n_words*BITS_PER_WORD + j of the keyframe for each cell that changed, step by step
+    size_t n_changes, capacity; // length and allocated length of changes
+}HistorySegment;
+
+// Define a structure with alias 'History' for the recent generations of a board
+typedef struct history{
+    int n_rows, n_cols, n_words;
+    int keyframe_every; // most generations in a segment
+    size_t max_bytes; // memory budget
+    size_t n_bytes; // memory held by the segments
+    HistorySegment *segments; // max_segments slots, the segments held are first to first+n_segments-1, oldest first
+    int first, n_segments, max_segments;
+    BitBoard *last; // newest generation recorded
+    BitBoard *current; // scratch copy of the generation being recorded
+    long long newest; // generation of last, -1 before the first record
+}History;
+
+// Prototype function definitions
+History* create_history(int n_rows, int n_cols, int keyframe_every, size_t max_bytes);
+void free_history(History *history);
+void record_generation(History *history, long long generation, BoardCopy copy, const void *board); // after newest
+long long oldest_generation(const History *history); // -1 if nothing has been recorded
+int seek_history(const History *history, long long generation, BitBoard *bb); // 0 if not held
+int rewind_history(History *history, long long generation); // forget the later generations, 0 if not held
+
+#endif // HISTORY_H
@@ -5,10 +5,12 @@
 */
 
 /*
- Program description: Fully functional simulator for Conway's Game of Life with toroidal or fixed boundaries.
+ Program description: Fully functional simulator for Conway's Game of Life with toroidal or fixed boundaries
+                        (or dead, mirrored or Klein bottle edges).
                         Allows the user to run the simulation multiple times, animating results and option to save to file.
+                        Generations already animated can be looked at again and run on from (see history.h).
                         Option to read in results from file to pick up where you left off.
-                        Allow user to change the game rules to several pre-sets.
+                        Allow user to change the game rules to several pre-sets or any Life-like rule (B/S notation).
                         Options include: 1) Start from a grid of random state cells.
                                             - Size of grid is chosen, cell alive/dead state random
                                          2) Start from a customised grid of cells
@@ -23,46 +25,318 @@
                                                 * Glider Gun
                                                 * 'Die Hard' Eliminator
                                                 * Custom grid i.e one saved previously or written in plain text file.
+                        Headless batch mode: run with --input FILE to step a board file for a set number of generations
+                                             with no rendering or delay and report the speed (see print_usage).
+                                             --random ROWSxCOLS runs a random board of that size instead, with
+                                             any boundary conditions but the infinite plane.
+                                             --metrics FILE records every generation as CSV or Prometheus text.
+                                             --cross-check ENGINE checks the engine against another one.
+                                             Long runs can write checkpoints in the background and be resumed.
+                                             Also runs multi-state Generations rules, e.g. Brian's Brain B2/S/C3.
+                        Soup search: run with --soups N to run N random soups until they settle and count the
+                                     objects left behind (see soup.h).
  */
 
 // Libraries needed
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h> // Booleans
-#include <time.h> // Add delay into animations
-
-#define ALIVE 1
-#define DEAD 0
-#define TIME_INTERVAL 100 // Time interval between animation frmes (milliseconds)
+#include <time.h> // Pace the animation
+#include <errno.h>
+#include <pthread.h> // Simulation thread
+
+#include "conway.h" // Shared definitions for the board and cells
+#include "bitboard.h" // Bit-packed board
+#include "sparse.h" // Unbounded plane
+#include "hashlife.h" // HashLife
+#include "pattern_io.h" // RLE, Life 1.06 and plaintext pattern files
+#include "checkpoint.h" // Binary checkpoints
+#include "render.h" // Terminal animation
+#include "triple_buffer.h" // Frames passed from the simulation to the renderer
+#include "cycle.h" // Still life, oscillator and spaceship detection
+#include "rules.h" // Life-like rules in B/S notation
+#include "generations.h" // Multi-state Generations rules
+#include "soup.h" // Soup search and census
+#include "metrics.h" // Per-generation metrics
+#include "engine.h" // Stepping engines chosen by name
+#include "history.h" // Keyframes and change lists of past generations
+#include "board_memory.h" // Huge pages and first touch for large boards
+
+#define TIME_INTERVAL 100 // Default time interval between generations whilst animating (milliseconds)
+#define FRAME_RATE 30 // Default frames drawn per second whilst animating
 #define GAME_EPOCHS 50 // Default number of iterations for animation
-#define NMAX 50 // maximum tested number of rows and columns for game
-#define ASCII_ADJUST 48 // Map ASCII for integers to their denary (48 in ASCII -> 0 )
-#define NEWLINE_CHAR '\n' // The newline char used in files
-#define CUSTOM_BOARD_FILE "custom_board.txt" // The file to store the 'custom' board when save is chosen
+#define NMAX 65536 // maximum tested number of rows and columns for game
+#define CHECKPOINT_EVERY 1000 // Default number of generations between headless checkpoints
+
+#define DENSITY 0.5 // Default probability of each cell of a random board being alive
 
-// Define a structure with alias 'Cell' for a cell with a state which can be either ALIVE or DEAD and also store the number of neighbours
-typedef struct cell{
-    bool alive;
-    int n_alive_neighbrs;
-}Cell;
+// Define a structure with alias 'RandomGrid' for the size and makeup of a random board (see fill_bitboard_random)
+typedef struct random_grid{
+    int n_rows, n_cols;
+    unsigned long long seed; // the same seed and density always give the same board
+    double density; // probability of each cell being alive
+}RandomGrid;
 
 // Prototype function definitions
 int get_n_elements(void);
-Cell** create_board(int n_rows, int n_cols); // set up double pointer to the board
-void update_rules(int *death_overpop, int *death_underpop, int *birth_repro);
-void delay(int number_of_seconds); // create delay between animation frames
-int up_coord(int coord, int bound); // toroidal boundary conditions
-int down_coord(int coord, int bound); // toroidal boundary conditions
-void add_living_cell(Cell **board, int n_rows, int n_cols, int x, int y);
-void calc_n_neighbours(Cell **board, int n_rows, int n_cols);
-void print_board(Cell **board, int n_rows, int n_cols);
-void free_board(Cell **board, int n_rows, int n_cols); // free dynamic memory
-int update_board(Cell **board, int n_rows, int n_cols, int fixed_bounds, int death_overpop, int death_underpop, int birth_repro);
-void play_game(Cell **board, int n_rows, int n_cols, int fixed_bounds, int death_overpop, int death_underpop, int birth_repro);
-void save_board(Cell **board, int n_rows, int n_cols, int fixed_bounds);
-
-int main(){
+void update_rules(unsigned *birth_mask, unsigned *survive_mask);
+void play_game(Board *board, int fixed_bounds, unsigned birth_mask, unsigned survive_mask,
+               int interval, int frame_rate, int keyframe_every, int history_mb, ThreadPool *pool);
+void run_headless(const char *input, const RandomGrid *random, int resume, const char *output, const char *checkpoint,
+                  long long checkpoint_every, const char *metrics_file, int fixed_bounds, int engine_id,
+                  int cross_check, int block, long long n_generations, int detect_cycles, unsigned birth_mask,
+                  unsigned survive_mask, int n_states, int rule_given, ThreadPool *pool);
+void run_soups(SoupSearch *search, const char *census_file, ThreadPool *pool);
+
+static void print_usage(const char *program){
+    // Print the command line options
+    printf("Usage: %s [--threads N] [--interval MS] [--fps N] [--seed S] [--density D]\n", program);
+    printf("       %*s [--history-every K] [--history-memory MB]\n", (int)strlen(program), "");
+    printf("       %s --input FILE [--generations N] [--rule N|B/S|B/S/C] [--bounds torus|fixed|infinite|dead|reflect|klein]\n",
+           program);
+    printf("       %*s [--engine board|bitboard|sparse|hashlife|generations] [--output FILE] [--threads N]\n",
+           (int)strlen(program), "");
+    printf("       %*s [--checkpoint FILE] [--checkpoint-every N] [--metrics FILE] [--no-cycles]\n",
+           (int)strlen(program), "");
+    printf("       %*s [--cross-check ENGINE] [--block T]\n", (int)strlen(program), "");
+    printf("       %s --resume CHECKPOINT [options as for --input]\n", program);
+    printf("       %s --random ROWSxCOLS [--seed S] [--density D] [options as for --input]\n", program);
+    printf("       %s --soups N [--seed S] [--soup-size N] [--max-generations N] [--census FILE] [--rule B/S]\n",
+           program);
+    printf("With no --input the interactive menu is started, animating a generation every MS milliseconds (default %d,\n", TIME_INTERVAL);
+    printf("0 for as fast as possible) and drawing N frames per second (default %d).\n", FRAME_RATE);
+    printf("The animated generations are kept as a keyframe every K generations (default %d) and the cells changed\n",
+           HISTORY_KEYFRAME_EVERY);
+    printf("in between, in at most MB megabytes (default %d, 0 for none), so any of them can be looked at again\n",
+           HISTORY_MEMORY_MB);
+    printf("and run on from without starting again from the file.\n");
+    printf("With --input the board is run headless for N generations\n");
+    printf("(default %d) with no printing or delay, and the speed is reported at the end.\n", GAME_EPOCHS);
+    printf("With --checkpoint the board is saved to FILE every N generations (default %d) and at the end, and\n", CHECKPOINT_EVERY);
+    printf("--resume carries on from a checkpoint for another N generations.\n");
+    printf("With --metrics the population, births, deaths, bounding box and step time of every generation are written\n");
+    printf("to FILE by a background thread, as CSV, or as Prometheus text rewritten every %d ms if FILE ends in .prom.\n",
+           METRICS_FLUSH_MS);
+    printf("Random boards (--random, or Random Grid in the menu) have each cell alive with probability D (default %.1f)\n",
+           DENSITY);
+    printf("and are the same for the same --seed S, whatever the number of threads. With no seed one is taken from the\n");
+    printf("clock and printed.\n");
+    printf("--rule takes a preset from the menu (1 to %d) or a rule in B/S notation, e.g. B36/S23, and defaults to\n",
+           N_RULE_PRESETS);
+    printf("the rule in a RLE file header or B3/S23. Headless runs also take Generations rules with C states,\n");
+    printf("e.g. B2/S/C3 (Brian's Brain), stepped by the generations engine.\n");
+    printf("Once the board repeats (still life, oscillator, or spaceship on a torus) whole periods are skipped,\n");
+    printf("--no-cycles steps every generation.\n");
+    printf("--bounds fixed freezes the outer ring of cells, dead surrounds the board with dead cells, reflect mirrors it\n");
+    printf("along each edge and klein joins the top and bottom edges reversed (a Klein bottle). The last three are run\n");
+    printf("by the board engine.\n");
+    printf("--cross-check runs a second engine (e.g. board, the reference) side by side from the same start, and\n");
+    printf("stops with an error at the first generation where the two disagree.\n");
+    printf("--block T has the bitboard engine advance T generations (default 1) in each pass over the board, each\n");
+    printf("thread stepping its rows with a halo of T rows while they are in cache, which helps boards too big for\n");
+    printf("the cache. Cycles are not looked for, and a cross-check compares the engines every T generations.\n");
+    printf("With --soups, N random soups of %dx%d cells (--soup-size) are run on the infinite plane until they settle,\n",
+           SOUP_SIZE, SOUP_SIZE);
+    printf("or for at most %d generations, and the census of the objects left is written as CSV to FILE (or printed).\n",
+           SOUP_MAX_GENERATIONS);
+}
 
+int main(int argc, char *argv[]){
+
+    // Command line options: --threads N sets the number of threads used to update the board,
+    // --input FILE (or --resume CHECKPOINT) and the options after it run the board from FILE headless (see run_headless)
+    int n_threads = default_n_threads();
+    const char *input = NULL, *output = NULL, *checkpoint = NULL, *metrics_file = NULL; // headless files
+    int bounds = -1, engine = ENGINE_DEFAULT; // bounds -1 for the boundary conditions in the file header
+    int cross_check = -1; // engine run side by side with the one chosen, -1 for none
+    int block = 1; // generations advanced per pass over the board (bitboard engine)
+    unsigned birth_mask = LIFE_BIRTH, survive_mask = LIFE_SURVIVE; // The default game rules (see parse_rule)
+    int n_states = 2; // states of a Generations rule, 2 for a Life-like rule
+    int rule_given = 0; // 1 if --rule was given
+    int resume = 0; // 1 if input is a checkpoint
+    int interval = TIME_INTERVAL, frame_rate = FRAME_RATE; // animation speed
+    int keyframe_every = HISTORY_KEYFRAME_EVERY, history_mb = HISTORY_MEMORY_MB; // generations kept to rewind to
+    int detect_cycles = 1; // skip whole periods once the headless board repeats
+    long long n_generations = GAME_EPOCHS, checkpoint_every = CHECKPOINT_EVERY;
+    RandomGrid random = {0, 0, 0, DENSITY}; // --random ROWSxCOLS runs a random board headless
+    int seed_given = 0; // 1 if --seed was given
+    SoupSearch search = {0, 0, SOUP_SIZE, SOUP_MAX_GENERATIONS, 0, 0, NULL, 0, 0, 0}; // --soups N runs a soup search
+    const char *census_file = NULL; // CSV file for the census of a soup search (NULL to print it)
+    for (int k = 1; k < argc; k++){
+        if (strcmp(argv[k], "--threads") == 0 && k+1 < argc){
+            n_threads = atoi(argv[++k]);
+            if (n_threads < 1){
+                printf("[ERROR]: Number of threads must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if ((strcmp(argv[k], "--input") == 0 || strcmp(argv[k], "--resume") == 0) && k+1 < argc){
+            if (input != NULL){
+                printf("[ERROR]: Give only one --input or --resume file\n");
+                exit(EXIT_FAILURE);
+            }
+            resume = (strcmp(argv[k], "--resume") == 0);
+            input = argv[++k];
+        }else if (strcmp(argv[k], "--interval") == 0 && k+1 < argc){
+            interval = atoi(argv[++k]);
+            if (interval < 0){
+                printf("[ERROR]: Interval between generations must be an integer of 0 or more\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--fps") == 0 && k+1 < argc){
+            frame_rate = atoi(argv[++k]);
+            if (frame_rate < 1){
+                printf("[ERROR]: Frames per second must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--history-every") == 0 && k+1 < argc){
+            keyframe_every = atoi(argv[++k]);
+            if (keyframe_every < 1){
+                printf("[ERROR]: Generations between keyframes must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--history-memory") == 0 && k+1 < argc){
+            history_mb = atoi(argv[++k]);
+            if (history_mb < 0){
+                printf("[ERROR]: Memory for the history must be an integer of 0 or more megabytes\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--checkpoint") == 0 && k+1 < argc){
+            checkpoint = argv[++k];
+        }else if (strcmp(argv[k], "--metrics") == 0 && k+1 < argc){
+            metrics_file = argv[++k];
+        }else if (strcmp(argv[k], "--checkpoint-every") == 0 && k+1 < argc){
+            checkpoint_every = atoll(argv[++k]);
+            if (checkpoint_every < 1){
+                printf("[ERROR]: Generations between checkpoints must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--block") == 0 && k+1 < argc){
+            block = atoi(argv[++k]);
+            if (block < 1){
+                printf("[ERROR]: Generations per pass over the board must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--no-cycles") == 0){
+            detect_cycles = 0;
+        }else if (strcmp(argv[k], "--soups") == 0 && k+1 < argc){
+            search.n_soups = atoll(argv[++k]);
+            if (search.n_soups < 1){
+                printf("[ERROR]: Number of soups must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--seed") == 0 && k+1 < argc){
+            random.seed = search.seed = strtoull(argv[++k], NULL, 0);
+            seed_given = 1;
+        }else if (strcmp(argv[k], "--density") == 0 && k+1 < argc){
+            char *end;
+            random.density = strtod(argv[++k], &end);
+            if (*end != '\0' || !(random.density >= 0.0 && random.density <= 1.0)){
+                printf("[ERROR]: Density must be a number from 0 to 1\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--random") == 0 && k+1 < argc){
+            char by;
+            if (sscanf(argv[++k], "%d%c%d", &random.n_rows, &by, &random.n_cols) != 3 || (by != 'x' && by != 'X')
+                || random.n_rows < 1 || random.n_cols < 1){
+                printf("[ERROR]: Give the size of the random board as ROWSxCOLS, e.g. 1024x1024\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--soup-size") == 0 && k+1 < argc){
+            search.soup_size = atoi(argv[++k]);
+            if (search.soup_size < 1 || search.soup_size > SOUP_MAX_SIZE){
+                printf("[ERROR]: Soup size must be an integer from 1 to %d\n", SOUP_MAX_SIZE);
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--max-generations") == 0 && k+1 < argc){
+            search.max_generations = atoll(argv[++k]);
+            if (search.max_generations < 1){
+                printf("[ERROR]: Generations per soup must be an integer greater than 0\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--census") == 0 && k+1 < argc){
+            census_file = argv[++k];
+        }else if (strcmp(argv[k], "--output") == 0 && k+1 < argc){
+            output = argv[++k];
+        }else if (strcmp(argv[k], "--generations") == 0 && k+1 < argc){
+            n_generations = atoll(argv[++k]);
+            if (n_generations < 0){
+                printf("[ERROR]: Number of generations must be an integer of 0 or more\n");
+                exit(EXIT_FAILURE);
+            }
+        }else if (strcmp(argv[k], "--rule") == 0 && k+1 < argc){
+            char *end;
+            long preset = strtol(argv[++k], &end, 10); // a number on its own is a preset
+            n_states = 2;
+            if (!(*end == '\0' && rule_preset((int)preset, &birth_mask, &survive_mask))
+                && !parse_generations_rule(argv[k], &birth_mask, &survive_mask, &n_states)){
+                printf("[ERROR]: Unknown rule %s, choose 1 to %d or give it as B/S or B/S/C, e.g. B3/S23 or B2/S/C3\n",
+                       argv[k], N_RULE_PRESETS);
+                exit(EXIT_FAILURE);
+            }
+            rule_given = 1;
+        }else if (strcmp(argv[k], "--bounds") == 0 && k+1 < argc){
+            bounds = find_bounds(argv[++k]);
+            if (bounds < 0){
+                printf("[ERROR]: Unknown boundary conditions %s, choose torus, fixed, infinite, dead, reflect or klein\n",
+                       argv[k]);
+                exit(EXIT_FAILURE);
+            }
+        }else if ((strcmp(argv[k], "--engine") == 0 || strcmp(argv[k], "--cross-check") == 0) && k+1 < argc){
+            int id = find_engine(argv[k+1]);
+            if (id < 0){
+                printf("[ERROR]: Unknown engine %s\n", argv[k+1]);
+                exit(EXIT_FAILURE);
+            }
+            if (strcmp(argv[k], "--engine") == 0){
+                engine = id;
+            }else{
+                cross_check = id;
+            }
+            k++;
+        }else if (strcmp(argv[k], "--help") == 0){
+            print_usage(argv[0]);
+            return 0;
+        }else{
+            printf("[ERROR]: Unknown option %s\n", argv[k]);
+            print_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    ThreadPool *pool = create_thread_pool(n_threads); // workers persist for every game played
+    set_board_memory_pool(pool); // large boards are placed in memory by the threads that step them
+    if (!seed_given){ // a different random board every run, the seed is printed so it can be made again
+        random.seed = (unsigned long long)time(NULL);
+    }
+
+    if (search.n_soups > 0){ // Soup search
+        if (input != NULL || random.n_rows > 0 || n_states > 2 || (birth_mask & 1)){
+            printf("[ERROR]: Soups are run on their own on the infinite plane, with a Life-like rule without B0\n");
+            exit(EXIT_FAILURE);
+        }
+        search.birth_mask = birth_mask;
+        search.survive_mask = survive_mask;
+        run_soups(&search, census_file, pool);
+        free_thread_pool(pool);
+        return 0;
+    }else if (input != NULL || random.n_rows > 0){ // Headless batch run
+        if (input != NULL && random.n_rows > 0){
+            printf("[ERROR]: Give either an --input file or a --random board\n");
+            exit(EXIT_FAILURE);
+        }
+        run_headless(input, (input == NULL) ? &random : NULL, resume, output, checkpoint, checkpoint_every, metrics_file,
+                     bounds, engine, cross_check, block, n_generations, detect_cycles, birth_mask, survive_mask,
+                     n_states, rule_given, pool);
+        free_thread_pool(pool);
+        return 0;
+    }else if (output != NULL || checkpoint != NULL || metrics_file != NULL || bounds != -1 || engine != ENGINE_DEFAULT
+               || cross_check >= 0 || block != 1){
+        printf("[ERROR]: Headless options need an --input board file or a --random board\n");
+        exit(EXIT_FAILURE);
+    }else if (n_states > 2){
+        printf("[ERROR]: Generations rules are only run headless, give an --input board file or a --random board\n");
+        exit(EXIT_FAILURE);
+    }
 
 	printf("-------------------------------------------\n");
     printf("           Conway's Game of Life           \n");
@@ -70,7 +344,6 @@ int main(){
 
 	// Simple menu to select setup for grid
     unsigned int option = 0; // flag for option chosen
-    int death_overpop = 3, death_underpop = 2, birth_repro = 3; // The default game rules
 
     do{
         printf("\n\nSelect Gamemode:\n");
@@ -81,7 +354,7 @@ int main(){
         printf("\t5: Quit\n");
         scanf("%d",&option); // Take user input
 
-        int fixed_bounds = 0; // Whether to use hard boundaries -> 1, or toroidal boundary conditions -> 0 (grid is wrapped about x and y)
+        int fixed_bounds = 0; // Whether to use hard boundaries -> 1, toroidal boundary conditions -> 0 (grid is wrapped about x and y) or an unbounded plane -> 2
         int n_rows, n_cols; // Number rows and columns in the Game of Life Board
 
 
@@ -95,17 +368,19 @@ int main(){
                 n_cols = get_n_elements();
 
                 // Declare the board
-                Cell **board = create_board(n_rows,n_cols);
+                Board *board = create_board(n_rows,n_cols);
 
-                ////Fill the board with random states, either ALIVE or DEAD.
-                for (int i = 0; i < n_rows; i++){
-                    for (int j = 0; j < n_cols; j++){
-                        board[i][j].alive = rand()%2; // random value for ALIVE or DEAD
-                    }
-                }
+                // Fill the board with random states, made a word of 64 cells at a time by the threads of the pool
+                BitBoard *bb = create_bitboard(n_rows, n_cols);
+                fill_bitboard_random(bb, random.seed, random.density, pool);
+                bitboard_to_cells(bb, board);
+                free_bitboard(bb);
+                printf("Random grid from seed %llu with density %g\n", random.seed, random.density);
+                random.seed++; // a new grid next time
 
                 // Run the simulation
-                play_game(board, n_rows, n_cols, fixed_bounds, death_overpop, death_underpop, birth_repro);
+                play_game(board, fixed_bounds, birth_mask, survive_mask, interval, frame_rate,
+                          keyframe_every, history_mb, pool);
 
                 option = 0; // Reset option to allow user to play again
                 break;}
@@ -118,7 +393,7 @@ int main(){
                 n_cols = get_n_elements();
 
                 // Declare the board
-                Cell **board = create_board(n_rows,n_cols);
+                Board *board = create_board(n_rows,n_cols);
 
                 // Allow user to add living cells to the board as many times as desired
                 int x, y; // integers to hold coords of cell to add to grid
@@ -133,14 +408,15 @@ int main(){
                     }else{
                         printf("y = ");
                         scanf("%d",&y); // Take user input for y coord of cell to add
-                        add_living_cell(board,n_rows,n_cols,x,y); // add cell to grid (with error checking)
-                        system("cls"); // clear console
-                        print_board(board,n_rows,n_cols); // print the board
+                        add_living_cell(board,x,y); // add cell to grid (with error checking)
+                        clear_screen(); // clear console
+                        print_board(board); // print the board
                     }
                 }
 
                 // Run the simulation
-                play_game(board, n_rows, n_cols, fixed_bounds, death_overpop, death_underpop, birth_repro);
+                play_game(board, fixed_bounds, birth_mask, survive_mask, interval, frame_rate,
+                          keyframe_every, history_mb, pool);
 
                 option = 0; // Reset option to allow user to play again
                 break;}
@@ -157,29 +433,29 @@ int main(){
                 printf("\t7: Custom grid from file %s\n",CUSTOM_BOARD_FILE);
                 scanf("%d",&option); // Take user input
 
-                FILE *readfile; // Pointer to a file
+                const char *filename = NULL; // File to read in grid from
                 do{
                     switch (option){
                         case 1:{ // Pulsar
-                            readfile = fopen("pulsar.txt", "r"); // Try to open file to read in grid from
+                            filename = "pulsar.txt";
                             break;
                         }case 2:{ // Penta-decathlon
-                            readfile = fopen("Penta-decathlon.txt", "r");
+                            filename = "Penta-decathlon.txt";
                             break;
                         }case 3:{ // Glider
-                            readfile = fopen("glider.txt", "r");
+                            filename = "glider.txt";
                             break;
                         }case 4:{ // Medium Spaceship
-                            readfile = fopen("spaceship.txt", "r");
+                            filename = "spaceship.txt";
                             break;
                         }case 5:{ // Gospal Glider gun
-                            readfile = fopen("glider_gun.txt", "r");
+                            filename = "glider_gun.txt";
                             break;
                         }case 6:{ // Die-hard eliminator
-                            readfile = fopen("die_hard.txt", "r");
+                            filename = "die_hard.txt";
                             break;
                         }case 7:{ // Custom board from file
-                            readfile = fopen(CUSTOM_BOARD_FILE, "r");
+                            filename = CUSTOM_BOARD_FILE;
                             break;
                         }default:{ // Error if wrong number chosen
                             printf("[ERROR] Please choose a pre-set from the menu");
@@ -187,57 +463,18 @@ int main(){
                     }
                 }while(option > 7 || option < 1); // loop until user chooses valid value
 
-                // Error check file is found and opened correctly
-                if (readfile == NULL){
-                    printf("[ERROR]: File does not exist");
-                    exit(EXIT_FAILURE);
-                }
-                // Read in the number of rows and cols given in first line of the file.
-                if (fscanf(readfile, "n_rows:%d, n_cols:%d, fixed_bounds:%d", &n_rows, &n_cols, &fixed_bounds) == EOF){
-                    printf("[ERROR]: Grid size header missing from file. Specify as n_rows,n_columns"); // Error if header missing
-                    exit(EXIT_FAILURE);
-                }
-
-                // Declare the board
-                Cell **board = create_board(n_rows,n_cols);
-
-                // Read in the cell states in the grid from file.
-                char c; // Hold each cell state. '1' Represents living cell, '0' represents dead cell
-                int col = 0, row = -1; // flags for coords of each cell in grid
-                while((c = fgetc(readfile)) != EOF) { // loop until end of file, taking in 1 char at a time
-                    if (row > n_rows+1 || col > n_cols){
-                        // Error check that the grid is rectangular and the correct size specified, preventing overflow
-                        printf("\n[ERROR]: Read grid from file failed, dimensions (%d,%d) exceed those specified in the file header (%d,%d)",row,col,n_rows,n_cols);
-                        exit(EXIT_FAILURE);
-                        break;
-                    }
-                    if (c == NEWLINE_CHAR){ // If newline char reached add 1 to the row and reset the column flag to 0
-                        row += 1;
-                        col = 0;
-                        printf("\n");
-                    }else{
-                        if (c-ASCII_ADJUST != 0 && c-ASCII_ADJUST !=1){ // Cast ASCII code to int
-                            // Error check that only 1's and 0's in the grid
-                            printf("\n[ERROR]: Anomalous value in file. Ensure that only 0's and 1's are in the board file");
-                            exit(EXIT_FAILURE);
-                        }else{
-                            // Set the living states in the board grid
-                            board[row][col].alive = c-ASCII_ADJUST; // Cast ASCII code to int
-                            printf("%d ",board[row][col].alive);
-                        }
-                        col += 1; // Increment the column
-                    }
-                }
-                fclose(readfile); // Close the file
+                // Declare the board and read in the cell states from file, printing them as they are read
+                Board *board = load_board(filename, &fixed_bounds, 1);
 
                 // Run the simulation
-                play_game(board, n_rows, n_cols, fixed_bounds, death_overpop, death_underpop, birth_repro);
+                play_game(board, fixed_bounds, birth_mask, survive_mask, interval, frame_rate,
+                          keyframe_every, history_mb, pool);
 
                 option = 0; // Reset option to allow user to play again
                 break;}
             case 4:{ // Change the game rules
                 printf("Select game rules");
-                update_rules(&death_overpop, &death_underpop, &birth_repro); // Update the rules passing pointers to variables
+                update_rules(&birth_mask, &survive_mask); // Update the rules passing pointers to variables
                 option = 0; // Reset option to allow user to play again
                 break;}
             case 5:{ // User selected quit
@@ -249,218 +486,678 @@ int main(){
         }
     }while(option > 5 || option < 1); // loop until user picks value from the menu
 
+    free_thread_pool(pool);
     return 0;
 }
 
-void play_game(Cell **board, int n_rows, int n_cols, int fixed_bounds,
-               int death_overpop, int death_underpop, int birth_repro){
+static void wait_for_tick(struct timespec *tick, long period){
+    /*
+    Sleep until one period (nanoseconds) after the last tick, and make that the new tick.
+    - Sleeps on the monotonic clock to an absolute time, so the time taken between ticks does not add up into drift
+    - If the tick has already passed (the caller is running behind) the ticks restart from now instead of bunching up
+    */
+    tick->tv_nsec += period % 1000000000L;
+    tick->tv_sec += period / 1000000000L + tick->tv_nsec / 1000000000L;
+    tick->tv_nsec %= 1000000000L;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > tick->tv_sec || (now.tv_sec == tick->tv_sec && now.tv_nsec >= tick->tv_nsec)){
+        *tick = now;
+        return;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, tick, NULL) == EINTR);
+}
+
+// Define a structure with alias 'Simulation' for the generations run by the simulation thread of play_game
+typedef struct simulation{
+    Board *board;
+    SparsePlane *plane; // unbounded plane, NULL unless INFINITE_BOUNDS
+    int fixed_bounds;
+    unsigned birth_mask, survive_mask;
+    ThreadPool *pool;
+    TripleBuffer *frames; // generations published for the renderer
+    long interval; // nanoseconds between generations, 0 for as fast as possible
+    int first_generation; // generations run before this batch
+    int n_run; // generations run in this batch
+    long long cells_alive;
+    CycleDetector *cycles; // history of the board, NULL for the unbounded plane
+    History *history; // generations to rewind to, NULL for the unbounded plane or if none are kept
+}Simulation;
+
+static void publish_generation(Simulation *sim, int last){
+    // Copy the board into the back frame with its status line and publish it
+    Frame *frame = back_frame(sim->frames);
+    int generation = sim->first_generation + sim->n_run;
+    frame->generation = generation;
+    if (sim->plane != NULL){ // the window of the plane covered by the board
+        sparse_to_bitboard(sim->plane, frame->cells, 0, 0);
+        snprintf(frame->status, FRAME_STATUS_LENGTH, "Generation %d: %lld cells alive, %zu chunks allocated",
+                 generation, sim->cells_alive, sim->plane->n_chunks);
+    }else{
+        cells_to_bitboard(sim->board, frame->cells);
+        snprintf(frame->status, FRAME_STATUS_LENGTH, "Generation %d: %lld cells alive, %d of %d tiles active",
+                 generation, sim->cells_alive, sim->board->n_active_tiles, sim->board->n_tile_rows*sim->board->n_tile_cols);
+    }
+    publish_frame(sim->frames, last);
+}
+
+static void* simulate(void *arg){
+    /*
+    Simulation thread: run up to GAME_EPOCHS generations, stopping early if no living cells remain or the board has
+    entered a cycle (still life, oscillator or spaceship on a torus).
+    - A generation is only copied into a frame if the renderer has taken the last one (it would never be drawn
+      otherwise), apart from the last generation which is always published
+    - Between generations the thread sleeps until the next tick of sim->interval, never spinning
+    */
+    Simulation *sim = (Simulation *)arg;
+    struct timespec tick;
+    clock_gettime(CLOCK_MONOTONIC, &tick);
+    int last = 0; // 1 once the generation just run is the last of the batch
+    while (!last && sim->n_run < GAME_EPOCHS && sim->cells_alive > 0){
+        if (sim->plane != NULL){
+            sim->cells_alive = step_sparse(sim->plane, sim->birth_mask, sim->survive_mask, sim->pool);
+        }else{
+            sim->cells_alive = update_board(sim->board, sim->fixed_bounds, sim->birth_mask, sim->survive_mask, sim->pool);
+        }
+        sim->n_run++;
+        int repeating = 0;
+        if (sim->cycles != NULL){
+            repeating = observe_generation(sim->cycles, sim->first_generation + sim->n_run, sim->board->hash,
+                                           sim->board->shape, copy_board, sim->board);
+        }
+        if (sim->history != NULL){
+            record_generation(sim->history, sim->first_generation + sim->n_run, copy_board, sim->board);
+        }
+        last = (sim->n_run == GAME_EPOCHS || sim->cells_alive == 0 || repeating);
+        if (last || frame_taken(sim->frames)){
+            publish_generation(sim, last);
+        }
+        if (sim->interval > 0 && !last){
+            wait_for_tick(&tick, sim->interval);
+        }
+    }
+    if (sim->n_run == 0){ // nothing to run, let the renderer stop
+        publish_generation(sim, 1);
+    }
+    return NULL;
+}
+
+static int choose_next(Board *board, int fixed_bounds, History *history, CycleDetector **cycles, Renderer *renderer,
+                       int *n_generations, long long *cells_alive){
+    /*
+    Ask the user what to do after a batch of generations: carry on, look back at another generation, or stop.
+    Return 1 to run another batch.
+    Inputs: board - pointer to the board, at generation *n_generations
+            fixed_bounds - type of boundary conditions
+            history - generations to look back at (NULL if none are kept)
+            *cycles - pointer to the cycle detector of the board (NULL for the unbounded plane)
+            renderer - draws the generations looked at
+            *n_generations, *cells_alive - pointers to the generation of the board and its living cells
+    - Any generation still in the history can be rebuilt and drawn (see seek_history), as many times as wanted
+    - Carrying on is offered while the generation shown has living cells, unless it is the newest and the board
+      has entered a cycle
+    - Leaving from an earlier generation puts it back on the board, to carry on from or save, and forgets the
+      generations after it, in the history and in a new cycle detector
+    */
+    long long newest = *n_generations, shown = newest; // generation on the board and generation last drawn
+    long long shown_alive = *cells_alive;
+    BitBoard *view = (history != NULL) ? create_bitboard(board->n_rows, board->n_cols) : NULL;
+    int keep_playing = 0;
+    while (1){
+        int repeating = (shown == newest && *cycles != NULL && (*cycles)->found);
+        int can_continue = (shown_alive > 0 && !repeating);
+        if (!can_continue && history == NULL){
+            break;
+        }
+        if (!can_continue){
+            printf("\nWould you like to look back at another generation?\n");
+        }else if (shown == newest){
+            printf("\nWould you like continue (%d more iterations)?\n",GAME_EPOCHS);
+        }else{
+            printf("\nWould you like continue from generation %lld (%d more iterations)?\n", shown, GAME_EPOCHS);
+        }
+        if (can_continue){
+            printf("\t1: Yes\n");
+        }
+        if (history != NULL){
+            printf("\t2: Look at generation %lld to %lld\n", oldest_generation(history), newest);
+        }
+        printf("\t0: No\n");
+        int option = 0;
+        scanf("%d",&option); // Give user option to keep playing
+        if (option != 2 || history == NULL){
+            keep_playing = (option == 1 && can_continue);
+            break;
+        }
+
+        long long generation = -1;
+        printf("Generation: ");
+        if (scanf("%lld", &generation) != 1 || !seek_history(history, generation, view)){
+            printf("[ERROR] That generation is not in the history.\n");
+            continue;
+        }
+        shown = generation;
+        shown_alive = count_bitboard(view);
+        char status[FRAME_STATUS_LENGTH];
+        snprintf(status, FRAME_STATUS_LENGTH, "Generation %lld of %lld: %lld cells alive", shown, newest, shown_alive);
+        reset_renderer(renderer);
+        render_frame(renderer, view, status);
+    }
+
+    if (shown != newest){ // carry on from the generation shown
+        rewind_history(history, shown);
+        bitboard_to_cells(view, board);
+        mark_board_dirty(board);
+        *n_generations = (int)shown;
+        *cells_alive = shown_alive;
+        free_cycle_detector(*cycles);
+        *cycles = create_cycle_detector(board->n_rows, board->n_cols, fixed_bounds == 0);
+    }
+    if (view != NULL){
+        free_bitboard(view);
+    }
+    return keep_playing;
+}
+
+void play_game(Board *board, int fixed_bounds, unsigned birth_mask, unsigned survive_mask,
+               int interval, int frame_rate, int keyframe_every, int history_mb, ThreadPool *pool){
     /*
     Run the Conway's Game of life simulation with specified rules based on initial conditions and boundary conditions.
-    Inputs: board - Double pointer to the board with initial conditions (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
-            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries)
-            death_overpop - if number of neighbours greater than death_overpop cell dies due to overpopulation
-            death_underpop - if number of neighbours greater than death_underpop cell dies due to underpopulation
-            birth_repro - if number of neighbours equal to birth_repro cell becomes alive due to reproduction
+    Inputs: board - pointer to the board with initial conditions (declared by create_board)
+            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries,
+                           INFINITE_BOUNDS for an unbounded plane with the board as a window onto it)
+            birth_mask, survive_mask - the game rule (see parse_rule)
+            interval - milliseconds between generations, 0 to run them as fast as possible
+            frame_rate - frames drawn per second
+            keyframe_every - generations between keyframes of the history (see history.h)
+            history_mb - megabytes the history may hold, 0 for no history
+            pool - threads used to update the board (declared by create_thread_pool)
     - Allow user to run simulation as many times as desired.
+    - The generations are run on a simulation thread which publishes them into a triple buffer. This thread draws
+      the newest one frame_rate times a second with a Renderer, which only redraws the cells that changed.
+      Neither thread waits for the other, and both sleep rather than spin between ticks.
     - Print the number of living cells after every GAME_EPOCHS generations
+    - Stop once the board repeats, printing the period of the cycle
+    - Allow the user to look back at any generation still in the history and carry on from there
     - Allow the user option to save the results to a file
     */
 
-    int cells_alive = 1; // flag for number of cells alive
+    long long cells_alive = 1; // flag for number of cells alive
     int n_generations = 0; // counter for the total number of generations elapsed
     int keep_playing = 1; // flag for user to keep running simulations
+    SparsePlane *plane = NULL; // unbounded plane, only used with INFINITE_BOUNDS
+    if (fixed_bounds == INFINITE_BOUNDS && (birth_mask & 1)){
+        printf("[WARNING]: Rules with B0 fill the infinite plane, using toroidal boundary conditions\n");
+        fixed_bounds = 0;
+    }
+    if (fixed_bounds == INFINITE_BOUNDS){
+        plane = sparse_from_cells(board);
+    }
+    CycleDetector *cycles = NULL; // not for the unbounded plane, which has no board to repeat
+    History *history = NULL; // not for the unbounded plane either, or if no memory is given for it
+    if (plane == NULL){
+        cycles = create_cycle_detector(board->n_rows, board->n_cols, fixed_bounds == 0);
+        board->hash_cells = 1; // only worked out for a cycle detector
+        if (history_mb > 0){
+            history = create_history(board->n_rows, board->n_cols, keyframe_every, (size_t)history_mb << 20);
+            record_generation(history, 0, copy_board, board);
+        }
+    }
+    Renderer *renderer = create_renderer(board->n_rows, board->n_cols);
+    TripleBuffer *frames = create_triple_buffer(board->n_rows, board->n_cols);
 
     while (keep_playing == 1){
-        int i = 0; // Run simulation of GAME_EPOCHS steps
-        while (i < GAME_EPOCHS && cells_alive > 0){ // Run until limit of epochs reached or no living cells remain (improve efficiency)
-            i++;
-            system("cls"); // Clear terminal
-            // Update the board based on the game rules and print to console
-            cells_alive = update_board(board,n_rows,n_cols,fixed_bounds, death_overpop, death_underpop, birth_repro);
-            print_board(board,n_rows,n_cols);
-            delay(TIME_INTERVAL); // 'Animate' results by introducing delay
-        }
-        n_generations += i; // count total number of generations elapsed
-        printf("\nAfter %d generations, %d cells survive\n",n_generations,cells_alive);
-
-        if (cells_alive > 0){ // If cells are still alive, allow user to continue animation
-            printf("\nWould you like continue (%d more iterations)?\n",GAME_EPOCHS);
-            printf("\t1: Yes\n");
-            printf("\t0: No\n");
-            scanf("%d",&keep_playing); // Give user option to keep playing
-        }else{
-            keep_playing = 0; // default to break condition
+        // Run simulation of GAME_EPOCHS steps, until limit of epochs reached or no living cells remain
+        Simulation sim = {board, plane, fixed_bounds, birth_mask, survive_mask, pool, frames,
+                          1000000L * interval, n_generations, 0, cells_alive, cycles, history};
+        reset_renderer(renderer); // Clear terminal of the menu
+        reopen_triple_buffer(frames);
+        pthread_t sim_thread;
+        if (pthread_create(&sim_thread, NULL, simulate, &sim) != 0){
+            printf("[ERROR] Could not start the simulation thread\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Draw the newest generation every frame until the simulation has published its last one
+        struct timespec tick;
+        clock_gettime(CLOCK_MONOTONIC, &tick);
+        int finished = 0;
+        while (1){
+            const Frame *frame = take_frame(frames, &finished);
+            if (frame != NULL){
+                render_frame(renderer, frame->cells, frame->status);
+            }
+            if (finished){
+                break;
+            }
+            wait_for_tick(&tick, 1000000000L / frame_rate);
         }
+        pthread_join(sim_thread, NULL);
 
+        n_generations += sim.n_run; // count total number of generations elapsed
+        cells_alive = sim.cells_alive;
+        if (plane != NULL){ // show the window of the plane covered by the board when saving
+            sparse_to_cells(plane, board, 0, 0);
+        }
+        printf("\nAfter %d generations, %lld cells survive\n",n_generations,cells_alive);
+
+        if (cycles != NULL && cycles->found && cells_alive > 0){ // nothing new to see, stop
+            if (cycles->period == 1){
+                printf("The board has been still since generation %lld\n", cycles->start);
+            }else if (cycles->shift_rows == 0 && cycles->shift_cols == 0){
+                printf("The board repeats every %lld generations from generation %lld\n", cycles->period, cycles->start);
+            }else{
+                printf("The board repeats every %lld generations from generation %lld, moving %d rows and %d columns\n",
+                       cycles->period, cycles->start, cycles->shift_rows, cycles->shift_cols);
+            }
+        }
+        keep_playing = choose_next(board, fixed_bounds, history, &cycles, renderer, &n_generations, &cells_alive);
     }
 
     if (cells_alive > 0){ // If cells are still, give the user the option to save the board
-        save_board(board, n_rows, n_cols, fixed_bounds);
+        save_board(board, fixed_bounds);
     }
 
-    free_board(board, n_rows, n_cols); // Free the dynamically allocated memory for the board
+    free_triple_buffer(frames);
+    free_renderer(renderer);
+    if (cycles != NULL){
+        free_cycle_detector(cycles);
+    }
+    if (history != NULL){
+        free_history(history);
+    }
+    if (plane != NULL){
+        free_sparse(plane);
+    }
+    free_board(board); // Free the dynamically allocated memory for the board
 }
 
-void update_rules(int *death_overpop, int *death_underpop, int *birth_repro){
+void update_rules(unsigned *birth_mask, unsigned *survive_mask){
     /*
-    Update the game rules changing the conditions for death due to overpopulation and underpopulation and for birth from reproduction.
-    Inputs: *death_overpop - pointer to var storing the value for overpopulation. If cell has < death_overpop neighbours it dies
-            *death_underpop - pointer to var storing the value for underpopulation. If cell has < death_underpop neighbours it dies
-            *birth_repro - pointer to var storing the value for reproduction. If cell has == birth_repro neighbours it becomes alive
+    Update the game rules from the pre-sets or a rule typed in B/S notation.
+    Inputs: *birth_mask - pointer to var storing the birth counts. A dead cell with n neighbours becomes alive if bit n is set
+            *survive_mask - pointer to var storing the survival counts. A living cell with n neighbours dies unless bit n is set
     */
-    printf("\n\nSelect Game Rules for n neighbours:\n");
-    printf("\t1: Classic Rules: Overpopulation: n > 3, Underpopulation: n < 2, Reproduction n = 3\n");
-    printf("\t2: Custom Rules 1: Overpopulation: n > 6, Underpopulation: n < 3, Reproduction n = 4\n");
-    printf("\t3: Custom Rules 2: Overpopulation: n > 4, Underpopulation: n < 2, Reproduction n = 3\n");
+    printf("\n\nSelect Game Rules (B: neighbours for a dead cell to become alive, S: for a living cell to survive):\n");
+    for (int preset = 1; preset <= N_RULE_PRESETS; preset++){
+        unsigned birth, survive;
+        char rule[RULE_STRING_LENGTH];
+        rule_preset(preset, &birth, &survive);
+        rule_string(birth, survive, rule);
+        printf("\t%d: %s: %s\n", preset, rule_preset_name(preset), rule);
+    }
+    printf("\t%d: Enter a rule, e.g. B36/S23\n", N_RULE_PRESETS + 1);
 
     int option = 0;
     scanf("%d",&option); // Take user input
 
-    switch (option){
-        case 1:{ // Random Grid Selected
-            *death_overpop = 3; *death_underpop = 2; *birth_repro = 3; break;
-        }case 2:{ // Random Grid Selected
-            *death_overpop = 6; *death_underpop = 3; *birth_repro = 5; break;
-        }case 3:{ // Random Grid Selected
-            *death_overpop = 4; *death_underpop = 2; *birth_repro = 3; break;
-        }default:{
-            printf("[ERROR] Please select option from menu.\n");
+    if (option == N_RULE_PRESETS + 1){
+        char text[RULE_STRING_LENGTH];
+        printf("Rule: ");
+        if (scanf("%23s", text) != 1 || !parse_rule(text, birth_mask, survive_mask)){
+            printf("[ERROR] Not a rule in B/S notation.\n");
         }
+    }else if (!rule_preset(option, birth_mask, survive_mask)){
+        printf("[ERROR] Please select option from menu.\n");
     }
-    printf("Overpopulation: n > %d, Underpopulation: n < %d, Reproduction n = %d\n",*death_overpop,*death_underpop,*birth_repro);
+    char rule[RULE_STRING_LENGTH];
+    rule_string(*birth_mask, *survive_mask, rule);
+    printf("Rule %s\n", rule);
 }
 
-Cell ** create_board(int n_rows, int n_cols){
-    /*
-    Creates n_rows*n_cols double pointer array of Cells (structure containing info about each cell).
-    - Error checks for memory overflow
-    - All cells set to be dead on declaration
-    - Return the double pointer to empty board.
-    */
-
-    Cell **board = (Cell **)malloc(n_rows * sizeof(Cell *)); // Allocate memory for array (rows)
-
-    if (board == NULL){ // Error check for memory
-        printf("[ERROR] Out of memory whilst creating the board\n");
-        exit(EXIT_FAILURE);
-    }
+static double elapsed_seconds(const struct timespec *start){
+    // Wall clock time since start
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + 1e-9*(double)(now.tv_nsec - start->tv_nsec);
+}
 
-	for (int i=0; i<n_rows; i++){ // Allocate memory for each column
-		board[i] = (Cell *)malloc(n_cols * sizeof(Cell));
-		if (board[i] == NULL){
-            printf("[ERROR] Out of memory whilst creating the board\n");
-            exit(EXIT_FAILURE);
-        }
+static void record_step(MetricsLog *metrics, unsigned long long generation, long long cells_alive,
+                        const StepCounts *counts, double n_stepped, const struct timespec *step_start){
+    // Post the metrics of a generation stepped since step_start, counts NULL for engines which do not count births
+    GenerationMetrics record = {generation, cells_alive, {-1, -1, 0, -1, 0, -1}, n_stepped, 0, 0};
+    if (counts != NULL){
+        record.counts = *counts;
     }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record.step_ns = (long long)(now.tv_sec - step_start->tv_sec) * 1000000000LL + (now.tv_nsec - step_start->tv_nsec);
+    post_metrics(metrics, &record);
+}
 
-    // Fill the board with dead cells to start with (n_neighbours also set to 0).
-    for (int i = 0; i < n_rows; i++){
-        for (int j = 0; j < n_cols; j++){
-                board[i][j].alive = DEAD; // Set all cells to be dead on declaration
-                board[i][j].n_alive_neighbrs = 0; // No neighbours
-        }
+static void check_resume(int id, const char *input, const SparsePlane *plane){
+    // Stop with an error unless the engine's load_cells takes the cells of the checkpoint (a plane, or a bit-packed
+    // board, which every engine takes)
+    if (plane != NULL && !engine_ops(id)->unbounded){
+        printf("[ERROR]: %s holds a sparse plane, which the %s engine cannot resume from\n", input, engine_name(id));
+        exit(EXIT_FAILURE);
     }
-    return board;
 }
 
-void calc_n_neighbours(Cell **board, int n_rows, int n_cols){
+static Engine* load_engine(int id, const char *input, const RandomGrid *random, int resume, BitBoard **resume_bb,
+                           SparsePlane **resume_plane, PatternInfo *info, int fixed_bounds, unsigned birth_mask,
+                           unsigned survive_mask, int n_states, ThreadPool *pool){
     /*
-    Calculate the 8 cell neighbourhood and update Cell.n_neighbours in place for the board.
-    Inputs: board - Double pointer to the board (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
+    Create an engine and read the board into it, from the checkpoint, the random board or the pattern file.
+    - The cells of a checkpoint already read are taken over (and resume_bb, resume_plane set to NULL), so only a
+      second engine reads it again
     */
-    for (int i = 0; i < n_rows; i++){ // loop over whole grid
-        for (int j = 0; j < n_cols; j++){
-            // Take 8 cell neighbourhood for each cell 'o' (applying the toroidal boundary conditions
-            //[1,2,3
-            // 4,o,5
-            // 6,7,8]
-            board[i][j].n_alive_neighbrs = 0 + board[down_coord(i,n_rows)][down_coord(j,n_cols)].alive // 1
-                        + board[i][down_coord(j,n_cols)].alive // 2
-                        + board[up_coord(i,n_rows)][down_coord(j,n_cols)].alive // 3
-                        + board[down_coord(i,n_rows)][j].alive // 4
-                        + board[up_coord(i,n_rows)][j].alive // 5
-                        + board[down_coord(i,n_rows)][up_coord(j,n_cols)].alive // 6
-                        + board[i][up_coord(j,n_cols)].alive // 7
-                        + board[up_coord(i,n_rows)][up_coord(j,n_cols)].alive; // 8
-        }
-	}
+    Engine *engine = create_engine(id, info, fixed_bounds, birth_mask, survive_mask, n_states);
+    if (resume){
+        if (*resume_bb == NULL && *resume_plane == NULL){
+            CheckpointInfo state;
+            read_checkpoint(input, &state, resume_bb, resume_plane);
+        }
+        engine->ops->load_cells(engine, *resume_bb, *resume_plane);
+        *resume_bb = NULL;
+        *resume_plane = NULL;
+    }else if (random != NULL){
+        BitBoard *bb = create_bitboard(random->n_rows, random->n_cols);
+        fill_bitboard_random(bb, random->seed, random->density, pool);
+        engine->ops->load_cells(engine, bb, NULL);
+    }else{
+        engine->ops->load(engine, input, info);
+    }
+    return engine;
 }
 
-void print_board(Cell **board, int n_rows, int n_cols){
+void run_headless(const char *input, const RandomGrid *random, int resume, const char *output, const char *checkpoint,
+                  long long checkpoint_every, const char *metrics_file, int fixed_bounds, int engine_id,
+                  int cross_check, int block, long long n_generations, int detect_cycles, unsigned birth_mask,
+                  unsigned survive_mask, int n_states, int rule_given, ThreadPool *pool){
     /*
-    Print the alive/dead state for the whole board to the console.
-    Inputs: board - Double pointer to the board (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
+    Run a board read from file for a number of generations as fast as possible, with no printing or delay in the loop.
+    Inputs: input - board or pattern file to read (see pattern_io.h for the formats)
+            random - random board to run instead of input (NULL to read input), toroidal unless other bounded
+                     boundary conditions are given
+            resume - 1 if input is a checkpoint to carry on from, with its boundary conditions, rule and generation
+            output - file to write the final board to (NULL to not save it), format from its extension
+            checkpoint - checkpoint file written every checkpoint_every generations and at the end (NULL for none)
+            metrics_file - CSV or Prometheus file the metrics of every generation are written to (NULL for none)
+            fixed_bounds - type of boundary conditions (0 toroidal, 1 fixed, INFINITE_BOUNDS, DEAD_BOUNDS,
+                           REFLECT_BOUNDS or KLEIN_BOUNDS), -1 for those in the file
+            engine_id - ENGINE_* used to step the board, ENGINE_DEFAULT for the fastest one for the boundary conditions
+            cross_check - ENGINE_* run side by side from the same start, -1 for none. The run stops with an error at
+                          the first generation where the two engines hold different cells (see compare_engines)
+            block - generations the engine advances per pass over the board (see step_bitboard_blocked), 1 for
+                    one at a time. Only for an engine that blocks (bitboard)
+            n_generations - number of generations to run
+            detect_cycles - 1 to look for the board repeating and skip whole periods once it does (board and
+                            bitboard engines, the final board is the same)
+            birth_mask, survive_mask - the game rule (see parse_rule)
+            n_states - number of states of a Generations rule (see parse_generations_rule), 2 for a Life-like rule
+            rule_given - 1 if the rule was chosen on the command line, 0 to take the rule in a RLE header instead
+            pool - threads used to update the board (declared by create_thread_pool)
+    - The pattern is read straight into the engine (see engine.h), without a board of Cells unless that is the engine
+    - Checkpoints are written by a background thread so the loop never waits for the disk, a checkpoint due while
+      the last one is still being written is skipped (see checkpoint.h). The last one is written before returning.
+    - Metrics are posted to a ring buffer emptied by another background thread (see metrics.h). The step is only
+      timed when they are recorded
+    - A cross-checked run steps one generation at a time (block at a time if blocked) and skips no cycles, and the
+      comparison is timed as well. A blocked run skips no cycles either, as the detector needs every generation
+    - Print generations per second and cell updates per second (cells stepped, for the unbounded engines the
+      cells in the chunks or the size of the board) once finished
+    - For the unbounded engines the board saved is the window onto the plane covered by the pattern file
     */
-    for (int i = 0; i < n_rows; i++){ // loop over rows and cols
-        for (int j = 0; j < n_cols; j++){
-            if (board[i][j].alive == ALIVE){ // If cell is alive print a 'o'
-                printf("o ");
-            }else if (board[i][j].alive == DEAD){ // If cell is dead print blank space
-                printf("  ");
-            }else{ // catch errors
-                printf("[ERROR] print_board - Encountered invalid value for board.alive");
+    PatternInfo info;
+    CheckpointInfo state; // resumed from, then updated for each checkpoint
+    BitBoard *bb = NULL; // cells of a checkpoint, until taken over by the engine
+    SparsePlane *plane = NULL;
+    char random_name[64]; // stands in for the file name of a random board
+    if (random != NULL){
+        snprintf(random_name, sizeof(random_name), "random board with seed %llu and density %g", random->seed, random->density);
+        input = random_name;
+    }
+    if (resume){
+        read_checkpoint(input, &state, &bb, &plane);
+        if (fixed_bounds != -1 && fixed_bounds != state.fixed_bounds){
+            printf("[WARNING]: %s keeps the boundary conditions it was run with\n", input);
+        }
+        fixed_bounds = state.fixed_bounds;
+        info.format = PATTERN_NATIVE;
+        info.n_rows = state.n_rows;
+        info.n_cols = state.n_cols;
+        info.row0 = state.row0;
+        info.col0 = state.col0;
+        info.fixed_bounds = state.fixed_bounds;
+        info.rule[0] = '\0';
+    }else if (random != NULL){
+        if (fixed_bounds == INFINITE_BOUNDS){
+            printf("[ERROR]: Random boards need torus, fixed, dead, reflect or klein boundary conditions\n");
+            exit(EXIT_FAILURE);
+        }
+        info.format = PATTERN_NATIVE;
+        info.n_rows = random->n_rows;
+        info.n_cols = random->n_cols;
+        info.row0 = info.col0 = 0;
+        info.fixed_bounds = fixed_bounds = (fixed_bounds == -1) ? 0 : fixed_bounds;
+        info.rule[0] = '\0';
+        state.generation = 0;
+    }else{
+        read_pattern_header(input, &info);
+        if (fixed_bounds == -1){
+            fixed_bounds = info.fixed_bounds;
+        }
+        state.generation = 0;
+    }
+    if (fixed_bounds < 0 || fixed_bounds >= N_BOUNDS){
+        printf("[ERROR]: Unknown boundary conditions %d in %s\n", fixed_bounds, input);
+        exit(EXIT_FAILURE);
+    }
+    char rule[RULE_STRING_LENGTH];
+    unsigned file_birth, file_survive; // rule in a RLE header
+    int file_states;
+    if (resume && (state.birth_mask != birth_mask || state.survive_mask != survive_mask)){
+        birth_mask = state.birth_mask;
+        survive_mask = state.survive_mask;
+        rule_string(birth_mask, survive_mask, rule);
+        printf("[WARNING]: %s was run with rule %s, carrying on with it\n", input, rule);
+    }else if (info.rule[0] != '\0' && !parse_generations_rule(info.rule, &file_birth, &file_survive, &file_states)){
+        printf("[WARNING]: %s asks for rule %s which is not a Life-like or Generations rule, ignoring it\n", input,
+               info.rule);
+    }else if (info.rule[0] != '\0' && !rule_given){
+        birth_mask = file_birth;
+        survive_mask = file_survive;
+        n_states = file_states;
+    }else if (info.rule[0] != '\0'
+              && (file_birth != birth_mask || file_survive != survive_mask || file_states != n_states)){
+        generations_rule_string(birth_mask, survive_mask, n_states, rule);
+        printf("[WARNING]: %s asks for rule %s, running with %s\n", input, info.rule, rule);
+    }
+    generations_rule_string(birth_mask, survive_mask, n_states, rule);
+
+    if (engine_id == ENGINE_DEFAULT){
+        engine_id = default_engine(fixed_bounds, n_states);
+    }
+    check_engine(engine_id, fixed_bounds, birth_mask, survive_mask, n_states, checkpoint != NULL);
+    if (cross_check >= 0){
+        check_engine(cross_check, fixed_bounds, birth_mask, survive_mask, n_states, 0);
+    }
+    if (resume){
+        check_resume(engine_id, input, plane);
+        if (cross_check >= 0){
+            check_resume(cross_check, input, plane);
+        }
+    }
+    if (block > 1 && !engine_ops(engine_id)->blocks){
+        printf("[ERROR]: The %s engine does not step in temporal blocks, use the bitboard engine\n",
+               engine_name(engine_id));
+        exit(EXIT_FAILURE);
+    }
+
+    // Read the pattern into the engines (not timed)
+    Engine *engine = load_engine(engine_id, input, random, resume, &bb, &plane, &info, fixed_bounds, birth_mask,
+                                 survive_mask, n_states, pool);
+    Engine *other = NULL; // engine run side by side for the cross-check
+    if (cross_check >= 0){
+        PatternInfo other_info = info;
+        other = load_engine(cross_check, input, random, resume, &bb, &plane, &other_info, fixed_bounds, birth_mask,
+                            survive_mask, n_states, pool);
+        other->count_changes = engine->count_changes = 1; // bounding box for compare_engines
+    }
+    engine->block = block;
+
+    state.fixed_bounds = fixed_bounds; // what every checkpoint saves besides the cells
+    state.birth_mask = birth_mask;
+    state.survive_mask = survive_mask;
+    state.n_rows = (int)info.n_rows;
+    state.n_cols = (int)info.n_cols;
+    state.row0 = info.row0;
+    state.col0 = info.col0;
+    unsigned long long first_generation = state.generation;
+    Checkpointer *cp = (checkpoint != NULL) ? create_checkpointer(checkpoint) : NULL;
+    int posted = 0; // 1 if the state after the last generation has been handed to the checkpoint writer
+    const BitBoard *snapshot_bb; // cells handed to the checkpoint writer
+    const SparsePlane *snapshot_plane;
+    CycleDetector *cd = NULL;
+    if (detect_cycles && other == NULL && block == 1 && engine->copy != NULL){ // only board and bitboard hash them
+        cd = create_cycle_detector((int)info.n_rows, (int)info.n_cols, fixed_bounds == 0);
+        engine->hashes = 1;
+    }
+    long long n_skipped = 0; // generations skipped once the board repeats
+    MetricsLog *metrics = (metrics_file != NULL) ? create_metrics_log(metrics_file) : NULL;
+    if (metrics != NULL){ // births and deaths are only counted when they are recorded
+        engine->count_changes = 1;
+    }
+    struct timespec step_start; // start of the step being recorded
+
+    long long cells_alive = engine->ops->population(engine);
+    long long batch = (engine->ops->leaps && other == NULL) ? n_generations : block; // generations in each step
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long long g = 0; g < n_generations; g += batch){
+        unsigned long long from = state.generation; // generation before the step
+        long long n_step = (n_generations - g < batch) ? n_generations - g : batch;
+        if (metrics != NULL){
+            clock_gettime(CLOCK_MONOTONIC, &step_start);
+        }
+        cells_alive = engine->ops->step(engine, n_step, pool);
+        state.generation += (unsigned long long)n_step;
+        if (metrics != NULL){
+            record_step(metrics, state.generation, cells_alive, engine->counts, engine->n_stepped, &step_start);
+        }
+        if (other != NULL){
+            other->ops->step(other, n_step, pool);
+            long long row, col;
+            if (!compare_engines(other, engine, &row, &col)){
+                printf("[ERROR]: The %s and %s engines diverge at generation %llu of %s: %lld and %lld cells alive",
+                       engine_name(cross_check), engine_name(engine_id), state.generation, input,
+                       other->ops->population(other), engine->ops->population(engine));
+                if (row >= 0){
+                    printf(", first difference at row %lld column %lld", row, col);
+                }
+                printf("\n");
                 exit(EXIT_FAILURE);
             }
         }
-        printf("\n");
-	}
-}
+        if (cd != NULL && !cd->found
+            && observe_generation(cd, (long long)state.generation, engine->hash, engine->shape, engine->copy,
+                                  engine->state)){
+            n_skipped = cycle_skip(cd, n_generations - g - 1);
+            g += n_skipped;
+            state.generation += (unsigned long long)n_skipped;
+        }
+        if (cp != NULL && state.generation / checkpoint_every != from / checkpoint_every){ // passed a checkpoint
+            engine->ops->snapshot(engine, &snapshot_bb, &snapshot_plane);
+            posted = post_checkpoint(cp, &state, snapshot_bb, snapshot_plane);
+        }else{
+            posted = 0;
+        }
+    }
+    double seconds = elapsed_seconds(&start);
+    if (seconds <= 0){
+        seconds = 1e-9;
+    }
 
-int update_board(Cell **board, int n_rows, int n_cols, int fixed_bounds,
-                 int death_overpop, int death_underpop, int birth_repro){
-    /*
-    Update the board based on the game rules. Return the number of living cells after update.
-    Inputs: board - Double pointer to the board (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
-            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries)
-            death_overpop - if number of neighbours greater than death_overpop cell dies due to overpopulation
-            death_underpop - if number of neighbours greater than death_underpop cell dies due to underpopulation
-            birth_repro - if number of neighbours equal to birth_repro cell becomes alive due to reproduction
-    - Call method to calculate number of neighbours for each cell
-    - Apply game rules to determine whether cell becomes alive or dead
-    - Return number of living cells
-    */
-    calc_n_neighbours(board,n_rows,n_cols); // Calculate the number of neighbours for each cell
-
-    int cells_alive = 0; // number of living cells on the board
-
-    for (int i = fixed_bounds; i < n_rows-fixed_bounds; i++){ // loop over board within applied boundary conditions
-        for (int j = fixed_bounds; j < n_cols-fixed_bounds; j++){
-
-            if (board[i][j].n_alive_neighbrs < death_underpop){ // overpopulation condition met
-                board[i][j].alive = DEAD; // cell dies
-            }else if (board[i][j].n_alive_neighbrs > death_overpop){ // underpopulation condition met
-                board[i][j].alive = DEAD; // cell dies
-            }else if (board[i][j].n_alive_neighbrs == birth_repro){ // reproduction condition met
-                board[i][j].alive = ALIVE; // cell becomes alive
-                cells_alive++; // add to living cell count
-            }else if (board[i][j].alive == ALIVE){ // no change but cell alive
-                cells_alive++; // add to living cell count
+    if (resume){
+        printf("Resumed %s at generation %llu\n", input, first_generation);
+    }
+    printf("Ran %lld generations of %s (%lldx%lld, %s, %s engine, %d threads) in %.3f s\n", n_generations, input,
+           info.n_rows, info.n_cols, rule, engine_name(engine_id), (pool != NULL) ? pool->n_threads : 1, seconds);
+    printf("%.1f generations/s, %.4g cell updates/s\n", n_generations / seconds, engine->cell_updates / seconds);
+    printf("%lld cells alive\n", cells_alive);
+    if (other != NULL){
+        if (batch > 1){
+            printf("Cross-checked against the %s engine every %lld generations, no differences\n",
+                   engine_name(cross_check), batch);
+        }else{
+            printf("Cross-checked against the %s engine every generation, no differences\n", engine_name(cross_check));
+        }
+        free_engine(other);
+    }
+    if (cd != NULL){
+        if (cd->found){
+            if (cd->period == 1){
+                printf("Board still from generation %lld", cd->start);
+            }else{
+                printf("Board repeats every %lld generations from generation %lld", cd->period, cd->start);
+            }
+            if (cd->shift_rows != 0 || cd->shift_cols != 0){
+                printf(", moving %d rows and %d columns each period (back in place every %lld)", cd->shift_rows,
+                       cd->shift_cols, cd->full_period);
             }
+            printf("\n%lld generations skipped\n", n_skipped);
+        }
+        free_cycle_detector(cd);
+    }
+    if (metrics != NULL){
+        unsigned long long n_dropped = atomic_load(&metrics->n_dropped);
+        unsigned long long n_recorded = free_metrics_log(metrics);
+        printf("Metrics of %llu generations written to %s (%llu dropped)\n", n_recorded, metrics_file, n_dropped);
+        if (n_dropped > 0){
+            printf("[WARNING]: %llu metrics records were dropped as the writer fell behind\n", n_dropped);
+        }
+    }
+
+    if (cp != NULL){ // wait for the writer, then save the final state unless it is already being written
+        unsigned long n_cp_skipped = cp->n_skipped; // checkpoints skipped while the last was written
+        unsigned long n_written = free_checkpointer(cp);
+        if (!posted){
+            engine->ops->snapshot(engine, &snapshot_bb, &snapshot_plane);
+            write_checkpoint(checkpoint, &state, snapshot_bb, snapshot_plane);
+            n_written++;
         }
+        printf("Checkpoint %s at generation %llu (%lu written, %lu skipped while writing)\n", checkpoint,
+               state.generation, n_written, n_cp_skipped);
     }
-    return cells_alive;
+    if (output != NULL){ // for the unbounded engines the window of the plane covered by the pattern file
+        engine->ops->save(engine, output);
+    }
+    free_engine(engine);
 }
 
-void add_living_cell(Cell **board, int n_rows, int n_cols, int x, int y){
+void run_soups(SoupSearch *search, const char *census_file, ThreadPool *pool){
     /*
-    Add a living cell to the grid inplace.
-    Inputs: board - Double pointer to the board (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
-            x, y - coords of living cell to add
-    - Checks to ensure coords of cell don't overflow board
-    - Add living cell in place
+    Run a soup search and report its speed and census.
+    Inputs: search - settings of the search (see soup.h)
+            census_file - CSV file to write the census to, NULL to print it
+            pool - threads to run soups on (declared by create_thread_pool)
     */
-    x -= 1; y -= 1; // decrement x and y to 'natural' coords starting from 1 as passed by user (indices of array start from 0)
-
-    if (x >= 0 && x < n_rows && y >= 0 && y < n_cols){ // Error check that coords within bounds of board
-        board[x][y].alive = ALIVE; // make cell at coords alive.
+    char rule[RULE_STRING_LENGTH];
+    rule_string(search->birth_mask, search->survive_mask, rule);
+    run_soup_search(search, pool);
+    double seconds = (search->seconds > 0) ? search->seconds : 1e-9;
+
+    printf("Ran %lld soups of %dx%d (%s, seed %llu, %d threads) in %.3f s\n", search->n_soups, search->soup_size,
+           search->soup_size, rule, search->seed, (pool != NULL) ? pool->n_threads : 1, seconds);
+    printf("%.1f soups/s, %.4g generations/s\n", search->n_soups / seconds, search->n_generations / seconds);
+    printf("%lld objects of %zu kinds, %lld soups unstable after %lld generations\n",
+           search->census->n_objects - search->n_unstable, search->census->n_entries - (search->n_unstable > 0),
+           search->n_unstable, search->max_generations);
+    if (census_file != NULL){
+        FILE *file = fopen(census_file, "w");
+        if (file == NULL){
+            printf("[ERROR]: Census file %s could not be opened\n", census_file);
+            exit(EXIT_FAILURE);
+        }
+        write_census(search->census, file);
+        fclose(file);
+        printf("Census written to %s\n", census_file);
     }else{
-        printf("[ERROR] add_living_cell - Overflow error: coords exceed size of grid\n");
+        write_census(search->census, stdout);
     }
+    free_census(search->census);
 }
 
 int get_n_elements(void){
@@ -480,79 +1177,6 @@ int get_n_elements(void){
     return n;
 }
 
-int up_coord(int coord, int bound){
-    // Introduce periodic boundary conditions: create mapping such that x and y are wrapped toroidally.
-    if (coord +1 > bound -1){ // if coords exceed grid return coord as zero
-        return 0;
-    }else{
-        return coord+1; // otherwise increment the coord
-    }
-}
-
-int down_coord(int coord, int bound){
-    // Introduce periodic boundary conditions: create mapping such that x and y are wrapped toroidally.
-    if (coord -1 < 0){ // if coords exceed grid return coord as the boundary
-        return bound -1;
-    }else{
-        return coord-1; // otherwise decrement the coord
-    }
-}
-
-void free_board(Cell **board, int n_rows, int n_cols){
-    /*
-    Free the dynamically allocated memory for the board.
-    Inputs: Double pointer to the board (declared by create_board), n_rows and n_cols of board.
-    */
-	for (int i = 0; i < n_rows; ++i) // free each element then free up structure
-        free(board[i]);
-    free(board);
-}
-
-void delay(int milli_seconds) {
-    // function using the clock function in <time.h> to create a delay to 'animate' progression
-    clock_t start_time = clock(); // store start time
-    while (clock() < start_time + milli_seconds); // looping until required time is achieved
-}
-
-void save_board(Cell **board, int n_rows, int n_cols, int fixed_bounds){
-   /*
-    Ask user whether they want to save the current alive/dead state of cells
-    Save board state to the file given by CUSTOM_BOARD_FILE with corresponding header.
-    Inputs: board - Double pointer to the board (declared by create_board)
-            n_rows, n_cols - number of rows and columns of board.
-            fixed_bounds - type of boundary conditions (1 for fixed boundaries, 0 for toroidal boundaries)
-    */
-    int save = -1; // flag
-
-    printf("\nWould you like to save the board?\n");
-    printf("\t1: Yes\n");
-    printf("\t0: No\n");
-    scanf("%d",&save); // Take user input
-
-    if (save == 1){
-        printf("Saving grid to %s\n",CUSTOM_BOARD_FILE);
-        FILE *file = fopen(CUSTOM_BOARD_FILE, "w"); // open file
-
-        if (file == NULL){ // error check file found
-                printf("[ERROR]: Save file %s does not exists\n",CUSTOM_BOARD_FILE);
-                exit(EXIT_FAILURE);
-        }
-        fprintf(file, "n_rows:%d, n_cols:%d, fixed_bounds:%d\n",n_rows,n_cols,fixed_bounds); // print header row
-        for (int i = 0; i < n_rows; i++){
-            for (int j = 0; j < n_cols; j++){
-                fprintf(file,"%d",board[i][j].alive); // print states to file
-            }
-            fprintf(file,"\n");
-        }
-        fclose(file); // close the file
-        printf("Save successful");
-
-    }else if(save != 0){ // Invalid selection
-        printf("[ERROR] Please choose an option from the menu");
-        exit(EXIT_FAILURE);
-    }
-}
-
 /* DEMONSTRATION OF PROGRAM OUTPUTS
 - PLEASE CLONE FROM GITHUB TO TEST FOR YOURSELF!
 - https://github.com/ljhowell/conways_game_of_life
@@ -763,12 +1387,16 @@ Select Gamemode:
 4
 Select game rules
 
-Select Game Rules for n neighbours:
-        1: Classic Rules: Overpopulation: n > 3, Underpopulation: n < 2, Reproduction n = 3
-        2: Custom Rules 1: Overpopulation: n > 6, Underpopulation: n < 3, Reproduction n = 4
-        3: Custom Rules 2: Overpopulation: n > 4, Underpopulation: n < 2, Reproduction n = 3
+Select Game Rules (B: neighbours for a dead cell to become alive, S: for a living cell to survive):
+        1: Classic Rules: B3/S23
+        2: Custom Rules 1: B5/S3456
+        3: Custom Rules 2: B3/S234
+        4: HighLife: B36/S23
+        5: Day & Night: B3678/S34678
+        6: Seeds: B2/S
+        7: Enter a rule, e.g. B36/S23
 3
-Overpopulation: n > 4, Underpopulation: n < 2, Reproduction n = 3
+Rule B3/S234
 
 ///// With this rule, strange maze like grids form
 
@@ -0,0 +1,232 @@
+/*
+* Per-generation metrics for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ The ring buffer has one writer of each end. The stepping loop fills slot head % METRICS_CAPACITY then publishes
+ it by advancing head with a release store; the writer thread reads head with an acquire load, so every slot
+ before head is complete when it reads it, and hands slots back by advancing tail the same way. Neither side
+ ever waits for the other. Once the ring is half full the stepping loop wakes the writer with a trylock, which
+ only fails while the writer holds the lock, and so is awake anyway.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "metrics.h"
+
+static void write_csv_record(FILE *file, const GenerationMetrics *m){
+    // One CSV line for a generation, the bounding box columns are left empty when there are no living cells
+    fprintf(file, "%llu,%lld,%lld,%lld,", m->generation, m->population, m->counts.births, m->counts.deaths);
+    if (m->counts.min_row <= m->counts.max_row){
+        fprintf(file, "%lld,%lld,%lld,%lld,", m->counts.min_row, m->counts.max_row, m->counts.min_col,
+                m->counts.max_col);
+    }else{
+        fprintf(file, ",,,,");
+    }
+    fprintf(file, "%.0f,%lld,%llu\n", m->n_stepped, m->step_ns, m->n_dropped);
+}
+
+static void write_prometheus(const MetricsLog *log, unsigned long long n_records){
+    /*
+    Rewrite the Prometheus text file with the latest record and the running totals.
+    - Written to path.tmp then renamed over path, so a scraper always reads a whole file
+    */
+    size_t length = strlen(log->path);
+    char *tmp_path = (char *)malloc(length + 5);
+    if (tmp_path == NULL){
+        printf("[ERROR] Out of memory whilst writing metrics\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(tmp_path, log->path, length);
+    memcpy(tmp_path + length, ".tmp", 5);
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL){
+        printf("[ERROR]: Metrics file %s could not be opened\n", tmp_path);
+        exit(EXIT_FAILURE);
+    }
+
+    const GenerationMetrics *m = &log->last;
+    fprintf(file, "# HELP conway_generation Generation reached.\n# TYPE conway_generation counter\n");
+    fprintf(file, "conway_generation %llu\n", m->generation);
+    fprintf(file, "# HELP conway_population Living cells.\n# TYPE conway_population gauge\n");
+    fprintf(file, "conway_population %lld\n", m->population);
+    if (m->counts.births >= 0){
+        fprintf(file, "# HELP conway_births_total Cells born.\n# TYPE conway_births_total counter\n");
+        fprintf(file, "conway_births_total %lld\n", log->total_births);
+        fprintf(file, "# HELP conway_deaths_total Cells died.\n# TYPE conway_deaths_total counter\n");
+        fprintf(file, "conway_deaths_total %lld\n", log->total_deaths);
+    }
+    if (m->counts.min_row <= m->counts.max_row){
+        fprintf(file, "# HELP conway_bounding_box Bounding box of the living cells.\n# TYPE conway_bounding_box gauge\n");
+        fprintf(file, "conway_bounding_box{edge=\"min_row\"} %lld\n", m->counts.min_row);
+        fprintf(file, "conway_bounding_box{edge=\"max_row\"} %lld\n", m->counts.max_row);
+        fprintf(file, "conway_bounding_box{edge=\"min_col\"} %lld\n", m->counts.min_col);
+        fprintf(file, "conway_bounding_box{edge=\"max_col\"} %lld\n", m->counts.max_col);
+    }
+    fprintf(file, "# HELP conway_cells_stepped Cells calculated in the last generation.\n");
+    fprintf(file, "# TYPE conway_cells_stepped gauge\nconway_cells_stepped %.0f\n", m->n_stepped);
+    fprintf(file, "# HELP conway_step_seconds Time of the last step.\n# TYPE conway_step_seconds gauge\n");
+    fprintf(file, "conway_step_seconds %.9f\n", 1e-9*m->step_ns);
+    fprintf(file, "# HELP conway_step_seconds_max Slowest step.\n# TYPE conway_step_seconds_max gauge\n");
+    fprintf(file, "conway_step_seconds_max %.9f\n", 1e-9*log->max_step_ns);
+    fprintf(file, "# HELP conway_step_seconds_total Time spent stepping.\n# TYPE conway_step_seconds_total counter\n");
+    fprintf(file, "conway_step_seconds_total %.9f\n", log->total_seconds);
+    fprintf(file, "# HELP conway_metrics_records_total Generations recorded.\n");
+    fprintf(file, "# TYPE conway_metrics_records_total counter\nconway_metrics_records_total %llu\n", n_records);
+    fprintf(file, "# HELP conway_metrics_dropped_total Records dropped because the ring buffer was full.\n");
+    fprintf(file, "# TYPE conway_metrics_dropped_total counter\nconway_metrics_dropped_total %llu\n",
+            atomic_load_explicit(&log->n_dropped, memory_order_relaxed));
+
+    if (fclose(file) != 0 || rename(tmp_path, log->path) != 0){
+        printf("[ERROR]: Metrics file %s could not be written\n", log->path);
+        exit(EXIT_FAILURE);
+    }
+    free(tmp_path);
+}
+
+static void flush_metrics(MetricsLog *log){
+    // Write out every record posted so far and hand their slots back to the stepping loop
+    unsigned long long tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+    unsigned long long head = atomic_load_explicit(&log->head, memory_order_acquire);
+    if (head == tail){
+        return;
+    }
+    for (; tail < head; tail++){
+        const GenerationMetrics *m = &log->ring[tail % METRICS_CAPACITY];
+        if (log->format == METRICS_CSV){
+            write_csv_record(log->file, m);
+        }else{
+            log->last = *m;
+            if (m->counts.births >= 0){
+                log->total_births += m->counts.births;
+                log->total_deaths += m->counts.deaths;
+            }
+            log->total_seconds += 1e-9*m->step_ns;
+            log->max_step_ns = (m->step_ns > log->max_step_ns) ? m->step_ns : log->max_step_ns;
+        }
+        atomic_store_explicit(&log->tail, tail + 1, memory_order_release); // slot can be reused
+    }
+    if (log->format == METRICS_CSV){
+        fflush(log->file);
+    }else{
+        write_prometheus(log, head);
+    }
+}
+
+static void* writer_main(void *arg){
+    // Flush the ring buffer every METRICS_FLUSH_MS milliseconds, or when woken for a half full ring, until told to
+    // quit, then flush what is left
+    MetricsLog *log = (MetricsLog *)arg;
+    pthread_mutex_lock(&log->lock);
+    while (!log->quit){
+        struct timespec wake_at;
+        clock_gettime(CLOCK_REALTIME, &wake_at);
+        wake_at.tv_nsec += METRICS_FLUSH_MS * 1000000L;
+        wake_at.tv_sec += wake_at.tv_nsec / 1000000000L;
+        wake_at.tv_nsec %= 1000000000L;
+        while (!log->quit && !atomic_load(&log->woken)
+               && pthread_cond_timedwait(&log->wake, &log->lock, &wake_at) == 0){
+            // woken for nothing (spuriously), wait on
+        }
+        atomic_store(&log->woken, 0); // the loop may wake the writer again once this flush is behind it
+        pthread_mutex_unlock(&log->lock);
+
+        flush_metrics(log);
+
+        pthread_mutex_lock(&log->lock);
+    }
+    pthread_mutex_unlock(&log->lock);
+    flush_metrics(log); // records posted before quit was set
+    return NULL;
+}
+
+MetricsLog* create_metrics_log(const char *path){
+    /*
+    Start a background thread writing metrics to path, as Prometheus text if it ends in .prom and CSV otherwise.
+    - Error checks for memory, the file and thread creation
+    */
+    MetricsLog *log = (MetricsLog *)malloc(sizeof(MetricsLog));
+    if (log == NULL || (log->path = strdup(path)) == NULL
+        || (log->ring = (GenerationMetrics *)malloc(METRICS_CAPACITY * sizeof(GenerationMetrics))) == NULL){
+        printf("[ERROR] Out of memory whilst creating the metrics log\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t length = strlen(path);
+    log->format = (length >= 5 && strcmp(path + length - 5, ".prom") == 0) ? METRICS_PROMETHEUS : METRICS_CSV;
+    log->file = NULL;
+    if (log->format == METRICS_CSV){
+        log->file = fopen(path, "w");
+        if (log->file == NULL){
+            printf("[ERROR]: Metrics file %s could not be opened\n", path);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(log->file, "generation,population,births,deaths,min_row,max_row,min_col,max_col,cells_stepped,step_ns,"
+                           "dropped\n");
+    }
+    atomic_init(&log->head, 0);
+    atomic_init(&log->tail, 0);
+    atomic_init(&log->n_dropped, 0);
+    memset(&log->last, 0, sizeof(log->last));
+    log->total_births = log->total_deaths = 0;
+    log->total_seconds = 0;
+    log->max_step_ns = 0;
+    log->quit = 0;
+    atomic_init(&log->woken, 0);
+    pthread_mutex_init(&log->lock, NULL);
+    pthread_cond_init(&log->wake, NULL);
+    if (pthread_create(&log->writer, NULL, writer_main, log) != 0){
+        printf("[ERROR] Could not start the metrics writer thread\n");
+        exit(EXIT_FAILURE);
+    }
+    return log;
+}
+
+void post_metrics(MetricsLog *log, const GenerationMetrics *record){
+    /*
+    Hand the record of a generation to the writer thread.
+    Inputs: log - metrics log (declared by create_metrics_log)
+            record - what to record about the generation
+    - Only the stepping loop may call this. It never waits for a lock or for the disk: if the writer has fallen
+      a whole ring behind the record is dropped and counted instead
+    - Once the ring is half full the writer is woken, if its lock is free, rather than left to its timer
+    */
+    unsigned long long head = atomic_load_explicit(&log->head, memory_order_relaxed);
+    unsigned long long tail = atomic_load_explicit(&log->tail, memory_order_acquire);
+    if (head - tail >= METRICS_CAPACITY){
+        atomic_fetch_add_explicit(&log->n_dropped, 1, memory_order_relaxed);
+        return;
+    }
+    GenerationMetrics *slot = &log->ring[head % METRICS_CAPACITY];
+    *slot = *record;
+    slot->n_dropped = atomic_load_explicit(&log->n_dropped, memory_order_relaxed);
+    atomic_store_explicit(&log->head, head + 1, memory_order_release); // publish the record
+    if (head + 1 - tail >= METRICS_CAPACITY/2 && !atomic_load_explicit(&log->woken, memory_order_relaxed)
+        && pthread_mutex_trylock(&log->lock) == 0){
+        atomic_store(&log->woken, 1);
+        pthread_cond_signal(&log->wake);
+        pthread_mutex_unlock(&log->lock);
+    }
+}
+
+unsigned long long free_metrics_log(MetricsLog *log){
+    // Stop the writer thread once it has written every record posted, and free the log. Return the number written.
+    pthread_mutex_lock(&log->lock);
+    log->quit = 1;
+    pthread_cond_signal(&log->wake);
+    pthread_mutex_unlock(&log->lock);
+    pthread_join(log->writer, NULL);
+    pthread_mutex_destroy(&log->lock);
+    pthread_cond_destroy(&log->wake);
+    if (log->file != NULL){
+        fclose(log->file);
+    }
+    unsigned long long n_written = atomic_load(&log->tail);
+    free(log->ring);
+    free(log->path);
+    free(log);
+    return n_written;
+}
@@ -0,0 +1,70 @@
+/*
+* Per-generation metrics for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Records the population, births, deaths, bounding box, cells stepped and step time of every generation
+              of a headless run, cheaply enough to be left on.
+                - The counts come from the update pass itself (see StepCounts), the time from the monotonic clock
+                - The stepping loop posts each record into a lock-free single producer, single consumer ring
+                  buffer and carries on. It never takes a lock or waits: if the ring is full the record is dropped
+                  and counted
+                - A background thread empties the ring every METRICS_FLUSH_MS milliseconds, or as soon as the
+                  stepping loop finds the ring half full (it signals the writer if it can take the lock without
+                  waiting). A CSV file gets one line per generation, with the records dropped so far, so any gap
+                  in the generations shows. A Prometheus text file (extension .prom) is rewritten with the latest
+                  values and running totals, through a temporary file renamed over the old one so a scraper never
+                  reads half of it
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "conway.h"
+
+#define METRICS_CAPACITY 8192 // Records the ring buffer holds (power of 2)
+#define METRICS_FLUSH_MS 250 // Milliseconds between flushes of the ring buffer by the writer thread
+#define METRICS_CSV 0 // one line per generation
+#define METRICS_PROMETHEUS 1 // latest values and totals in the Prometheus text format
+
+// Define a structure with alias 'GenerationMetrics' for what is recorded about one generation
+typedef struct generation_metrics{
+    unsigned long long generation; // generation reached by the step
+    long long population; // living cells
+    StepCounts counts; // births, deaths and bounding box (births and deaths -1 and no box if the engine does not count them)
+    double n_stepped; // cells the engine calculated (active tiles, the whole board or the allocated chunks)
+    long long step_ns; // wall time of the step in nanoseconds
+    unsigned long long n_dropped; // records dropped before this one (set by post_metrics)
+}GenerationMetrics;
+
+// Define a structure with alias 'MetricsLog' for the ring buffer of records and the thread writing them out
+typedef struct metrics_log{
+    char *path; // CSV or Prometheus file
+    int format; // METRICS_CSV or METRICS_PROMETHEUS
+    FILE *file; // open CSV file (NULL for Prometheus)
+    GenerationMetrics *ring; // METRICS_CAPACITY records, record k in slot k % METRICS_CAPACITY
+    atomic_ullong head; // records posted, only advanced by the stepping loop
+    atomic_ullong tail; // records written, only advanced by the writer thread
+    atomic_ullong n_dropped; // records lost because the ring was full
+    pthread_t writer;
+    pthread_mutex_t lock; // only guards quit and waking the writer early
+    pthread_cond_t wake;
+    int quit;
+    atomic_int woken; // 1 once the stepping loop has woken the writer for a half full ring, until it flushes
+    GenerationMetrics last; // latest record written (Prometheus)
+    long long total_births, total_deaths; // running totals over the records written (Prometheus)
+    double total_seconds; // step time over the records written (Prometheus)
+    long long max_step_ns; // slowest step written (Prometheus)
+}MetricsLog;
+
+// Prototype function definitions
+MetricsLog* create_metrics_log(const char *path); // format from the extension, starts the writer thread
+void post_metrics(MetricsLog *log, const GenerationMetrics *record); // never blocks, drops the record if full
+unsigned long long free_metrics_log(MetricsLog *log); // writes what is left, returns the number of records written
+
+#endif // METRICS_H
@@ -0,0 +1,805 @@
+/*
+* Pattern file reading and writing for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ The file is memory-mapped read-only (or read into memory when it cannot be mapped, e.g. a pipe) and parsed straight
+ from the mapping. The parsers never look past the end of the mapping, so the file need not end in a newline.
+ Formats with the board size in a header are read in one pass. For Life 1.06 and plaintext files the size is only
+ known once every cell has been seen, so read_pattern makes a first pass to find the bounding box (which is cheap, as
+ the pages are then in the page cache) before filling the board.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pattern_io.h"
+#include "rules.h"
+
+#define OUT_BUFFER_SIZE (1 << 16) // bytes written to the file at once
+#define RLE_LINE_LENGTH 70 // longest line written to a RLE file
+
+// Define a structure with alias 'MappedFile' for the contents of a file being read
+typedef struct mapped_file{
+    const char *data;
+    size_t size;
+    int is_mapped; // 1 if data is a mapping, 0 if it was read into memory
+}MappedFile;
+
+static void map_file(const char *filename, MappedFile *file){
+    /*
+    Map a file into memory, or read it into memory if it cannot be mapped.
+    - Error checks that the file exists and for memory
+    */
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        printf("[ERROR]: File %s does not exist\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    struct stat st;
+    file->data = NULL;
+    file->size = 0;
+    file->is_mapped = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED){
+            madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL); // read ahead, the file is parsed front to back
+            file->data = (const char *)data;
+            file->size = (size_t)st.st_size;
+            file->is_mapped = 1;
+        }
+    }
+    if (!file->is_mapped){ // not a regular file (or empty), read it in blocks
+        size_t capacity = 0;
+        char *data = NULL;
+        ssize_t n_read;
+        do{
+            if (file->size + OUT_BUFFER_SIZE > capacity){
+                capacity = 2*capacity + OUT_BUFFER_SIZE;
+                data = (char *)realloc(data, capacity);
+                if (data == NULL){
+                    printf("[ERROR] Out of memory whilst reading %s\n", filename);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            n_read = read(fd, data + file->size, OUT_BUFFER_SIZE);
+            if (n_read > 0){
+                file->size += (size_t)n_read;
+            }
+        }while (n_read > 0);
+        file->data = data;
+    }
+    close(fd);
+}
+
+static void unmap_file(MappedFile *file){
+    // Release the contents of a file
+    if (file->is_mapped){
+        munmap((void *)file->data, file->size);
+    }else{
+        free((void *)file->data);
+    }
+}
+
+int pattern_format(const char *filename){
+    // Return the PATTERN_* format for the extension of filename, -1 if it is not known
+    const char *dot = strrchr(filename, '.');
+    if (dot == NULL){
+        return -1;
+    }else if (strcmp(dot, ".rle") == 0 || strcmp(dot, ".RLE") == 0){
+        return PATTERN_RLE;
+    }else if (strcmp(dot, ".lif") == 0 || strcmp(dot, ".life") == 0 || strcmp(dot, ".LIF") == 0){
+        return PATTERN_LIFE106;
+    }else if (strcmp(dot, ".cells") == 0){
+        return PATTERN_CELLS;
+    }else if (strcmp(dot, ".txt") == 0){
+        return PATTERN_NATIVE;
+    }
+    return -1;
+}
+
+static int sniff_format(const MappedFile *file){
+    // Guess the format of a file with an unknown extension from the start of its contents
+    const char *p = file->data, *end = file->data + file->size;
+    if (end - p >= 10 && strncmp(p, "#Life 1.06", 10) == 0){
+        return PATTERN_LIFE106;
+    }else if (end - p >= 7 && strncmp(p, "n_rows:", 7) == 0){
+        return PATTERN_NATIVE;
+    }else if (p < end && (*p == '!' || *p == '.' || *p == 'O')){
+        return PATTERN_CELLS;
+    }
+    return PATTERN_RLE; // '#' comment lines or the "x = " header
+}
+
+static const char* next_line(const char *p, const char *end){
+    // Return the start of the line after the one p is in
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return (newline != NULL) ? newline + 1 : end;
+}
+
+static const char* skip_spaces(const char *p, const char *end){
+    // Skip spaces and tabs (not newlines)
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')){
+        p++;
+    }
+    return p;
+}
+
+static int parse_number(const char **p, const char *end, long long *value){
+    // Read a (possibly negative) decimal integer at *p and move past it. Return 0 if there is no number there
+    const char *q = skip_spaces(*p, end);
+    int negative = 0;
+    if (q < end && (*q == '-' || *q == '+')){
+        negative = (*q == '-');
+        q++;
+    }
+    if (q == end || *q < '0' || *q > '9'){
+        return 0;
+    }
+    long long n = 0;
+    while (q < end && *q >= '0' && *q <= '9'){
+        n = 10*n + (*q - '0');
+        q++;
+    }
+    *value = negative ? -n : n;
+    *p = q;
+    return 1;
+}
+
+static int expect(const char **p, const char *end, const char *text){
+    // Move past text (after any spaces) if it is at *p. Return 0 if it is not there
+    const char *q = skip_spaces(*p, end);
+    size_t n = strlen(text);
+    if ((size_t)(end - q) < n || strncmp(q, text, n) != 0){
+        return 0;
+    }
+    *p = q + n;
+    return 1;
+}
+
+// Bounding box of the living cells seen by a parse, and the sink the runs are passed on to
+typedef struct bounds{
+    long long min_row, max_row, min_col, max_col;
+    RunSink sink; // NULL to only find the bounding box
+    void *arg;
+}Bounds;
+
+static void bounds_sink(void *arg, long long row, long long col, long long length){
+    // RunSink growing the bounding box to fit each run before passing it on
+    Bounds *b = (Bounds *)arg;
+    if (row < b->min_row) b->min_row = row;
+    if (row > b->max_row) b->max_row = row;
+    if (col < b->min_col) b->min_col = col;
+    if (col + length - 1 > b->max_col) b->max_col = col + length - 1;
+    if (b->sink != NULL){
+        b->sink(b->arg, row, col, length);
+    }
+}
+
+static int parse_header(const MappedFile *file, PatternInfo *info, const char **body){
+    /*
+    Read the header of a file (format already set in info). Return 1 if the header gives the board size.
+    Sets *body to the first character after the header and comment lines.
+    */
+    const char *p = file->data, *end = file->data + file->size;
+    info->row0 = info->col0 = 0;
+    info->n_rows = info->n_cols = 0;
+    info->fixed_bounds = INFINITE_BOUNDS;
+    info->rule[0] = '\0';
+    info->cells_alive = 0;
+
+    switch (info->format){
+        case PATTERN_NATIVE:{
+            long long n_rows, n_cols, fixed_bounds;
+            if (!expect(&p, end, "n_rows:") || !parse_number(&p, end, &n_rows) || !expect(&p, end, ", n_cols:")
+                || !parse_number(&p, end, &n_cols) || !expect(&p, end, ", fixed_bounds:")
+                || !parse_number(&p, end, &fixed_bounds)){
+                printf("[ERROR]: Grid size header missing from file. Specify as n_rows,n_columns"); // Error if header missing
+                exit(EXIT_FAILURE);
+            }
+            info->n_rows = n_rows;
+            info->n_cols = n_cols;
+            info->fixed_bounds = (int)fixed_bounds;
+            *body = p; // the newline ending the header starts the first row
+            return 1;
+        }case PATTERN_RLE:{
+            while (p < end && *p == '#'){ // comment lines
+                p = next_line(p, end);
+            }
+            long long x, y;
+            const char *q = p;
+            if (!expect(&q, end, "x") || !expect(&q, end, "=") || !parse_number(&q, end, &x)
+                || !expect(&q, end, ",") || !expect(&q, end, "y") || !expect(&q, end, "=") || !parse_number(&q, end, &y)){
+                *body = p; // no header, the size comes from the cells
+                return 0;
+            }
+            info->n_rows = y;
+            info->n_cols = x;
+            if (expect(&q, end, ",") && expect(&q, end, "rule") && expect(&q, end, "=")){
+                q = skip_spaces(q, end);
+                size_t n = 0;
+                while (q < end && *q != '\n' && *q != '\r' && *q != ' ' && *q != ':' && n+1 < PATTERN_RULE_LENGTH){
+                    info->rule[n++] = *q++;
+                }
+                info->rule[n] = '\0';
+                long long width, height; // Golly bounded grid (see topology_suffix), the pattern is centred on it
+                int topology = expect(&q, end, ":T") ? 0 : expect(&q, end, ":P") ? DEAD_BOUNDS
+                             : expect(&q, end, ":K") ? KLEIN_BOUNDS : -1;
+                if (topology >= 0 && parse_number(&q, end, &width) && (topology != KLEIN_BOUNDS || expect(&q, end, "*"))
+                    && expect(&q, end, ",") && parse_number(&q, end, &height)){
+                    info->fixed_bounds = topology;
+                    info->row0 = -(height - y) / 2;
+                    info->col0 = -(width - x) / 2;
+                    info->n_rows = height;
+                    info->n_cols = width;
+                }
+            }
+            *body = next_line(q, end);
+            return 1;
+        }default:{ // Life 1.06 and plaintext only have comment lines
+            *body = p;
+            return 0;
+        }
+    }
+}
+
+static void parse_body(const MappedFile *file, const char *p, PatternInfo *info, RunSink sink, void *arg){
+    // Parse the cells after the header, handing every run of living cells to sink and counting the living cells
+    const char *end = file->data + file->size;
+    long long row = 0, col = 0;
+    info->run_state = 1;
+
+    switch (info->format){
+        case PATTERN_NATIVE:{
+            row = -1; // the header's newline starts row 0
+            while (p < end){
+                char c = *p++;
+                if (c == NEWLINE_CHAR){
+                    row++;
+                    col = 0;
+                }else if (c == '\r'){
+                    continue;
+                }else if (c != '0' && c != '1'){
+                    printf("\n[ERROR]: Anomalous value in file. Ensure that only 0's and 1's are in the board file");
+                    exit(EXIT_FAILURE);
+                }else if (row < 0 || row >= info->n_rows || col >= info->n_cols){
+                    printf("\n[ERROR]: Read grid from file failed, dimensions (%lld,%lld) exceed those specified in the file header (%lld,%lld)",
+                           row, col, info->n_rows, info->n_cols);
+                    exit(EXIT_FAILURE);
+                }else if (c == '1'){
+                    long long length = 1;
+                    while (p < end && *p == '1' && col + length < info->n_cols){
+                        p++;
+                        length++;
+                    }
+                    sink(arg, row, col, length);
+                    info->cells_alive += length;
+                    col += length;
+                }else{
+                    col++;
+                }
+            }
+            break;
+        }case PATTERN_RLE:{
+            long long count = 0; // run count before a tag, 0 for 1
+            while (p < end){
+                char c = *p++;
+                if (c >= '0' && c <= '9'){
+                    count = 10*count + (c - '0');
+                    continue;
+                }
+                long long n = (count > 0) ? count : 1;
+                if (c == 'b' || c == '.'){ // dead cells
+                    col += n;
+                }else if (c == 'o' || (c >= 'A' && c <= 'X')){ // living cells (any live state of a multi-state rule)
+                    info->run_state = (c == 'o') ? 1 : c - 'A' + 1;
+                    sink(arg, row, col, n);
+                    info->cells_alive += n;
+                    col += n;
+                }else if (c == '$'){ // end of n rows
+                    row += n;
+                    col = 0;
+                }else if (c == '!'){ // end of pattern
+                    break;
+                }else if (c == '#' && count == 0 && (p == file->data + 1 || p[-2] == '\n')){ // comment line
+                    p = next_line(p, end);
+                }else if (c >= 'p' && c <= 'y'){ // prefix of states 25 and up, more than a nibble holds
+                    printf("[ERROR]: Multi-state RLE file uses state prefix '%c', only %d states are supported\n", c,
+                           GEN_MAX_STATES);
+                    exit(EXIT_FAILURE);
+                }else if (c != ' ' && c != '\t' && c != '\r' && c != '\n'){
+                    printf("[ERROR]: Unexpected character '%c' in RLE file\n", c);
+                    exit(EXIT_FAILURE);
+                }
+                count = 0; // whitespace also ends a run count
+            }
+            break;
+        }case PATTERN_LIFE106:{
+            while (p < end){
+                p = skip_spaces(p, end);
+                if (p == end || *p == '#' || *p == '\n'){ // header, comment or empty line
+                    p = next_line(p, end);
+                    continue;
+                }
+                long long x, y;
+                if (!parse_number(&p, end, &x) || !parse_number(&p, end, &y)){
+                    printf("[ERROR]: Expected a pair of coords \"x y\" in Life 1.06 file\n");
+                    exit(EXIT_FAILURE);
+                }
+                sink(arg, y, x, 1);
+                info->cells_alive++;
+                p = next_line(p, end);
+            }
+            break;
+        }case PATTERN_CELLS:{
+            while (p < end){
+                if (*p == '!'){ // comment line
+                    p = next_line(p, end);
+                    continue;
+                }
+                char c = *p++;
+                if (c == NEWLINE_CHAR){
+                    row++;
+                    col = 0;
+                }else if (c == 'O' || c == '*'){
+                    long long length = 1;
+                    while (p < end && (*p == 'O' || *p == '*')){
+                        p++;
+                        length++;
+                    }
+                    sink(arg, row, col, length);
+                    info->cells_alive += length;
+                    col += length;
+                }else if (c == '.'){
+                    col++;
+                    if (col > info->n_cols){ // trailing dead cells still widen the board
+                        info->n_cols = col;
+                    }
+                }else if (c != '\r' && c != ' '){
+                    printf("[ERROR]: Unexpected character '%c' in plaintext file\n", c);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            if (col > 0){ // last row without a newline
+                row++;
+            }
+            info->n_rows = row;
+            break;
+        }
+    }
+}
+
+static void parse_file(const MappedFile *file, const char *filename, PatternInfo *info, RunSink sink, void *arg){
+    /*
+    Parse a whole file, handing every run of living cells to sink (if not NULL).
+    If the header does not give the size of the board it is set from the bounding box of the living cells.
+    */
+    int format = pattern_format(filename);
+    info->format = (format >= 0) ? format : sniff_format(file);
+    const char *body;
+    int sized = parse_header(file, info, &body);
+
+    Bounds bounds = {INT64_MAX, INT64_MIN, INT64_MAX, INT64_MIN, sink, arg};
+    parse_body(file, body, info, bounds_sink, &bounds);
+
+    if (!sized){
+        if (info->format == PATTERN_LIFE106){ // board just covers the living cells
+            info->row0 = (info->cells_alive > 0) ? bounds.min_row : 0;
+            info->col0 = (info->cells_alive > 0) ? bounds.min_col : 0;
+            info->n_rows = (info->cells_alive > 0) ? bounds.max_row - bounds.min_row + 1 : 1;
+            info->n_cols = (info->cells_alive > 0) ? bounds.max_col - bounds.min_col + 1 : 1;
+        }else if (info->format == PATTERN_RLE){ // headerless RLE, from the top left corner
+            info->n_rows = (info->cells_alive > 0) ? bounds.max_row + 1 : 1;
+            info->n_cols = (info->cells_alive > 0) ? bounds.max_col + 1 : 1;
+        }else if (info->cells_alive > 0 && bounds.max_col + 1 > info->n_cols){ // plaintext, rows counted while parsing
+            info->n_cols = bounds.max_col + 1;
+        }
+    }
+}
+
+void read_pattern_header(const char *filename, PatternInfo *info){
+    /*
+    Read only the header of a pattern file: its format, boundary conditions and rule, and its size if the header gives
+    it (otherwise n_rows and n_cols are 0).
+    */
+    MappedFile file;
+    map_file(filename, &file);
+    int format = pattern_format(filename);
+    info->format = (format >= 0) ? format : sniff_format(&file);
+    const char *body;
+    parse_header(&file, info, &body);
+    unmap_file(&file);
+}
+
+void read_pattern_runs(const char *filename, PatternInfo *info, RunSink sink, void *arg){
+    /*
+    Read a pattern file, handing every run of living cells to sink in file coords (row down, column across).
+    Inputs: filename - pattern file, format from the extension (or contents)
+            *info - set to the format, size and rule of the pattern once read
+            sink, arg - called for each run of living cells (see RunSink)
+    */
+    MappedFile file;
+    map_file(filename, &file);
+    parse_file(&file, filename, info, sink, arg);
+    unmap_file(&file);
+}
+
+// Board being filled by bitboard_sink
+typedef struct fill_task{
+    BitBoard *bb;
+    long long row0, col0; // file coords of cell (0,0) of the board
+}FillTask;
+
+static void bitboard_sink(void *arg, long long row, long long col, long long length){
+    // RunSink setting a run of cells of the board a whole word at a time
+    FillTask *task = (FillTask *)arg;
+    BitBoard *bb = task->bb;
+    row -= task->row0;
+    col -= task->col0;
+    if (row < 0 || row >= bb->n_rows || col < 0 || col + length > bb->n_cols){
+        printf("[ERROR]: Living cells at (%lld,%lld) lie outside the %dx%d board given in the file header\n",
+               row, col, bb->n_rows, bb->n_cols);
+        exit(EXIT_FAILURE);
+    }
+    uint64_t *words = bb->cells + (size_t)row*bb->n_words;
+    long long last = col + length - 1;
+    for (long long w = col / BITS_PER_WORD; w <= last / BITS_PER_WORD; w++){
+        uint64_t mask = ~0ULL;
+        if (w == col / BITS_PER_WORD){
+            mask &= ~0ULL << (col % BITS_PER_WORD);
+        }
+        if (w == last / BITS_PER_WORD){
+            mask &= ~0ULL >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD);
+        }
+        words[w] |= mask;
+    }
+}
+
+BitBoard* read_pattern(const char *filename, PatternInfo *info){
+    /*
+    Read a pattern file into a new bit-packed board. Return the board.
+    Inputs: filename - pattern file, format from the extension (or contents)
+            *info - set to the format, size and rule of the pattern. Cell (row0+i, col0+j) of the file is cell (i,j)
+                    of the board
+    - Formats without the size in a header are parsed twice, first to find the size of the board
+    - Error checks for boards too large to hold
+    */
+    MappedFile file;
+    map_file(filename, &file);
+    int format = pattern_format(filename);
+    info->format = (format >= 0) ? format : sniff_format(&file);
+    const char *body;
+    if (!parse_header(&file, info, &body)){
+        parse_file(&file, filename, info, NULL, NULL); // first pass for the size
+    }
+    if (info->n_rows < 1 || info->n_cols < 1 || info->n_rows > INT32_MAX || info->n_cols > INT32_MAX - BITS_PER_WORD){
+        printf("[ERROR]: Board of %lldx%lld cells in %s cannot be held\n", info->n_rows, info->n_cols, filename);
+        exit(EXIT_FAILURE);
+    }
+
+    BitBoard *bb = create_bitboard((int)info->n_rows, (int)info->n_cols);
+    FillTask task = {bb, info->row0, info->col0};
+    parse_file(&file, filename, info, bitboard_sink, &task);
+    unmap_file(&file);
+    return bb;
+}
+
+// Generations board being filled by gen_board_sink
+typedef struct gen_fill_task{
+    GenBoard *gb;
+    long long row0, col0; // file coords of cell (0,0) of the board
+    const PatternInfo *info; // state of each run
+    const char *filename;
+    unsigned birth_mask, survive_mask; // rule the board is run with
+    int n_states;
+}GenFillTask;
+
+static void gen_board_sink(void *arg, long long row, long long col, long long length){
+    // RunSink setting a run of cells of a Generations board to the state of the run
+    GenFillTask *task = (GenFillTask *)arg;
+    GenBoard *gb = task->gb;
+    row -= task->row0;
+    col -= task->col0;
+    if (row < 0 || row >= gb->n_rows || col < 0 || col + length > gb->n_cols){
+        printf("[ERROR]: Living cells at (%lld,%lld) lie outside the %dx%d board given in the file header\n",
+               row, col, gb->n_rows, gb->n_cols);
+        exit(EXIT_FAILURE);
+    }
+    int state = task->info->run_state;
+    if (state >= task->n_states){
+        char rule[RULE_STRING_LENGTH];
+        generations_rule_string(task->birth_mask, task->survive_mask, task->n_states, rule);
+        printf("[ERROR]: State %c in %s is not a state of rule %s, which has states A to %c\n", 'A' + state - 1,
+               task->filename, rule, 'A' + task->n_states - 2);
+        exit(EXIT_FAILURE);
+    }
+    for (long long j = col; j < col + length; j++){
+        set_gen_cell(gb, (int)row, (int)j, state);
+    }
+}
+
+GenBoard* read_gen_pattern(const char *filename, PatternInfo *info, unsigned birth_mask, unsigned survive_mask,
+                           int n_states){
+    /*
+    Read a pattern file into a new Generations board, as read_pattern. Return the board.
+    Inputs: birth_mask, survive_mask, n_states - rule the board is run with (see parse_generations_rule)
+    - The letters of a multi-state RLE file give the state of each cell (A alive, B, C, ... decaying), the cells of
+      other formats are alive
+    - Error checks for a letter past the last state of the rule
+    */
+    MappedFile file;
+    map_file(filename, &file);
+    int format = pattern_format(filename);
+    info->format = (format >= 0) ? format : sniff_format(&file);
+    const char *body;
+    if (!parse_header(&file, info, &body)){
+        parse_file(&file, filename, info, NULL, NULL); // first pass for the size
+    }
+    if (info->n_rows < 1 || info->n_cols < 1 || info->n_rows > INT32_MAX || info->n_cols > INT32_MAX - CELLS_PER_GEN_WORD){
+        printf("[ERROR]: Board of %lldx%lld cells in %s cannot be held\n", info->n_rows, info->n_cols, filename);
+        exit(EXIT_FAILURE);
+    }
+
+    GenBoard *gb = create_gen_board((int)info->n_rows, (int)info->n_cols);
+    GenFillTask task = {gb, info->row0, info->col0, info, filename, birth_mask, survive_mask, n_states};
+    parse_file(&file, filename, info, gen_board_sink, &task);
+    unmap_file(&file);
+    return gb;
+}
+
+// Buffered output file
+typedef struct out_buffer{
+    FILE *file;
+    char data[OUT_BUFFER_SIZE];
+    size_t used;
+}OutBuffer;
+
+static OutBuffer* open_out(const char *filename){
+    // Open a file to write through a buffer
+    OutBuffer *out = (OutBuffer *)malloc(sizeof(OutBuffer));
+    if (out == NULL){
+        printf("[ERROR] Out of memory whilst saving the board\n");
+        exit(EXIT_FAILURE);
+    }
+    out->file = fopen(filename, "w");
+    out->used = 0;
+    if (out->file == NULL){
+        printf("[ERROR]: Save file %s could not be opened\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    return out;
+}
+
+static void flush_out(OutBuffer *out){
+    // Write the buffer to the file
+    if (out->used > 0 && fwrite(out->data, 1, out->used, out->file) != out->used){
+        printf("[ERROR]: Write to pattern file failed\n");
+        exit(EXIT_FAILURE);
+    }
+    out->used = 0;
+}
+
+static void close_out(OutBuffer *out){
+    // Write what is left in the buffer and close the file
+    flush_out(out);
+    fclose(out->file);
+    free(out);
+}
+
+static void put_text(OutBuffer *out, const char *text, size_t n){
+    // Append n characters to the buffer
+    if (out->used + n > OUT_BUFFER_SIZE){
+        flush_out(out);
+    }
+    memcpy(out->data + out->used, text, n);
+    out->used += n;
+}
+
+static void put_char(OutBuffer *out, char c){
+    // Append a character to the buffer
+    if (out->used == OUT_BUFFER_SIZE){
+        flush_out(out);
+    }
+    out->data[out->used++] = c;
+}
+
+static int put_run(OutBuffer *out, long long count, char tag){
+    // Append a RLE run (count omitted when 1). Return the number of characters written
+    char text[24];
+    int n = sizeof(text);
+    text[--n] = tag;
+    if (count > 1){
+        for (; count > 0; count /= 10){ // digits from the right, snprintf is too slow for millions of short runs
+            text[--n] = (char)('0' + count % 10);
+        }
+    }
+    put_text(out, text + n, sizeof(text) - n);
+    return (int)sizeof(text) - n;
+}
+
+static int run_end(const uint64_t *row, int n_cols, int j, int state){
+    // Return the column after the run of cells in state starting at column j, a word at a time
+    int w = j / BITS_PER_WORD;
+    uint64_t changes = (state == ALIVE ? ~row[w] : row[w]) & (~0ULL << (j % BITS_PER_WORD)); // cells not in state
+    while (changes == 0){
+        if (++w * BITS_PER_WORD >= n_cols){
+            return n_cols;
+        }
+        changes = (state == ALIVE) ? ~row[w] : row[w];
+    }
+    int k = w*BITS_PER_WORD + __builtin_ctzll(changes);
+    return (k < n_cols) ? k : n_cols;
+}
+
+static int topology_suffix(char *text, size_t size, int fixed_bounds, int n_rows, int n_cols){
+    /*
+    Write Golly's bounded grid suffix for the boundary conditions after the rule of a RLE header, returning its length:
+    :T for a torus, :P for a plane with dead cells around it and :K with the width starred for a Klein bottle whose
+    top and bottom edges are joined reversed. Fixed and mirrored edges have no suffix, and are read back as infinite.
+    */
+    switch (fixed_bounds){
+        case 0:
+            return snprintf(text, size, ":T%d,%d", n_cols, n_rows);
+        case DEAD_BOUNDS:
+            return snprintf(text, size, ":P%d,%d", n_cols, n_rows);
+        case KLEIN_BOUNDS:
+            return snprintf(text, size, ":K%d*,%d", n_cols, n_rows);
+        default:
+            return 0;
+    }
+}
+
+static void write_rle(OutBuffer *out, const BitBoard *bb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask){
+    /*
+    Write the board as RLE: runs of dead (b) and living (o) cells, $ at the end of each row, ! at the end.
+    - Dead cells at the end of a row are left out, empty rows are merged into the $ run
+    - A toroidal board keeps its size with Golly's :T suffix on the rule (see topology_suffix)
+    */
+    char header[128], rule[RULE_STRING_LENGTH];
+    rule_string(birth_mask, survive_mask, rule);
+    int n = snprintf(header, sizeof(header), "x = %d, y = %d, rule = %s", bb->n_cols, bb->n_rows, rule);
+    n += topology_suffix(header + n, sizeof(header) - n, fixed_bounds, bb->n_rows, bb->n_cols);
+    header[n++] = '\n';
+    put_text(out, header, (size_t)n);
+
+    int line = 0; // characters on the current line
+    long long pending_rows = 0; // row ends not yet written
+    for (int i = 0; i < bb->n_rows; i++){
+        const uint64_t *row = bb->cells + (size_t)i*bb->n_words;
+        int j = 0;
+        while (j < bb->n_cols){
+            int state = get_bitboard_cell(bb, i, j);
+            int k = run_end(row, bb->n_cols, j, state);
+            if (state == DEAD && k == bb->n_cols){ // trailing dead cells
+                break;
+            }
+            if (pending_rows > 0){
+                line += put_run(out, pending_rows, '$');
+                pending_rows = 0;
+            }
+            line += put_run(out, k - j, (state == ALIVE) ? 'o' : 'b');
+            if (line >= RLE_LINE_LENGTH){
+                put_char(out, '\n');
+                line = 0;
+            }
+            j = k;
+        }
+        pending_rows++;
+    }
+    put_text(out, "!\n", 2);
+}
+
+void write_pattern(const BitBoard *bb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, const char *filename){
+    /*
+    Save a bit-packed board to a pattern file, in the format given by the extension (native board file if unknown).
+    Inputs: bb - board to save
+            fixed_bounds - boundary conditions, written to native files and as a Golly torus to RLE files
+            birth_mask, survive_mask - rule written to RLE files (see parse_rule)
+            filename - file to write (overwritten)
+    */
+    OutBuffer *out = open_out(filename);
+    char text[96];
+    int format = pattern_format(filename);
+    switch (format){
+        case PATTERN_RLE:{
+            write_rle(out, bb, fixed_bounds, birth_mask, survive_mask);
+            break;
+        }case PATTERN_LIFE106:{
+            put_text(out, "#Life 1.06\n", 11);
+            for (int i = 0; i < bb->n_rows; i++){
+                for (int w = 0; w < bb->n_words; w++){
+                    for (uint64_t word = bb->cells[(size_t)i*bb->n_words + w]; word != 0; word &= word - 1){
+                        int n = snprintf(text, sizeof(text), "%d %d\n", w*BITS_PER_WORD + __builtin_ctzll(word), i);
+                        put_text(out, text, (size_t)n);
+                    }
+                }
+            }
+            break;
+        }default:{ // one character per cell
+            if (format == PATTERN_CELLS){
+                put_text(out, "!Name: ", 7);
+                put_text(out, filename, strlen(filename));
+                put_char(out, '\n');
+            }else{
+                int n = snprintf(text, sizeof(text), "n_rows:%d, n_cols:%d, fixed_bounds:%d\n", bb->n_rows, bb->n_cols, fixed_bounds);
+                put_text(out, text, (size_t)n);
+            }
+            char dead = (format == PATTERN_CELLS) ? '.' : '0', alive = (format == PATTERN_CELLS) ? 'O' : '1';
+            for (int i = 0; i < bb->n_rows; i++){
+                for (int j = 0; j < bb->n_cols; j++){
+                    put_char(out, get_bitboard_cell(bb, i, j) ? alive : dead);
+                }
+                put_char(out, NEWLINE_CHAR);
+            }
+        }
+    }
+    close_out(out);
+}
+
+static void write_gen_rle(OutBuffer *out, const GenBoard *gb, int fixed_bounds, unsigned birth_mask,
+                          unsigned survive_mask, int n_states){
+    /*
+    Write a Generations board as multi-state RLE: runs of dead (.) cells and cells in state s (the letter 'A'+s-1,
+    so A for living cells), laid out as in write_rle with the number of states on the rule.
+    */
+    char header[128], rule[RULE_STRING_LENGTH];
+    generations_rule_string(birth_mask, survive_mask, n_states, rule);
+    int n = snprintf(header, sizeof(header), "x = %d, y = %d, rule = %s", gb->n_cols, gb->n_rows, rule);
+    n += topology_suffix(header + n, sizeof(header) - n, fixed_bounds, gb->n_rows, gb->n_cols);
+    header[n++] = '\n';
+    put_text(out, header, (size_t)n);
+
+    int line = 0; // characters on the current line
+    long long pending_rows = 0; // row ends not yet written
+    for (int i = 0; i < gb->n_rows; i++){
+        int j = 0;
+        while (j < gb->n_cols){
+            int state = get_gen_cell(gb, i, j);
+            int k = j + 1;
+            while (k < gb->n_cols && get_gen_cell(gb, i, k) == state){
+                k++;
+            }
+            if (state == 0 && k == gb->n_cols){ // trailing dead cells
+                break;
+            }
+            if (pending_rows > 0){
+                line += put_run(out, pending_rows, '$');
+                pending_rows = 0;
+            }
+            line += put_run(out, k - j, (state == 0) ? '.' : (char)('A' + state - 1));
+            if (line >= RLE_LINE_LENGTH){
+                put_char(out, '\n');
+                line = 0;
+            }
+            j = k;
+        }
+        pending_rows++;
+    }
+    put_text(out, "!\n", 2);
+}
+
+void write_gen_pattern(const GenBoard *gb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, int n_states,
+                       const char *filename){
+    /*
+    Save a Generations board to a pattern file. RLE files keep every state, other formats only hold two states so
+    get the living cells (state 1), as write_pattern.
+    Inputs: as write_pattern, with n_states - number of states of the rule, written to RLE files (see
+            parse_generations_rule)
+    */
+    if (pattern_format(filename) != PATTERN_RLE){
+        BitBoard *bb = create_bitboard(gb->n_rows, gb->n_cols);
+        gen_board_to_bitboard(gb, bb);
+        write_pattern(bb, fixed_bounds, birth_mask, survive_mask, filename);
+        free_bitboard(bb);
+        return;
+    }
+    OutBuffer *out = open_out(filename);
+    write_gen_rle(out, gb, fixed_bounds, birth_mask, survive_mask, n_states);
+    close_out(out);
+}
@@ -0,0 +1,60 @@
+/*
+* Pattern file reading and writing for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Readers and writers for the game's own board files and the formats used by pattern collections:
+                - RLE (.rle), including the "rule = " part of the header and Golly's ":T<w>,<h>" torus suffix
+                  (":P<w>,<h>" dead edges and ":K<w>*,<h>" Klein bottle too)
+                - Life 1.06 (.lif, .life), one "x y" pair per living cell
+                - plaintext (.cells), '.' for dead and 'O' for living cells
+              Readers memory-map the file and parse it in one pass, handing each run of living cells to a callback,
+              so files of many gigabytes are read at close to disk speed without being copied into memory.
+              Writers build each row in a buffer and write it in one call. Generations boards are read from and written to
+              RLE with a letter for each state (A alive, B, C, ... decaying), bit-packed boards take every letter as
+              a living cell.
+ */
+
+#ifndef PATTERN_IO_H
+#define PATTERN_IO_H
+
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "generations.h"
+
+// File formats (chosen from the file extension, or the contents if the extension is unknown)
+#define PATTERN_NATIVE 0 // n_rows:..., n_cols:..., fixed_bounds:... header then rows of 0's and 1's
+#define PATTERN_RLE 1
+#define PATTERN_LIFE106 2
+#define PATTERN_CELLS 3
+
+#define PATTERN_RULE_LENGTH 64 // longest rule string kept from a RLE header
+
+// Define a structure with alias 'PatternInfo' for what is known about a pattern file once read
+typedef struct pattern_info{
+    int format; // PATTERN_*
+    long long n_rows, n_cols; // size of the board the pattern is placed on
+    long long row0, col0; // file coords of the top left cell of the board (Life 1.06 coords may be negative)
+    int fixed_bounds; // boundary conditions from the file (native header or Golly suffix), INFINITE_BOUNDS otherwise
+    char rule[PATTERN_RULE_LENGTH]; // rule from a RLE header without the Golly suffix, "" if none given
+    long long cells_alive; // number of living cells read (cells in any state of a multi-state RLE file)
+    int run_state; // state of the run handed to a RunSink, 1 unless a multi-state RLE letter (B = 2, C = 3, ...)
+}PatternInfo;
+
+// Called for every run of length living cells starting at (row, col) in file coords, left to right
+typedef void (*RunSink)(void *arg, long long row, long long col, long long length);
+
+// Prototype function definitions
+int pattern_format(const char *filename); // PATTERN_* from the extension, -1 if it is not known
+void read_pattern_header(const char *filename, PatternInfo *info);
+void read_pattern_runs(const char *filename, PatternInfo *info, RunSink sink, void *arg);
+BitBoard* read_pattern(const char *filename, PatternInfo *info); // board of n_rows*n_cols with (row0,col0) at its top left
+GenBoard* read_gen_pattern(const char *filename, PatternInfo *info, unsigned birth_mask, unsigned survive_mask,
+                           int n_states); // as read_pattern, keeping the state of each cell of the rule
+void write_pattern(const BitBoard *bb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, const char *filename);
+void write_gen_pattern(const GenBoard *gb, int fixed_bounds, unsigned birth_mask, unsigned survive_mask, int n_states,
+                       const char *filename); // every state kept in RLE files, living cells only in other formats
+
+#endif // PATTERN_IO_H
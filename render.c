@@ -0,0 +1,236 @@
+/*
+* Terminal renderer for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Every mode works the same way: each board row and column is mapped once (on creation) to the character it falls
+ in and the dot it lights within that character, so building a frame is one pass over the cells ORing dot bits into
+ the glyphs. The glyphs are then compared with those on the screen and only the differences are written.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "render.h"
+
+#define RENDER_STATUS_LENGTH 256 // longest status line shown
+#define RENDER_MAX_BYTES 19 // most bytes written for one character: cursor move (16) and glyph (3)
+
+static const int dots_high[3] = {1, 2, 4}; // dot rows in a character for each mode
+static const int dots_wide[3] = {1, 1, 2}; // dot columns in a character for each mode
+static const uint8_t dot_bits[3][4][2] = { // bit of the glyph for each dot of a character
+    {{0x01}},
+    {{0x01}, {0x02}}, // top half, bottom half
+    {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}}, // braille dot numbering
+};
+static const char *half_blocks[4] = {" ", "\xE2\x96\x80", "\xE2\x96\x84", "\xE2\x96\x88"}; // " ", upper, lower, full
+
+static void terminal_size(int *rows, int *cols){
+    // Rows and columns of the terminal, 24x80 if it is not a terminal
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0){
+        *rows = size.ws_row;
+        *cols = size.ws_col;
+    }else{
+        *rows = 24;
+        *cols = 80;
+    }
+}
+
+static void write_all(const char *data, size_t n){
+    // Write n bytes to stdout after anything waiting in printf's buffer
+    fflush(stdout);
+    while (n > 0){
+        ssize_t written = write(STDOUT_FILENO, data, n);
+        if (written < 0){
+            if (errno == EINTR){
+                continue;
+            }
+            return; // terminal gone, nothing more to show
+        }
+        data += written;
+        n -= (size_t)written;
+    }
+}
+
+Renderer* create_renderer(int n_rows, int n_cols){
+    /*
+    Create a renderer for a board of n_rows*n_cols, choosing the mode from the size of the terminal.
+    - Error checks for memory
+    - The screen is cleared, ready for the first frame to be drawn in full (see reset_renderer)
+    */
+    int term_rows, term_cols;
+    terminal_size(&term_rows, &term_cols);
+    term_rows = (term_rows > RENDER_STATUS_ROWS) ? term_rows - RENDER_STATUS_ROWS : 1;
+
+    int mode, scale = 1;
+    if (2*n_cols <= term_cols && n_rows <= term_rows){
+        mode = RENDER_CELLS;
+    }else if (n_cols <= term_cols && n_rows <= 2*term_rows){
+        mode = RENDER_HALF_BLOCK;
+    }else{ // downsample the same amount in both directions to keep the shape of the board
+        mode = RENDER_BRAILLE;
+        int scale_cols = (n_cols + 2*term_cols - 1) / (2*term_cols);
+        int scale_rows = (n_rows + 4*term_rows - 1) / (4*term_rows);
+        scale = (scale_cols > scale_rows) ? scale_cols : scale_rows;
+    }
+    int block_high = dots_high[mode] * scale, block_wide = dots_wide[mode] * scale; // cells in a character
+
+    Renderer *renderer = (Renderer *)malloc(sizeof(Renderer));
+    if (renderer == NULL){
+        printf("[ERROR] Out of memory whilst creating the renderer\n");
+        exit(EXIT_FAILURE);
+    }
+    renderer->mode = mode;
+    renderer->scale = scale;
+    renderer->n_rows = (n_rows + block_high - 1) / block_high;
+    renderer->n_cols = (n_cols + block_wide - 1) / block_wide;
+    size_t n_chars = (size_t)renderer->n_rows * renderer->n_cols;
+    renderer->max_size = n_chars * RENDER_MAX_BYTES + RENDER_STATUS_LENGTH + 64;
+    renderer->char_row = (int *)malloc((size_t)n_rows * sizeof(int));
+    renderer->char_col = (int *)malloc((size_t)n_cols * sizeof(int));
+    renderer->dot_row = (uint8_t *)malloc((size_t)n_rows);
+    renderer->dot_col = (uint8_t *)malloc((size_t)n_cols);
+    renderer->frame = (uint8_t *)malloc(n_chars);
+    renderer->shown = (uint8_t *)malloc(n_chars);
+    renderer->buffer = (char *)malloc(renderer->max_size);
+    if (renderer->char_row == NULL || renderer->char_col == NULL || renderer->dot_row == NULL
+        || renderer->dot_col == NULL || renderer->frame == NULL || renderer->shown == NULL || renderer->buffer == NULL){
+        printf("[ERROR] Out of memory whilst creating the renderer\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n_rows; i++){
+        renderer->char_row[i] = i / block_high;
+        renderer->dot_row[i] = (uint8_t)((i % block_high) / scale);
+    }
+    for (int j = 0; j < n_cols; j++){
+        renderer->char_col[j] = j / block_wide;
+        renderer->dot_col[j] = (uint8_t)((j % block_wide) / scale);
+    }
+    reset_renderer(renderer);
+    return renderer;
+}
+
+void free_renderer(Renderer *renderer){
+    // Free the renderer and its buffers
+    free(renderer->char_row);
+    free(renderer->char_col);
+    free(renderer->dot_row);
+    free(renderer->dot_col);
+    free(renderer->frame);
+    free(renderer->shown);
+    free(renderer->buffer);
+    free(renderer);
+}
+
+void clear_screen(void){
+    // Clear the terminal and move the cursor to the top left
+    static const char clear[] = "\x1b[2J\x1b[H";
+    write_all(clear, sizeof(clear) - 1);
+}
+
+void reset_renderer(Renderer *renderer){
+    // Clear the screen so the next frame is drawn in full (after anything else has been printed over it)
+    clear_screen();
+    memset(renderer->shown, 0, (size_t)renderer->n_rows * renderer->n_cols); // glyph 0 is blank in every mode
+}
+
+static char* put_int(char *p, int n){
+    // Write the digits of n >= 0 and return the end of them
+    char digits[12];
+    int n_digits = 0;
+    do{
+        digits[n_digits++] = (char)('0' + n % 10);
+        n /= 10;
+    }while (n > 0);
+    while (n_digits > 0){
+        *p++ = digits[--n_digits];
+    }
+    return p;
+}
+
+static char* put_move(char *p, int row, int col){
+    // Write the escape code moving the cursor to a terminal row and column (from 1)
+    *p++ = '\x1b';
+    *p++ = '[';
+    p = put_int(p, row);
+    *p++ = ';';
+    p = put_int(p, col);
+    *p++ = 'H';
+    return p;
+}
+
+static char* put_glyph(char *p, int mode, uint8_t glyph){
+    // Write the characters for a glyph
+    if (mode == RENDER_CELLS){
+        *p++ = glyph ? 'o' : ' ';
+        *p++ = ' ';
+    }else if (mode == RENDER_HALF_BLOCK){
+        size_t length = strlen(half_blocks[glyph]);
+        memcpy(p, half_blocks[glyph], length);
+        p += length;
+    }else if (glyph == 0){
+        *p++ = ' ';
+    }else{ // U+2800 + glyph in UTF-8
+        *p++ = '\xE2';
+        *p++ = (char)(0xA0 | (glyph >> 6));
+        *p++ = (char)(0x80 | (glyph & 0x3F));
+    }
+    return p;
+}
+
+void render_frame(Renderer *renderer, const BitBoard *bb, const char *status){
+    /*
+    Draw the board, writing only the characters which changed since the last frame, then the status line below it.
+    Inputs: renderer - renderer for the size of the board (declared by create_renderer)
+            bb - bit-packed copy of the board
+            status - line of text shown below the board (NULL for none)
+    - The whole frame is written in one call, with the cursor hidden while it is drawn
+    */
+    int n_chars = renderer->n_rows * renderer->n_cols;
+    memset(renderer->frame, 0, (size_t)n_chars);
+    for (int i = 0; i < bb->n_rows; i++){ // light the dots of the living cells
+        uint8_t *frame_row = renderer->frame + (size_t)renderer->char_row[i] * renderer->n_cols;
+        const uint8_t *bits = dot_bits[renderer->mode][renderer->dot_row[i]];
+        const uint64_t *row = bb->cells + (size_t)i*bb->n_words;
+        for (int w = 0; w < bb->n_words; w++){
+            for (uint64_t word = row[w]; word != 0; word &= word - 1){ // skip straight to each living cell
+                int j = w*BITS_PER_WORD + __builtin_ctzll(word);
+                frame_row[renderer->char_col[j]] |= bits[renderer->dot_col[j]];
+            }
+        }
+    }
+
+    int char_width = (renderer->mode == RENDER_CELLS) ? 2 : 1; // terminal columns per character
+    char *p = renderer->buffer;
+    static const char start[] = "\x1b[?25l"; // hide the cursor
+    memcpy(p, start, sizeof(start) - 1);
+    p += sizeof(start) - 1;
+    int cursor = -1; // character the cursor is at, -1 if not on the board
+    for (int k = 0; k < n_chars; k++){
+        if (renderer->frame[k] != renderer->shown[k]){
+            if (cursor != k){
+                p = put_move(p, k / renderer->n_cols + 1, (k % renderer->n_cols) * char_width + 1);
+            }
+            p = put_glyph(p, renderer->mode, renderer->frame[k]);
+            renderer->shown[k] = renderer->frame[k];
+            cursor = ((k+1) % renderer->n_cols == 0) ? -1 : k+1; // the cursor does not wrap to the next row
+        }
+    }
+    p = put_move(p, renderer->n_rows + 1, 1);
+    if (status != NULL){
+        size_t length = strlen(status);
+        length = (length < RENDER_STATUS_LENGTH) ? length : RENDER_STATUS_LENGTH;
+        memcpy(p, status, length);
+        p += length;
+    }
+    static const char end[] = "\x1b[K\r\n\x1b[?25h"; // clear the rest of the status line, show the cursor below it
+    memcpy(p, end, sizeof(end) - 1);
+    p += sizeof(end) - 1;
+    write_all(renderer->buffer, (size_t)(p - renderer->buffer));
+}
@@ -0,0 +1,51 @@
+/*
+* Terminal renderer for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Animates a board in the terminal using ANSI escape codes. Each frame is built in a buffer holding
+              only the characters that changed since the last frame (with a cursor move before each run of them)
+              and written with a single write call, so a frame of a still life costs a few bytes however large the
+              board is.
+              The board is drawn in the first of these modes that fits the terminal:
+                - RENDER_CELLS: "o " for every living cell, as print_board
+                - RENDER_HALF_BLOCK: one character for 1x2 cells using the half block characters
+                - RENDER_BRAILLE: one character for 2x4 dots using the braille characters, each dot showing a square
+                  block of cells (alive if any cell in the block is alive) when the board is still too large
+ */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+
+#include "bitboard.h"
+
+#define RENDER_CELLS 0
+#define RENDER_HALF_BLOCK 1
+#define RENDER_BRAILLE 2
+
+#define RENDER_STATUS_ROWS 2 // terminal rows kept below the board for the status line and cursor
+
+// Define a structure with alias 'Renderer' for what is on the screen and the buffer used to change it
+typedef struct renderer{
+    int mode; // RENDER_*
+    int scale; // board cells per dot along each side (1 unless the board is downsampled)
+    int n_rows, n_cols; // characters in the frame
+    int *char_row, *char_col; // character row (or column) holding each board row (or column)
+    uint8_t *dot_row, *dot_col; // position of each board row (or column) within its character
+    uint8_t *frame; // glyph for each character being drawn (bit mask of the dots lit)
+    uint8_t *shown; // glyph on the screen at each character
+    char *buffer; // bytes written for a frame
+    size_t max_size;
+}Renderer;
+
+// Prototype function definitions
+Renderer* create_renderer(int n_rows, int n_cols); // mode chosen for a board of n_rows*n_cols and the terminal size
+void free_renderer(Renderer *renderer);
+void clear_screen(void);
+void reset_renderer(Renderer *renderer); // clear the screen so the next frame is drawn in full
+void render_frame(Renderer *renderer, const BitBoard *bb, const char *status);
+
+#endif // RENDER_H
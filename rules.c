@@ -0,0 +1,185 @@
+/*
+* Life-like rules for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "rules.h"
+
+// Define a structure with alias 'RulePreset' for a rule offered by the menu
+typedef struct rule_preset{
+    const char *name;
+    unsigned birth_mask, survive_mask;
+}RulePreset;
+
+static const RulePreset presets[N_RULE_PRESETS] = {
+    {"Classic Rules", LIFE_BIRTH, LIFE_SURVIVE},
+    {"Custom Rules 1", 1u << 5, (1u << 3) | (1u << 4) | (1u << 5) | (1u << 6)}, // B5/S3456
+    {"Custom Rules 2", 1u << 3, (1u << 2) | (1u << 3) | (1u << 4)}, // B3/S234, maze like grids
+    {"HighLife", HIGHLIFE_BIRTH, HIGHLIFE_SURVIVE},
+    {"Day & Night", DAY_NIGHT_BIRTH, DAY_NIGHT_SURVIVE},
+    {"Seeds", SEEDS_BIRTH, SEEDS_SURVIVE},
+};
+
+static const char* parse_counts(const char *p, unsigned *mask){
+    // Read a list of neighbour counts (digits 0 to 8) into a mask, returning the character after the list
+    *mask = 0;
+    while (*p >= '0' && *p <= '8'){
+        *mask |= 1u << (*p - '0');
+        p++;
+    }
+    return p;
+}
+
+int parse_rule(const char *text, unsigned *birth_mask, unsigned *survive_mask){
+    /*
+    Read a rule in B/S notation into its masks. Return 1 on success, 0 if text is not a rule (the masks are left
+    unchanged).
+    Inputs: text - rule, e.g. B36/S23, b36/s23, S23/B36, or the older S/B notation 23/36 (survive counts first)
+            *birth_mask - dead cells with n neighbours become alive if bit n is set
+            *survive_mask - living cells with n neighbours stay alive if bit n is set
+    */
+    unsigned birth = 0, survive = 0;
+    const char *p = text;
+    while (isspace((unsigned char)*p)){
+        p++;
+    }
+    if (toupper((unsigned char)*p) == 'B' || toupper((unsigned char)*p) == 'S'){
+        int seen_b = 0, seen_s = 0;
+        while (toupper((unsigned char)*p) == 'B' || toupper((unsigned char)*p) == 'S'){
+            if (toupper((unsigned char)*p) == 'B'){
+                if (seen_b++){
+                    return 0;
+                }
+                p = parse_counts(p + 1, &birth);
+            }else{
+                if (seen_s++){
+                    return 0;
+                }
+                p = parse_counts(p + 1, &survive);
+            }
+            if (*p == '/' && !(seen_b && seen_s)){
+                p++;
+            }
+        }
+        if (!seen_b || !seen_s){
+            return 0;
+        }
+    }else{ // S/B notation
+        p = parse_counts(p, &survive);
+        if (*p++ != '/'){
+            return 0;
+        }
+        p = parse_counts(p, &birth);
+    }
+    while (isspace((unsigned char)*p)){
+        p++;
+    }
+    if (*p != '\0'){
+        return 0;
+    }
+    *birth_mask = birth;
+    *survive_mask = survive;
+    return 1;
+}
+
+void rule_string(unsigned birth_mask, unsigned survive_mask, char *text){
+    // Write the rule given by the masks in B/S notation, e.g. B3/S23 (at most RULE_STRING_LENGTH characters)
+    int n = 0;
+    text[n++] = 'B';
+    for (int k = 0; k <= 8; k++){
+        if (birth_mask & (1u << k)){
+            text[n++] = (char)('0' + k);
+        }
+    }
+    text[n++] = '/';
+    text[n++] = 'S';
+    for (int k = 0; k <= 8; k++){
+        if (survive_mask & (1u << k)){
+            text[n++] = (char)('0' + k);
+        }
+    }
+    text[n] = '\0';
+}
+
+int parse_generations_rule(const char *text, unsigned *birth_mask, unsigned *survive_mask, int *n_states){
+    /*
+    Read a rule of the Generations family, a Life-like rule followed by the number of states. Return 1 on success,
+    0 if text is not a rule (the outputs are left unchanged).
+    Inputs: text - rule, e.g. B2/S/C3 (Brian's Brain), S345/B2/C4, or 345/2/4 (survive/birth/states), or a
+                   Life-like rule with no number of states (2 states)
+            *birth_mask, *survive_mask - as for parse_rule
+            *n_states - number of states including dead and alive (2 to MAX_RULE_STATES)
+    */
+    char life[RULE_STRING_LENGTH + 8];
+    size_t length = strlen(text);
+    while (length > 0 && isspace((unsigned char)text[length-1])){
+        length--;
+    }
+    if (length >= sizeof(life)){
+        return 0;
+    }
+    memcpy(life, text, length);
+    life[length] = '\0';
+
+    int states = 2;
+    char *last = strrchr(life, '/');
+    if (last != NULL){
+        const char *p = last + 1;
+        int numeric = (strchr(life, '/') != last); // third field of S/B/C notation has no letter
+        if (toupper((unsigned char)*p) == 'C' || toupper((unsigned char)*p) == 'G'){
+            p++;
+            numeric = 1;
+        }
+        if (numeric){
+            char *end;
+            long n = strtol(p, &end, 10);
+            if (end == p || *end != '\0' || n < 2 || n > MAX_RULE_STATES){
+                return 0;
+            }
+            states = (int)n;
+            *last = '\0'; // leave the Life-like part
+        }
+    }
+    unsigned birth, survive;
+    if (!parse_rule(life, &birth, &survive)){
+        return 0;
+    }
+    *birth_mask = birth;
+    *survive_mask = survive;
+    *n_states = states;
+    return 1;
+}
+
+void generations_rule_string(unsigned birth_mask, unsigned survive_mask, int n_states, char *text){
+    // Write a Generations rule as B/S/C, e.g. B2/S/C3, or in B/S notation for 2 states (at most RULE_STRING_LENGTH)
+    rule_string(birth_mask, survive_mask, text);
+    if (n_states > 2){
+        sprintf(text + strlen(text), "/C%d", n_states);
+    }
+}
+
+int rule_preset(int preset, unsigned *birth_mask, unsigned *survive_mask){
+    /*
+    Set the masks to one of the rules offered by the menu, numbered from 1. Return 1 on success, 0 if there is no
+    such preset (the masks are left unchanged).
+    */
+    if (preset < 1 || preset > N_RULE_PRESETS){
+        return 0;
+    }
+    *birth_mask = presets[preset-1].birth_mask;
+    *survive_mask = presets[preset-1].survive_mask;
+    return 1;
+}
+
+const char* rule_preset_name(int preset){
+    // Return the name of a preset numbered from 1, "unknown" if there is no such preset
+    if (preset < 1 || preset > N_RULE_PRESETS){
+        return "unknown";
+    }
+    return presets[preset-1].name;
+}
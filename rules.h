@@ -0,0 +1,42 @@
+/*
+* Life-like rules for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: A Life-like rule is given in B/S notation, e.g. B3/S23 for Conway's rules: a dead cell is born with
+              any number of neighbours listed after B and a living cell survives with any number listed after S.
+              It is held as two 9 bit masks (bit n set -> the rule applies with n neighbours), so rules which are not
+              a single range of counts (HighLife B36/S23, Day & Night B3678/S34678, Seeds B2/S) work everywhere.
+              The bit-packed kernels are specialised at compile time for the common rules below (see
+              bitboard_simd.c), other rules use the general kernels.
+              A Generations rule adds the number of states, e.g. B2/S/C3 (Brian's Brain): a living cell which does not
+              survive decays through the extra states before it is dead again (see generations.h).
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#define RULE_STRING_LENGTH 28 // longest rule written, B012345678/S012345678/C16 and the terminator
+#define MAX_RULE_STATES 16 // most states of a Generations rule (see generations.h)
+
+#define LIFE_BIRTH (1u << 3) // Classic rules B3/S23: birth with 3 neighbours
+#define LIFE_SURVIVE ((1u << 2) | (1u << 3)) // Classic rules: survive with 2 or 3 neighbours
+#define HIGHLIFE_BIRTH ((1u << 3) | (1u << 6)) // HighLife B36/S23
+#define HIGHLIFE_SURVIVE LIFE_SURVIVE
+#define DAY_NIGHT_BIRTH ((1u << 3) | (1u << 6) | (1u << 7) | (1u << 8)) // Day & Night B3678/S34678
+#define DAY_NIGHT_SURVIVE ((1u << 3) | (1u << 4) | (1u << 6) | (1u << 7) | (1u << 8))
+#define SEEDS_BIRTH (1u << 2) // Seeds B2/S
+#define SEEDS_SURVIVE 0u
+
+#define N_RULE_PRESETS 6 // rules offered by the menu and --rule N
+
+// Prototype function definitions
+int parse_rule(const char *text, unsigned *birth_mask, unsigned *survive_mask); // 1 on success, 0 if not a rule
+void rule_string(unsigned birth_mask, unsigned survive_mask, char *text); // B/S notation, e.g. B3/S23
+int parse_generations_rule(const char *text, unsigned *birth_mask, unsigned *survive_mask, int *n_states);
+void generations_rule_string(unsigned birth_mask, unsigned survive_mask, int n_states, char *text); // e.g. B2/S/C3
+int rule_preset(int preset, unsigned *birth_mask, unsigned *survive_mask); // 1 on success, 0 if no such preset
+const char* rule_preset_name(int preset);
+
+#endif // RULES_H
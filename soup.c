@@ -0,0 +1,822 @@
+/*
+* Soup search and census for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ A soup is stepped on its own sparse plane with no thread pool, as every thread is already running soups of its own.
+ Once it settles, the cells of the next few generations are gathered, sorted and joined into pieces with a
+ union-find over the pairs of touching cells. Pieces close enough to interact are joined if running them together
+ differs from running each alone. Each object is then copied out of the current generation onto a small dense grid
+ of bytes and run until it is the same shape again.
+ Extended Wechsler notation splits the cells into strips of 5 rows. Each column of a strip is one character, the
+ cells from top to bottom being bits 0 to 4 of 0-9a-v. Runs of empty columns are written w (2), x (3) or y followed
+ by the number less 4 (4 to 39), empty columns at the end of a strip are left out and the strips are joined with z.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "soup.h"
+#include "sparse.h"
+#include "cycle.h" // mix_hash
+
+#define WECHSLER_DIGITS "0123456789abcdefghijklmnopqrstuvwxyz" // column values, and run lengths after y
+
+// Common names of the objects found most often in Conway's Game of Life
+static const char *object_names[][2] = {
+    {"xs4_33", "block"}, {"xs6_696", "beehive"}, {"xs7_2596", "loaf"}, {"xs5_253", "boat"}, {"xs6_356", "ship"},
+    {"xs4_252", "tub"}, {"xs8_6996", "pond"}, {"xs7_25ac", "long boat"}, {"xs6_25a4", "barge"},
+    {"xs8_69ic", "mango"}, {"xs6_bd", "snake"}, {"xs7_178c", "eater 1"}, {"xp2_7", "blinker"}, {"xp2_7e", "toad"},
+    {"xp2_318c", "beacon"},
+    {"xp3_co9nas0san9oczgoldlo0oldlogz1047210127401", "pulsar"}, {"xp15_4r4z4r4", "pentadecathlon"},
+    {"xq4_153", "glider"}, {"xq4_6frc", "lightweight spaceship"}, {"xq4_27dee6", "middleweight spaceship"},
+    {"xq4_27deee6", "heavyweight spaceship"},
+};
+
+#define N_OBJECT_NAMES (int)(sizeof(object_names)/sizeof(object_names[0]))
+
+// A cell of the plane
+typedef struct cell_pos{
+    long long row, col;
+}CellPos;
+
+// Define a structure with alias 'CellList' for a growable array of cells
+typedef struct cell_list{
+    CellPos *cells;
+    size_t n_cells, max_cells;
+}CellList;
+
+// One phase of an object run on its own, cropped to its bounding box
+typedef struct object_phase{
+    int n_rows, n_cols; // size of the bounding box, 0 once every cell has died
+    long long row0, col0; // position of the top left of the bounding box
+    unsigned char *cells; // n_rows*n_cols bytes, 1 alive 0 dead
+}ObjectPhase;
+
+static void push_cell(CellList *list, long long row, long long col){
+    // Append a cell to the list, growing it as needed
+    if (list->n_cells == list->max_cells){
+        list->max_cells = (list->max_cells > 0) ? 2*list->max_cells : 256;
+        list->cells = (CellPos *)realloc(list->cells, list->max_cells * sizeof(CellPos));
+        if (list->cells == NULL){
+            printf("[ERROR] Out of memory whilst taking the census\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->cells[list->n_cells].row = row;
+    list->cells[list->n_cells].col = col;
+    list->n_cells++;
+}
+
+static void plane_cells(const SparsePlane *sp, CellList *list){
+    // Append every living cell of the plane to the list
+    for (size_t k = 0; k < sp->n_chunks; k++){
+        const Chunk *chunk = sp->chunks[k];
+        for (int r = 0; r < CHUNK_SIZE; r++){
+            for (uint64_t word = chunk->cells[r]; word != 0; word &= word - 1){
+                push_cell(list, chunk->row*CHUNK_SIZE + r, chunk->col*CHUNK_SIZE + __builtin_ctzll(word));
+            }
+        }
+    }
+}
+
+static int compare_cells(const void *a, const void *b){
+    // Order cells by row then column
+    const CellPos *x = (const CellPos *)a, *y = (const CellPos *)b;
+    if (x->row != y->row){
+        return (x->row < y->row) ? -1 : 1;
+    }
+    return (x->col < y->col) ? -1 : (x->col > y->col);
+}
+
+static size_t lower_bound(const CellList *list, long long row, long long col){
+    // Index of the first cell of the sorted list at or after (row,col)
+    size_t lo = 0, hi = list->n_cells;
+    CellPos key = {row, col};
+    while (lo < hi){
+        size_t mid = (lo + hi) / 2;
+        if (compare_cells(&list->cells[mid], &key) < 0){
+            lo = mid + 1;
+        }else{
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t find_root(size_t *parent, size_t k){
+    // Root of the object holding cell k, halving the path on the way
+    while (parent[k] != k){
+        parent[k] = parent[parent[k]];
+        k = parent[k];
+    }
+    return k;
+}
+
+static uint64_t hash_code(const char *code){
+    // FNV-1a hash of an apgcode
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (; *code != '\0'; code++){
+        h = (h ^ (unsigned char)*code) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+Census* create_census(void){
+    /*
+    Creates an empty census.
+    - Error checks for memory overflow
+    */
+    Census *census = (Census *)malloc(sizeof(Census));
+    if (census != NULL){
+        census->entries = (CensusEntry *)calloc(CENSUS_TABLE_SIZE, sizeof(CensusEntry)); // calloc so every slot is empty
+    }
+    if (census == NULL || census->entries == NULL){
+        printf("[ERROR] Out of memory whilst creating the census\n");
+        exit(EXIT_FAILURE);
+    }
+    census->table_size = CENSUS_TABLE_SIZE;
+    census->n_entries = 0;
+    census->n_objects = 0;
+    return census;
+}
+
+void free_census(Census *census){
+    // Free the codes, the table and the census
+    for (size_t k = 0; k < census->table_size; k++){
+        free(census->entries[k].code);
+    }
+    free(census->entries);
+    free(census);
+}
+
+static CensusEntry* find_entry(CensusEntry *entries, size_t table_size, const char *code){
+    // Slot holding code, or the empty slot it belongs in
+    size_t k = (size_t)hash_code(code) & (table_size - 1);
+    while (entries[k].code != NULL && strcmp(entries[k].code, code) != 0){
+        k = (k + 1) & (table_size - 1);
+    }
+    return &entries[k];
+}
+
+void add_to_census(Census *census, const char *code, long long count, unsigned long long soup){
+    /*
+    Count objects found in the census.
+    Inputs: census - census to add to (declared by create_census)
+            code - apgcode of the object
+            count - number of them found
+            soup - soup they were found in (the lowest is kept for each object)
+    */
+    if (2*(census->n_entries + 1) > census->table_size){ // double the table, keeping it at most half full
+        size_t table_size = 2*census->table_size;
+        CensusEntry *entries = (CensusEntry *)calloc(table_size, sizeof(CensusEntry));
+        if (entries == NULL){
+            printf("[ERROR] Out of memory whilst taking the census\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t k = 0; k < census->table_size; k++){
+            if (census->entries[k].code != NULL){
+                *find_entry(entries, table_size, census->entries[k].code) = census->entries[k];
+            }
+        }
+        free(census->entries);
+        census->entries = entries;
+        census->table_size = table_size;
+    }
+
+    CensusEntry *entry = find_entry(census->entries, census->table_size, code);
+    if (entry->code == NULL){ // first of its kind
+        entry->code = strdup(code);
+        if (entry->code == NULL){
+            printf("[ERROR] Out of memory whilst taking the census\n");
+            exit(EXIT_FAILURE);
+        }
+        entry->count = 0;
+        entry->first_soup = soup;
+        census->n_entries++;
+    }
+    entry->count += count;
+    if (soup < entry->first_soup){
+        entry->first_soup = soup;
+    }
+    census->n_objects += count;
+}
+
+static int compare_entries(const void *a, const void *b){
+    // Order census entries by count, most common first, then by apgcode
+    const CensusEntry *x = *(const CensusEntry **)a, *y = *(const CensusEntry **)b;
+    if (x->count != y->count){
+        return (x->count > y->count) ? -1 : 1;
+    }
+    return strcmp(x->code, y->code);
+}
+
+void write_census(const Census *census, FILE *file){
+    // Write the census as CSV with a header line, one object per line, the most common first
+    const CensusEntry **sorted = (const CensusEntry **)malloc((census->n_entries + 1) * sizeof(CensusEntry *));
+    if (sorted == NULL){
+        printf("[ERROR] Out of memory whilst writing the census\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t n = 0;
+    for (size_t k = 0; k < census->table_size; k++){
+        if (census->entries[k].code != NULL){
+            sorted[n++] = &census->entries[k];
+        }
+    }
+    qsort(sorted, n, sizeof(CensusEntry *), compare_entries);
+    fprintf(file, "object,name,count,first_soup\n");
+    for (size_t k = 0; k < n; k++){
+        fprintf(file, "%s,%s,%lld,%llu\n", sorted[k]->code, object_name(sorted[k]->code), sorted[k]->count,
+                sorted[k]->first_soup);
+    }
+    free(sorted);
+}
+
+const char* object_name(const char *code){
+    // Return the common name of the object with the apgcode, "" if it has none
+    for (int k = 0; k < N_OBJECT_NAMES; k++){
+        if (strcmp(code, object_names[k][0]) == 0){
+            return object_names[k][1];
+        }
+    }
+    return "";
+}
+
+void fill_soup(const SoupSearch *search, unsigned long long soup, uint64_t *rows){
+    /*
+    Make soup number soup of the search: soup_size rows of soup_size cells, each alive with probability 1/2.
+    - Row i is the splitmix64 output for the i'th step of a stream started from the seed and soup, so the same soup
+      is made whichever thread runs it
+    */
+    uint64_t state = mix_hash(search->seed ^ mix_hash(soup + 1));
+    uint64_t mask = (search->soup_size == 64) ? ~0ULL : (1ULL << search->soup_size) - 1;
+    for (int i = 0; i < search->soup_size; i++){
+        state += HASH_STEP;
+        rows[i] = mix_hash(state) & mask;
+    }
+}
+
+static void crop_phase(ObjectPhase *phase, const unsigned char *grid, int n_rows, int n_cols, long long row0,
+                       long long col0){
+    // Set the phase to the living cells of a n_rows*n_cols grid with its top left at (row0,col0), cropped
+    int top = n_rows, bottom = -1, left = n_cols, right = -1;
+    for (int i = 0; i < n_rows; i++){
+        for (int j = 0; j < n_cols; j++){
+            if (grid[i*n_cols + j]){
+                top = (i < top) ? i : top;
+                bottom = i;
+                left = (j < left) ? j : left;
+                right = (j > right) ? j : right;
+            }
+        }
+    }
+    free(phase->cells);
+    phase->cells = NULL;
+    if (bottom < 0){ // every cell has died
+        phase->n_rows = phase->n_cols = 0;
+        return;
+    }
+    phase->n_rows = bottom - top + 1;
+    phase->n_cols = right - left + 1;
+    phase->row0 = row0 + top;
+    phase->col0 = col0 + left;
+    phase->cells = (unsigned char *)malloc((size_t)phase->n_rows * phase->n_cols);
+    if (phase->cells == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < phase->n_rows; i++){
+        memcpy(phase->cells + (size_t)i*phase->n_cols, grid + (size_t)(top + i)*n_cols + left, (size_t)phase->n_cols);
+    }
+}
+
+static void step_phase(const ObjectPhase *phase, ObjectPhase *next, unsigned birth_mask, unsigned survive_mask){
+    // Set next to the generation after phase, the object alone on an empty plane
+    int n_rows = phase->n_rows + 2, n_cols = phase->n_cols + 2; // births reach one cell beyond the bounding box
+    unsigned char *grid = (unsigned char *)calloc((size_t)n_rows * n_cols, 1);
+    if (grid == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n_rows; i++){
+        for (int j = 0; j < n_cols; j++){
+            int n = 0, alive = 0; // living neighbours, and the cell itself, in phase coords (i-1,j-1)
+            for (int di = -2; di <= 0; di++){
+                for (int dj = -2; dj <= 0; dj++){
+                    int r = i + di, c = j + dj;
+                    if (r >= 0 && r < phase->n_rows && c >= 0 && c < phase->n_cols && phase->cells[r*phase->n_cols + c]){
+                        if (di == -1 && dj == -1){
+                            alive = 1;
+                        }else{
+                            n++;
+                        }
+                    }
+                }
+            }
+            grid[i*n_cols + j] = (unsigned char)((((alive ? survive_mask : birth_mask) >> n) & 1));
+        }
+    }
+    crop_phase(next, grid, n_rows, n_cols, phase->row0 - 1, phase->col0 - 1);
+    free(grid);
+}
+
+static int same_shape(const ObjectPhase *a, const ObjectPhase *b){
+    // 1 if the phases have the same living cells up to a translation
+    return a->n_rows == b->n_rows && a->n_cols == b->n_cols
+           && memcmp(a->cells, b->cells, (size_t)a->n_rows * a->n_cols) == 0;
+}
+
+static char* wechsler(const ObjectPhase *phase, int symmetry){
+    /*
+    Return the object in extended Wechsler notation (malloc'd), after one of the 8 symmetries of the square:
+    bit 2 of symmetry swaps rows and columns, then bit 0 flips the rows and bit 1 the columns.
+    */
+    int transpose = (symmetry >> 2) & 1;
+    int n_rows = transpose ? phase->n_cols : phase->n_rows, n_cols = transpose ? phase->n_rows : phase->n_cols;
+    char *text = (char *)malloc((size_t)(n_rows / 5 + 1) * (n_cols + 1) + 1);
+    if (text == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    for (int strip = 0; strip < n_rows; strip += 5){
+        if (strip > 0){
+            text[n++] = 'z';
+        }
+        int zeros = 0; // empty columns not yet written
+        for (int j = 0; j < n_cols; j++){
+            int value = 0;
+            for (int k = 0; k < 5 && strip + k < n_rows; k++){
+                int r = transpose ? j : strip + k, c = transpose ? strip + k : j; // cell in phase coords
+                if (symmetry & 1){
+                    r = phase->n_rows - 1 - r;
+                }
+                if (symmetry & 2){
+                    c = phase->n_cols - 1 - c;
+                }
+                value |= phase->cells[r*phase->n_cols + c] << k;
+            }
+            if (value == 0){
+                zeros++;
+                continue;
+            }
+            while (zeros > 0){
+                if (zeros >= 4){
+                    int run = (zeros > 39) ? 39 : zeros;
+                    text[n++] = 'y';
+                    text[n++] = WECHSLER_DIGITS[run - 4];
+                    zeros -= run;
+                }else{
+                    text[n++] = (zeros == 3) ? 'x' : (zeros == 2) ? 'w' : '0';
+                    zeros = 0;
+                }
+            }
+            text[n++] = WECHSLER_DIGITS[value];
+        }
+    }
+    text[n] = '\0';
+    return text;
+}
+
+static void make_phase(ObjectPhase *phase, const CellPos *cells, size_t n_cells){
+    // Set the phase to a list of at least one cell
+    long long row0 = cells[0].row, col0 = cells[0].col, row1 = row0, col1 = col0;
+    for (size_t k = 1; k < n_cells; k++){
+        row0 = (cells[k].row < row0) ? cells[k].row : row0;
+        row1 = (cells[k].row > row1) ? cells[k].row : row1;
+        col0 = (cells[k].col < col0) ? cells[k].col : col0;
+        col1 = (cells[k].col > col1) ? cells[k].col : col1;
+    }
+    phase->n_rows = (int)(row1 - row0 + 1);
+    phase->n_cols = (int)(col1 - col0 + 1);
+    phase->row0 = row0;
+    phase->col0 = col0;
+    phase->cells = (unsigned char *)calloc((size_t)phase->n_rows * phase->n_cols, 1);
+    if (phase->cells == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < n_cells; k++){
+        phase->cells[(cells[k].row - row0)*phase->n_cols + (cells[k].col - col0)] = 1;
+    }
+}
+
+static long long phase_population(const ObjectPhase *phase){
+    // Number of living cells of the phase
+    long long n = 0;
+    for (long long k = 0; k < (long long)phase->n_rows * phase->n_cols; k++){
+        n += phase->cells[k];
+    }
+    return n;
+}
+
+static int inside(const ObjectPhase *part, const ObjectPhase *whole){
+    // 1 if every living cell of part is alive in whole
+    for (int i = 0; i < part->n_rows; i++){
+        for (int j = 0; j < part->n_cols; j++){
+            long long r = part->row0 + i - whole->row0, c = part->col0 + j - whole->col0;
+            if (part->cells[i*part->n_cols + j]
+                && (r < 0 || r >= whole->n_rows || c < 0 || c >= whole->n_cols || !whole->cells[r*whole->n_cols + c])){
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int independent(const CellList *a, const CellList *b, int n_generations, unsigned birth_mask,
+                       unsigned survive_mask){
+    // 1 if two groups of cells run together for n_generations are the same as each run on its own, laid over each other
+    ObjectPhase phases[3] = {{0, 0, 0, 0, NULL}, {0, 0, 0, 0, NULL}, {0, 0, 0, 0, NULL}}; // a, b, both
+    ObjectPhase next = {0, 0, 0, 0, NULL};
+    CellList both = {NULL, 0, 0};
+    for (size_t k = 0; k < a->n_cells; k++){
+        push_cell(&both, a->cells[k].row, a->cells[k].col);
+    }
+    for (size_t k = 0; k < b->n_cells; k++){
+        push_cell(&both, b->cells[k].row, b->cells[k].col);
+    }
+    make_phase(&phases[0], a->cells, a->n_cells);
+    make_phase(&phases[1], b->cells, b->n_cells);
+    make_phase(&phases[2], both.cells, both.n_cells);
+    free(both.cells);
+
+    int same = 1;
+    for (int t = 0; t < n_generations && same; t++){
+        for (int k = 0; k < 3; k++){
+            if (phases[k].n_rows > 0){
+                step_phase(&phases[k], &next, birth_mask, survive_mask);
+                ObjectPhase swap = phases[k];
+                phases[k] = next;
+                next = swap;
+            }
+        }
+        for (int k = 0; k < 2 && same; k++){
+            same = (phases[k].n_rows == 0 || inside(&phases[k], &phases[2]));
+        }
+        same = same && phase_population(&phases[2]) == phase_population(&phases[0]) + phase_population(&phases[1]);
+    }
+    for (int k = 0; k < 3; k++){
+        free(phases[k].cells);
+    }
+    free(next.cells);
+    return same;
+}
+
+static char* classify_object(const CellPos *cells, size_t n_cells, unsigned birth_mask, unsigned survive_mask){
+    /*
+    Run an object on its own until it is the same shape again and return its apgcode (malloc'd), zz_UNKNOWN if it
+    does not repeat within OBJECT_MAX_PERIOD generations.
+    - The code is the shortest, then alphabetically first, Wechsler code over every phase and symmetry
+    */
+    ObjectPhase phases[OBJECT_MAX_PERIOD + 1];
+    memset(phases, 0, sizeof(phases));
+    make_phase(&phases[0], cells, n_cells);
+
+    int period = 0;
+    for (int t = 1; t <= OBJECT_MAX_PERIOD && period == 0; t++){
+        step_phase(&phases[t-1], &phases[t], birth_mask, survive_mask);
+        if (phases[t].n_rows == 0 || (long long)phases[t].n_rows * phases[t].n_cols > OBJECT_MAX_CELLS){ // died or grew
+            break;
+        }
+        if (same_shape(&phases[t], &phases[0])){
+            period = t;
+        }
+    }
+
+    char *code = NULL;
+    if (period == 0){
+        code = strdup("zz_UNKNOWN");
+    }else{
+        char *best = NULL;
+        for (int t = 0; t < period; t++){
+            for (int symmetry = 0; symmetry < 8; symmetry++){
+                char *text = wechsler(&phases[t], symmetry);
+                if (best == NULL || strlen(text) < strlen(best) || (strlen(text) == strlen(best) && strcmp(text, best) < 0)){
+                    free(best);
+                    best = text;
+                }else{
+                    free(text);
+                }
+            }
+        }
+        int moved = (phases[period].row0 != phases[0].row0 || phases[period].col0 != phases[0].col0);
+        char prefix[32];
+        if (period == 1){
+            snprintf(prefix, sizeof(prefix), "xs%zu_", n_cells);
+        }else{
+            snprintf(prefix, sizeof(prefix), "x%c%d_", moved ? 'q' : 'p', period);
+        }
+        code = (char *)malloc(strlen(prefix) + strlen(best) + 1);
+        if (code != NULL){
+            strcpy(code, prefix);
+            strcat(code, best);
+        }
+        free(best);
+    }
+    if (code == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t <= OBJECT_MAX_PERIOD; t++){
+        free(phases[t].cells);
+    }
+    return code;
+}
+
+static void census_ash(SparsePlane *sp, int period, const SoupSearch *search, unsigned long long soup, Census *census){
+    /*
+    Split the settled ash of a soup into objects and add them to the census.
+    - The cells of the current generation and the following ones (at least two periods of the population, and a
+      full period of a glider) are joined into pieces of touching cells, so every phase of an oscillator stays in
+      one piece. Pieces within 2 of each other are one object if they change each other when run together
+    - sp is stepped on past the current generation
+    */
+    CellList current = {NULL, 0, 0}, all = {NULL, 0, 0};
+    plane_cells(sp, &current);
+    if (current.n_cells == 0){
+        return;
+    }
+    for (size_t k = 0; k < current.n_cells; k++){
+        push_cell(&all, current.cells[k].row, current.cells[k].col);
+    }
+    int n_phases = (2*period > 8) ? 2*period : 8;
+    for (int t = 1; t < n_phases; t++){
+        step_sparse(sp, search->birth_mask, search->survive_mask, NULL);
+        plane_cells(sp, &all);
+    }
+    qsort(all.cells, all.n_cells, sizeof(CellPos), compare_cells);
+    size_t n = 0;
+    for (size_t k = 0; k < all.n_cells; k++){ // drop cells alive in more than one phase
+        if (n == 0 || compare_cells(&all.cells[k], &all.cells[n-1]) != 0){
+            all.cells[n++] = all.cells[k];
+        }
+    }
+    all.n_cells = n;
+
+    CellList pairs = {NULL, 0, 0}; // pieces within 2 of each other, as (lower root, higher root)
+    size_t *parent = (size_t *)malloc(all.n_cells * sizeof(size_t));
+    size_t *object = (size_t *)malloc(current.n_cells * sizeof(size_t));
+    if (parent == NULL || object == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < all.n_cells; k++){
+        parent[k] = k;
+    }
+    for (int reach = 1; reach <= 2; reach++){ // join touching cells into pieces, then find the pieces within 2
+        for (size_t k = 0; k < all.n_cells; k++){ // cells within reach below or to the right of cell k
+            for (long long dr = 0; dr <= reach; dr++){
+                long long row = all.cells[k].row + dr, col = all.cells[k].col;
+                for (size_t m = lower_bound(&all, row, (dr == 0) ? col + 1 : col - reach);
+                     m < all.n_cells && all.cells[m].row == row && all.cells[m].col <= col + reach; m++){
+                    size_t a = find_root(parent, k), b = find_root(parent, m);
+                    if (a != b && reach == 1){
+                        parent[(a > b) ? a : b] = (a > b) ? b : a;
+                    }else if (a != b){
+                        push_cell(&pairs, (long long)((a < b) ? a : b), (long long)((a < b) ? b : a));
+                    }
+                }
+            }
+        }
+    }
+    for (size_t k = 0; k < current.n_cells; k++){ // piece of each current cell
+        object[k] = find_root(parent, lower_bound(&all, current.cells[k].row, current.cells[k].col));
+    }
+
+    // Pieces within 2 of each other are one object unless each runs the same on its own
+    qsort(pairs.cells, pairs.n_cells, sizeof(CellPos), compare_cells);
+    CellList piece[2] = {{NULL, 0, 0}, {NULL, 0, 0}};
+    for (size_t k = 0; k < pairs.n_cells; k++){
+        if (k > 0 && compare_cells(&pairs.cells[k], &pairs.cells[k-1]) == 0){
+            continue;
+        }
+        size_t a = (size_t)pairs.cells[k].row, b = (size_t)pairs.cells[k].col;
+        if (find_root(parent, a) == find_root(parent, b)){
+            continue;
+        }
+        piece[0].n_cells = piece[1].n_cells = 0;
+        for (size_t m = 0; m < current.n_cells; m++){
+            if (object[m] == a || object[m] == b){
+                push_cell(&piece[object[m] == b], current.cells[m].row, current.cells[m].col);
+            }
+        }
+        if (piece[0].n_cells == 0 || piece[1].n_cells == 0
+            || !independent(&piece[0], &piece[1], n_phases, search->birth_mask, search->survive_mask)){
+            a = find_root(parent, a);
+            b = find_root(parent, b);
+            parent[(a > b) ? a : b] = (a > b) ? b : a;
+        }
+    }
+    free(piece[0].cells);
+    free(piece[1].cells);
+    free(pairs.cells);
+
+    // Group the current cells by object, run each object on its own and count it
+    for (size_t k = 0; k < current.n_cells; k++){
+        object[k] = find_root(parent, object[k]);
+    }
+    CellPos *cells = (CellPos *)malloc(current.n_cells * sizeof(CellPos));
+    char *done = (char *)calloc(current.n_cells, 1);
+    if (cells == NULL || done == NULL){
+        printf("[ERROR] Out of memory whilst taking the census\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t k = 0; k < current.n_cells; k++){
+        if (done[k]){
+            continue;
+        }
+        size_t n_cells = 0;
+        for (size_t m = k; m < current.n_cells; m++){
+            if (!done[m] && object[m] == object[k]){
+                cells[n_cells++] = current.cells[m];
+                done[m] = 1;
+            }
+        }
+        char *code = classify_object(cells, n_cells, search->birth_mask, search->survive_mask);
+        add_to_census(census, code, 1, soup);
+        free(code);
+    }
+    free(cells);
+    free(done);
+    free(parent);
+    free(object);
+    free(current.cells);
+    free(all.cells);
+}
+
+static int settled_period(const long long *populations, long long generation){
+    // Period (up to SOUP_MAX_PERIOD) the population has repeated with for the last SOUP_SETTLE generations, 0 if none
+    if (generation < SOUP_SETTLE + SOUP_MAX_PERIOD){
+        return 0;
+    }
+    for (int period = 1; period <= SOUP_MAX_PERIOD; period++){
+        long long g = generation;
+        while (g > generation - SOUP_SETTLE && populations[g] == populations[g - period]){
+            g--;
+        }
+        if (g == generation - SOUP_SETTLE){
+            return period;
+        }
+    }
+    return 0;
+}
+
+static long long run_soup(const SoupSearch *search, unsigned long long soup, long long *populations, Census *census){
+    /*
+    Run one soup until it settles and add its ash to the census (or count it as zz_UNSTABLE).
+    Return the number of generations run.
+    Inputs: populations - space for max_generations+1 populations
+    */
+    uint64_t rows[SOUP_MAX_SIZE];
+    fill_soup(search, soup, rows);
+    SparsePlane *sp = create_sparse();
+    for (int i = 0; i < search->soup_size; i++){
+        for (uint64_t word = rows[i]; word != 0; word &= word - 1){
+            set_sparse_cell(sp, i, __builtin_ctzll(word), ALIVE);
+        }
+    }
+    populations[0] = count_sparse(sp);
+
+    long long generation = 0;
+    int period = 0;
+    while (generation < search->max_generations && period == 0){
+        generation++;
+        populations[generation] = step_sparse(sp, search->birth_mask, search->survive_mask, NULL);
+        period = settled_period(populations, generation);
+    }
+    if (period > 0){
+        census_ash(sp, period, search, soup, census);
+    }else{
+        add_to_census(census, "zz_UNSTABLE", 1, soup);
+    }
+    free_sparse(sp);
+    return generation;
+}
+
+// Range of soups still to be run by one thread
+typedef struct soup_range{
+    pthread_mutex_t lock;
+    long long next, end; // soups next to end-1 are left
+}SoupRange;
+
+// Shared by the threads of run_soup_search
+typedef struct soup_task{
+    SoupSearch *search;
+    SoupRange *ranges; // one for each thread
+    Census **censuses; // one for each thread
+    long long *n_generations; // generations run by each thread
+}SoupTask;
+
+static int take_soup(SoupTask *task, int thread, int n_threads, long long *soup){
+    /*
+    Take the next soup for a thread from its own range. Once that is empty, steal the top half of the largest range
+    left (or the last soup of it) and carry on from there. Return 0 once every soup has been taken.
+    */
+    SoupRange *own = &task->ranges[thread];
+    pthread_mutex_lock(&own->lock);
+    int found = (own->next < own->end);
+    if (found){
+        *soup = own->next++;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    while (!found){
+        int victim = -1;
+        long long most = 0; // soups left in the largest range
+        for (int k = 0; k < n_threads; k++){
+            pthread_mutex_lock(&task->ranges[k].lock);
+            long long left = task->ranges[k].end - task->ranges[k].next;
+            pthread_mutex_unlock(&task->ranges[k].lock);
+            if (left > most){
+                most = left;
+                victim = k;
+            }
+        }
+        if (victim < 0){ // nothing left to steal
+            return 0;
+        }
+        SoupRange *range = &task->ranges[victim];
+        long long begin = 0, end = 0;
+        pthread_mutex_lock(&range->lock);
+        long long left = range->end - range->next; // may have changed since it was looked at
+        if (left > 0){
+            begin = range->end - (left + 1) / 2;
+            end = range->end;
+            range->end = begin;
+        }
+        pthread_mutex_unlock(&range->lock);
+        if (begin < end){
+            *soup = begin;
+            pthread_mutex_lock(&own->lock);
+            own->next = begin + 1;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+            found = 1;
+        }
+    }
+    return 1;
+}
+
+static void soup_thread(void *arg, int thread, int n_threads){
+    // Run soups until there are none left to take
+    SoupTask *task = (SoupTask *)arg;
+    long long *populations = (long long *)malloc((size_t)(task->search->max_generations + 1) * sizeof(long long));
+    if (populations == NULL){
+        printf("[ERROR] Out of memory whilst running soups\n");
+        exit(EXIT_FAILURE);
+    }
+    long long soup;
+    task->n_generations[thread] = 0;
+    while (take_soup(task, thread, n_threads, &soup)){
+        task->n_generations[thread] += run_soup(task->search, (unsigned long long)soup, populations,
+                                                task->censuses[thread]);
+    }
+    free(populations);
+}
+
+void run_soup_search(SoupSearch *search, ThreadPool *pool){
+    /*
+    Run soups 0 to n_soups-1 of the search and take the census of their ash.
+    Inputs: search - settings of the search, its census and totals are set once every soup has been run
+            pool - threads to run soups on (NULL for a single thread)
+    */
+    int n_threads = (pool != NULL) ? pool->n_threads : 1;
+    SoupRange ranges[n_threads];
+    Census *censuses[n_threads];
+    long long n_generations[n_threads];
+    for (int k = 0; k < n_threads; k++){ // equal shares to start with
+        pthread_mutex_init(&ranges[k].lock, NULL);
+        ranges[k].next = search->n_soups * k / n_threads;
+        ranges[k].end = search->n_soups * (k + 1) / n_threads;
+        censuses[k] = create_census();
+    }
+    SoupTask task = {search, ranges, censuses, n_generations};
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run_thread_pool(pool, soup_thread, &task);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    search->seconds = (double)(end.tv_sec - start.tv_sec) + 1e-9*(double)(end.tv_nsec - start.tv_nsec);
+
+    search->census = create_census();
+    search->n_generations = 0;
+    for (int k = 0; k < n_threads; k++){ // merge the census of each thread
+        for (size_t m = 0; m < censuses[k]->table_size; m++){
+            const CensusEntry *entry = &censuses[k]->entries[m];
+            if (entry->code != NULL){
+                add_to_census(search->census, entry->code, entry->count, entry->first_soup);
+            }
+        }
+        search->n_generations += n_generations[k];
+        free_census(censuses[k]);
+        pthread_mutex_destroy(&ranges[k].lock);
+    }
+    CensusEntry *unstable = find_entry(search->census->entries, search->census->table_size, "zz_UNSTABLE");
+    search->n_unstable = (unstable->code != NULL) ? unstable->count : 0;
+}
@@ -0,0 +1,79 @@
+/*
+* Soup search and census for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Runs many random soups (soup_size x soup_size squares of cells, each alive with probability 1/2) on the
+              unbounded plane until they settle into ash, then splits the ash into objects and counts every kind
+              of object found in a census, in the manner of apgsearch.
+                - Soup k of a search is made from the seed and k alone, so any soup can be rerun on its own and the
+                  census does not depend on the number of threads
+                - A soup has settled once its population has repeated with a period of up to SOUP_MAX_PERIOD for
+                  SOUP_SETTLE generations. Soups still changing after max_generations are counted as zz_UNSTABLE
+                - The living cells over the next few generations are grouped into objects: touching cells, and
+                  groups close enough to change each other when run together. Each object is run on its own to find its period and how far
+                  it moves, and named by its apgcode: xs<cells>_ for still lifes, xp<period>_ for oscillators and
+                  xq<period>_ for spaceships, followed by its cells in extended Wechsler notation for the phase and
+                  orientation giving the shortest (then alphabetically first) code. Objects which do not repeat
+                  within OBJECT_MAX_PERIOD generations are counted as zz_UNKNOWN
+              Every thread of the pool runs whole soups. The soups are dealt out in equal ranges, and a thread which
+              finishes its range steals half of what is left of the largest remaining range, so threads stay busy
+              when some soups take far longer than others. Each thread keeps its own census, merged at the end.
+ */
+
+#ifndef SOUP_H
+#define SOUP_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "thread_pool.h"
+
+#define SOUP_SIZE 16 // Default rows and columns of each soup
+#define SOUP_MAX_SIZE 64 // Largest soup (one word per row)
+#define SOUP_MAX_GENERATIONS 10000 // Default generations a soup is run for before it is given up as unstable
+#define SOUP_MAX_PERIOD 30 // Longest period of the population of settled ash
+#define SOUP_SETTLE 120 // Generations the population must repeat for before the soup is taken to have settled
+#define OBJECT_MAX_PERIOD 64 // Longest period of an object run on its own
+#define OBJECT_MAX_CELLS 4096 // Objects run on their own which grow past this many cells are given up
+#define CENSUS_TABLE_SIZE 256 // Initial slots in the census hash table (power of 2)
+
+// Define a structure with alias 'CensusEntry' for one kind of object and how often it was found
+typedef struct census_entry{
+    char *code; // apgcode of the object (NULL for an empty slot)
+    long long count; // number found
+    unsigned long long first_soup; // lowest numbered soup it was found in
+}CensusEntry;
+
+// Define a structure with alias 'Census' for the objects found, an open-addressing hash table keyed by apgcode
+typedef struct census{
+    CensusEntry *entries; // table_size slots, linear probing
+    size_t table_size; // power of 2, kept at least twice n_entries
+    size_t n_entries; // kinds of object
+    long long n_objects; // objects counted
+}Census;
+
+// Define a structure with alias 'SoupSearch' for the settings and results of a soup search
+typedef struct soup_search{
+    unsigned long long seed; // soup k is made from seed and k
+    long long n_soups; // soups 0 to n_soups-1 are run
+    int soup_size; // rows and columns of each soup
+    long long max_generations; // generations a soup is run for before it is given up
+    unsigned birth_mask, survive_mask; // the game rule (see parse_rule), without B0
+    Census *census; // objects found in every soup, set by run_soup_search
+    long long n_unstable; // soups still changing after max_generations
+    long long n_generations; // generations run over every soup
+    double seconds; // time taken
+}SoupSearch;
+
+// Prototype function definitions
+Census* create_census(void); // empty census
+void free_census(Census *census);
+void add_to_census(Census *census, const char *code, long long count, unsigned long long soup);
+void write_census(const Census *census, FILE *file); // CSV, the most common objects first
+const char* object_name(const char *code); // common name of the object, "" if it has none
+void fill_soup(const SoupSearch *search, unsigned long long soup, uint64_t *rows); // soup_size words, bit j for column j
+void run_soup_search(SoupSearch *search, ThreadPool *pool);
+
+#endif // SOUP_H
@@ -0,0 +1,416 @@
+/*
+* Unbounded sparse plane for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ A generation is calculated in three passes:
+ 1) Every chunk with a living cell on an edge or corner makes sure the chunk on the other side exists, as births
+    can happen there. A cell can only be born next to a living cell, so no other empty chunk can change.
+ 2) Every chunk calculates its next generation from its own cells and the edges of its 8 neighbours (missing
+    neighbours are dead), using the same bit-sliced adders as the bit-packed board. The chunks are only read,
+    so this pass is split between the threads.
+ 3) The next generation becomes the current one and the chunks left empty are freed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sparse.h"
+#include "bitboard_kernel.h"
+
+#define SPARSE_MIN_TABLE 64 // smallest number of slots in the hash table
+
+static size_t hash_coords(long long row, long long col){
+    // Mix the chunk coords into a hash value
+    uint64_t h = (uint64_t)row * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)col * 0xC2B2AE3D27D4EB4FULL;
+    return (size_t)(h ^ (h >> 29) ^ (h >> 47));
+}
+
+static Chunk* find_chunk(const SparsePlane *sp, long long row, long long col){
+    // Return the chunk at chunk coords (row,col), NULL if it has not been allocated
+    size_t mask = sp->table_size - 1;
+    for (size_t slot = hash_coords(row, col) & mask; sp->table[slot] != NULL; slot = (slot+1) & mask){
+        if (sp->table[slot]->row == row && sp->table[slot]->col == col){
+            return sp->table[slot];
+        }
+    }
+    return NULL;
+}
+
+static void insert_slot(SparsePlane *sp, Chunk *chunk){
+    // Put a chunk in the first free slot from its hash value
+    size_t mask = sp->table_size - 1;
+    size_t slot = hash_coords(chunk->row, chunk->col) & mask;
+    while (sp->table[slot] != NULL){
+        slot = (slot+1) & mask;
+    }
+    sp->table[slot] = chunk;
+}
+
+static void resize_table(SparsePlane *sp, size_t table_size){
+    // Move every chunk into a new hash table with table_size slots (power of 2)
+    free(sp->table);
+    sp->table = (Chunk **)calloc(table_size, sizeof(Chunk *));
+    if (sp->table == NULL){
+        printf("[ERROR] Out of memory whilst resizing the sparse plane\n");
+        exit(EXIT_FAILURE);
+    }
+    sp->table_size = table_size;
+    for (size_t k = 0; k < sp->n_chunks; k++){
+        insert_slot(sp, sp->chunks[k]);
+    }
+}
+
+static Chunk* add_chunk(SparsePlane *sp, long long row, long long col){
+    /*
+    Allocate an empty chunk at chunk coords (row,col) and add it to the plane.
+    - The hash table is doubled when more than half full and the chunks array when full
+    - Error checks for memory
+    */
+    Chunk *chunk = (Chunk *)calloc(1, sizeof(Chunk)); // calloc so all cells start dead
+    if (chunk == NULL){
+        printf("[ERROR] Out of memory whilst adding a chunk to the sparse plane\n");
+        exit(EXIT_FAILURE);
+    }
+    chunk->row = row;
+    chunk->col = col;
+
+    if (sp->n_chunks == sp->max_chunks){
+        sp->max_chunks = (sp->max_chunks > 0) ? 2*sp->max_chunks : SPARSE_MIN_TABLE/2;
+        Chunk **chunks = (Chunk **)realloc(sp->chunks, sp->max_chunks * sizeof(Chunk *));
+        if (chunks == NULL){
+            printf("[ERROR] Out of memory whilst adding a chunk to the sparse plane\n");
+            exit(EXIT_FAILURE);
+        }
+        sp->chunks = chunks;
+    }
+    chunk->index = sp->n_chunks;
+    sp->chunks[sp->n_chunks++] = chunk;
+
+    if (2*sp->n_chunks > sp->table_size){
+        resize_table(sp, 2*sp->table_size); // also inserts the new chunk
+    }else{
+        insert_slot(sp, chunk);
+    }
+    return chunk;
+}
+
+static void remove_chunk(SparsePlane *sp, Chunk *chunk){
+    /*
+    Remove a chunk from the plane and free it.
+    - Slots after it in the same run are shifted back so that linear probing still finds every chunk
+    - The last chunk in the chunks array takes its place
+    */
+    size_t mask = sp->table_size - 1;
+    size_t slot = hash_coords(chunk->row, chunk->col) & mask;
+    while (sp->table[slot] != chunk){
+        slot = (slot+1) & mask;
+    }
+    size_t hole = slot;
+    for (slot = (hole+1) & mask; sp->table[slot] != NULL; slot = (slot+1) & mask){
+        size_t home = hash_coords(sp->table[slot]->row, sp->table[slot]->col) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)){ // the chunk may move back into the hole
+            sp->table[hole] = sp->table[slot];
+            hole = slot;
+        }
+    }
+    sp->table[hole] = NULL;
+
+    Chunk *last = sp->chunks[--sp->n_chunks];
+    sp->chunks[chunk->index] = last;
+    last->index = chunk->index;
+    free(chunk);
+}
+
+SparsePlane* create_sparse(void){
+    /*
+    Creates an empty plane (no chunks allocated).
+    - Error checks for memory overflow
+    - Return pointer to the plane
+    */
+    SparsePlane *sp = (SparsePlane *)malloc(sizeof(SparsePlane));
+    if (sp == NULL){
+        printf("[ERROR] Out of memory whilst creating the sparse plane\n");
+        exit(EXIT_FAILURE);
+    }
+    sp->table = NULL;
+    sp->chunks = NULL;
+    sp->n_chunks = 0;
+    sp->max_chunks = 0;
+    clear_step_counts(&sp->counts);
+    sp->count_changes = 0;
+    resize_table(sp, SPARSE_MIN_TABLE);
+    return sp;
+}
+
+void free_sparse(SparsePlane *sp){
+    // Free every chunk and the plane
+    for (size_t k = 0; k < sp->n_chunks; k++){
+        free(sp->chunks[k]);
+    }
+    free(sp->chunks);
+    free(sp->table);
+    free(sp);
+}
+
+void set_sparse_cell(SparsePlane *sp, long long row, long long col, int alive){
+    // Set the state (ALIVE or DEAD) of the cell at (row,col), allocating its chunk if needed
+    long long chunk_row = row >> 6, chunk_col = col >> 6; // floor division by CHUNK_SIZE, also for negative coords
+    Chunk *chunk = find_chunk(sp, chunk_row, chunk_col);
+    uint64_t bit = 1ULL << (col & (CHUNK_SIZE-1));
+    if (alive == ALIVE){
+        if (chunk == NULL){
+            chunk = add_chunk(sp, chunk_row, chunk_col);
+        }
+        chunk->cells[row & (CHUNK_SIZE-1)] |= bit;
+    }else if (chunk != NULL){ // an empty chunk is freed by the next step
+        chunk->cells[row & (CHUNK_SIZE-1)] &= ~bit;
+    }
+}
+
+int get_sparse_cell(const SparsePlane *sp, long long row, long long col){
+    // Return the state (ALIVE or DEAD) of the cell at (row,col)
+    const Chunk *chunk = find_chunk(sp, row >> 6, col >> 6);
+    if (chunk == NULL){
+        return DEAD;
+    }
+    return (chunk->cells[row & (CHUNK_SIZE-1)] >> (col & (CHUNK_SIZE-1))) & 1;
+}
+
+long long count_sparse(const SparsePlane *sp){
+    // Return the number of living cells on the plane
+    long long cells_alive = 0;
+    for (size_t k = 0; k < sp->n_chunks; k++){
+        for (int r = 0; r < CHUNK_SIZE; r++){
+            cells_alive += __builtin_popcountll(sp->chunks[k]->cells[r]);
+        }
+    }
+    return cells_alive;
+}
+
+SparsePlane* sparse_from_cells(const Board *board){
+    /*
+    Create a plane holding the living cells of a board of Cells, with cell (i,j) of the board at row i, column j.
+    Inputs: board - pointer to the board (declared by create_board)
+    */
+    SparsePlane *sp = create_sparse();
+    for (int i = 0; i < board->n_rows; i++){
+        for (int j = 0; j < board->n_cols; j++){
+            if (CELL(board,i,j).alive == ALIVE){
+                set_sparse_cell(sp, i, j, ALIVE);
+            }
+        }
+    }
+    return sp;
+}
+
+void sparse_to_cells(const SparsePlane *sp, Board *board, long long row0, long long col0){
+    /*
+    Copy a window of the plane into a board of Cells, cell (i,j) of the board taking the cell at (row0+i, col0+j).
+    Inputs: sp - plane to copy from
+            board - pointer to the board (declared by create_board)
+            row0, col0 - coords of the top left cell of the window
+    - Only the chunks overlapping the window are looked up, missing chunks are dead
+    */
+    for (int i = 0; i < board->n_rows; i++){
+        for (int j = 0; j < board->n_cols; j++){
+            CELL(board,i,j).alive = DEAD;
+        }
+    }
+    for (long long chunk_row = row0 >> 6; chunk_row <= (row0 + board->n_rows - 1) >> 6; chunk_row++){
+        for (long long chunk_col = col0 >> 6; chunk_col <= (col0 + board->n_cols - 1) >> 6; chunk_col++){
+            const Chunk *chunk = find_chunk(sp, chunk_row, chunk_col);
+            if (chunk == NULL){
+                continue;
+            }
+            for (int r = 0; r < CHUNK_SIZE; r++){
+                long long i = chunk_row*CHUNK_SIZE + r - row0;
+                uint64_t word = chunk->cells[r];
+                while (word != 0 && i >= 0 && i < board->n_rows){ // visit the living cells of the row only
+                    long long j = chunk_col*CHUNK_SIZE + __builtin_ctzll(word) - col0;
+                    if (j >= 0 && j < board->n_cols){
+                        CELL(board,i,j).alive = ALIVE;
+                    }
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+}
+
+void sparse_to_bitboard(const SparsePlane *sp, BitBoard *bb, long long row0, long long col0){
+    /*
+    Copy a window of the plane into a bit-packed board, cell (i,j) of the board taking the cell at (row0+i, col0+j).
+    Inputs: sp - plane to copy from
+            bb - bit-packed board (declared by create_bitboard), all its cells are overwritten
+            row0, col0 - coords of the top left cell of the window
+    */
+    memset(bb->cells, 0, (size_t)bb->n_rows * bb->n_words * sizeof(uint64_t));
+    for (long long chunk_row = row0 >> 6; chunk_row <= (row0 + bb->n_rows - 1) >> 6; chunk_row++){
+        for (long long chunk_col = col0 >> 6; chunk_col <= (col0 + bb->n_cols - 1) >> 6; chunk_col++){
+            const Chunk *chunk = find_chunk(sp, chunk_row, chunk_col);
+            if (chunk == NULL){
+                continue;
+            }
+            for (int r = 0; r < CHUNK_SIZE; r++){
+                long long i = chunk_row*CHUNK_SIZE + r - row0;
+                for (uint64_t word = (i >= 0 && i < bb->n_rows) ? chunk->cells[r] : 0; word != 0; word &= word - 1){
+                    long long j = chunk_col*CHUNK_SIZE + __builtin_ctzll(word) - col0;
+                    if (j >= 0 && j < bb->n_cols){
+                        set_bitboard_cell(bb, (int)i, (int)j, ALIVE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void add_neighbour_chunks(SparsePlane *sp, const Chunk *chunk){
+    // Allocate the missing chunks next to the edges and corners of chunk which have living cells
+    uint64_t columns = 0; // bit j set if any row has a living cell in column j
+    for (int r = 0; r < CHUNK_SIZE; r++){
+        columns |= chunk->cells[r];
+    }
+    int has_west = columns & 1, has_east = (columns >> (CHUNK_SIZE-1)) & 1;
+    uint64_t top = chunk->cells[0], bottom = chunk->cells[CHUNK_SIZE-1];
+    int needed[3][3] = { // [row offset+1][col offset+1]
+        {(int)(top & 1), top != 0, (int)(top >> (CHUNK_SIZE-1))},
+        {has_west, 0, has_east},
+        {(int)(bottom & 1), bottom != 0, (int)(bottom >> (CHUNK_SIZE-1))}
+    };
+    long long row = chunk->row, col = chunk->col;
+    for (int di = -1; di <= 1; di++){
+        for (int dj = -1; dj <= 1; dj++){
+            if (needed[di+1][dj+1] && find_chunk(sp, row+di, col+dj) == NULL){
+                add_chunk(sp, row+di, col+dj);
+            }
+        }
+    }
+}
+
+static long long step_chunk(const SparsePlane *sp, Chunk *chunk, unsigned birth_mask, unsigned survive_mask,
+                            StepCounts *counts){
+    /*
+    Calculate the next generation of a chunk. Return the number of living cells in it.
+    - The rows above and below and the columns either side are taken from the 8 neighbouring chunks
+    - The births and deaths of the chunk are added to counts if sp->count_changes is set, and its bounding box
+      widened to the chunk's living cells
+    */
+    const Chunk *around[3][3]; // [row offset+1][col offset+1], NULL where no chunk is allocated
+    for (int di = -1; di <= 1; di++){
+        for (int dj = -1; dj <= 1; dj++){
+            around[di+1][dj+1] = (di == 0 && dj == 0) ? chunk : find_chunk(sp, chunk->row+di, chunk->col+dj);
+        }
+    }
+
+    // Rows -1 to CHUNK_SIZE of the chunk, with the bits just west and east of each row
+    uint64_t rows[CHUNK_SIZE+2], west[CHUNK_SIZE+2], east[CHUNK_SIZE+2];
+    for (int r = -1; r <= CHUNK_SIZE; r++){
+        int di = (r < 0) ? 0 : (r < CHUNK_SIZE) ? 1 : 2; // which row of chunks holds row r
+        int rr = r & (CHUNK_SIZE-1); // row within that chunk
+        rows[r+1] = (around[di][1] != NULL) ? around[di][1]->cells[rr] : 0;
+        west[r+1] = (around[di][0] != NULL) ? around[di][0]->cells[rr] >> (CHUNK_SIZE-1) : 0; // last column
+        east[r+1] = (around[di][2] != NULL) ? (around[di][2]->cells[rr] & 1) << (CHUNK_SIZE-1) : 0; // first column
+    }
+
+    long long cells_alive = 0;
+    for (int r = 1; r <= CHUNK_SIZE; r++){
+        const uint64_t a = rows[r-1], c = rows[r], b = rows[r+1];
+        uint64_t out = step_word((a << 1) | west[r-1], a, (a >> 1) | east[r-1],
+                                 (c << 1) | west[r], c, (c >> 1) | east[r],
+                                 (b << 1) | west[r+1], b, (b >> 1) | east[r+1],
+                                 birth_mask, survive_mask);
+        chunk->next[r-1] = out;
+        cells_alive += __builtin_popcountll(out);
+        if (sp->count_changes){
+            counts->births += __builtin_popcountll(out & ~c);
+            counts->deaths += __builtin_popcountll(c & ~out);
+        }
+        if (out != 0){
+            long long i = chunk->row*CHUNK_SIZE + r-1;
+            long long j_first = chunk->col*CHUNK_SIZE + __builtin_ctzll(out);
+            long long j_last = chunk->col*CHUNK_SIZE + (CHUNK_SIZE-1 - __builtin_clzll(out));
+            counts->min_row = (i < counts->min_row) ? i : counts->min_row;
+            counts->max_row = (i > counts->max_row) ? i : counts->max_row;
+            counts->min_col = (j_first < counts->min_col) ? j_first : counts->min_col;
+            counts->max_col = (j_last > counts->max_col) ? j_last : counts->max_col;
+        }
+    }
+    return cells_alive;
+}
+
+// Shared by the stripes of step_sparse
+typedef struct sparse_task{
+    SparsePlane *sp;
+    unsigned birth_mask, survive_mask;
+    long long *cells_alive; // living cells counted by each stripe
+    StepCounts *counts; // births, deaths and bounding box of each stripe
+}SparseTask;
+
+static void sparse_stripe(void *arg, int stripe, int n_stripes){
+    // Calculate the next generation of one share of the chunks
+    SparseTask *task = (SparseTask *)arg;
+    int begin, end;
+    stripe_range((int)task->sp->n_chunks, stripe, n_stripes, &begin, &end);
+
+    long long cells_alive = 0;
+    clear_step_counts(&task->counts[stripe]);
+    for (int k = begin; k < end; k++){
+        cells_alive += step_chunk(task->sp, task->sp->chunks[k], task->birth_mask, task->survive_mask,
+                                  &task->counts[stripe]);
+    }
+    task->cells_alive[stripe] = cells_alive;
+}
+
+long long step_sparse(SparsePlane *sp, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool){
+    /*
+    Advance the plane by one generation. Return the number of living cells after the update.
+    Inputs: sp - plane (declared by create_sparse)
+            birth_mask, survive_mask - the game rule (see parse_rule), without B0 as the empty plane has to stay empty
+            pool - threads to split the chunks between (NULL for a single thread)
+    - There are no boundaries, the plane grows and shrinks with the pattern
+    - Leave sp->counts, the bounding box of the living cells of the generation and, if sp->count_changes is set,
+      its births and deaths (otherwise -1)
+    */
+    size_t n_chunks = sp->n_chunks; // chunks added below have no living cells to add neighbours for
+    for (size_t k = 0; k < n_chunks; k++){
+        add_neighbour_chunks(sp, sp->chunks[k]);
+    }
+
+    int n_stripes = (pool != NULL) ? pool->n_threads : 1;
+    long long stripe_alive[n_stripes];
+    StepCounts stripe_counts[n_stripes];
+    SparseTask task = {sp, birth_mask, survive_mask, stripe_alive, stripe_counts};
+    run_thread_pool(pool, sparse_stripe, &task);
+
+    long long cells_alive = 0;
+    clear_step_counts(&sp->counts);
+    for (int k = 0; k < n_stripes; k++){ // combine the counts of each stripe
+        cells_alive += stripe_alive[k];
+        add_step_counts(&sp->counts, &stripe_counts[k]);
+    }
+    if (!sp->count_changes){
+        sp->counts.births = sp->counts.deaths = -1;
+    }
+
+    for (size_t k = sp->n_chunks; k-- > 0;){ // backwards, as removing a chunk moves the last one into its place
+        Chunk *chunk = sp->chunks[k];
+        uint64_t any_alive = 0;
+        for (int r = 0; r < CHUNK_SIZE; r++){
+            chunk->cells[r] = chunk->next[r]; // the next generation becomes the current one
+            any_alive |= chunk->next[r];
+        }
+        if (any_alive == 0){
+            remove_chunk(sp, chunk);
+        }
+    }
+
+    // Shrink the hash table once it is mostly empty, so memory follows the population down as well as up
+    if (sp->table_size > SPARSE_MIN_TABLE && 8*sp->n_chunks < sp->table_size){
+        resize_table(sp, sp->table_size/2);
+    }
+    return cells_alive;
+}
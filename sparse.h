@@ -0,0 +1,56 @@
+/*
+* Unbounded sparse plane for Conway's Game of Life
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: The plane is infinite in every direction. Only chunks of CHUNK_SIZE x CHUNK_SIZE cells containing
+              living cells (or next to one which does) are stored, each bit-packed as one uint64_t word per row.
+              The chunks are found through an open-addressing hash table keyed by the chunk coords.
+              A chunk is allocated when a living cell reaches its edge and freed as soon as it is empty, so memory
+              grows with the living population rather than with the area the pattern has travelled over.
+              Gliders and spaceships fly off forever instead of wrapping around or hitting a boundary.
+ */
+
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include <stdint.h>
+
+#include "conway.h"
+#include "bitboard.h"
+#include "thread_pool.h"
+
+#define CHUNK_SIZE 64 // Rows and columns of cells in each chunk (one 64 bit word per row)
+
+// Define a structure with alias 'Chunk' for a CHUNK_SIZE x CHUNK_SIZE square of the plane
+typedef struct chunk{
+    long long row, col; // chunk coords, the chunk holds cells row*CHUNK_SIZE to row*CHUNK_SIZE+CHUNK_SIZE-1 (same for col)
+    uint64_t cells[CHUNK_SIZE]; // current generation, column j of a row is bit j of its word
+    uint64_t next[CHUNK_SIZE]; // next generation, written before the chunks are updated
+    size_t index; // position in SparsePlane.chunks
+}Chunk;
+
+// Define a structure with alias 'SparsePlane' for the chunks of the plane and the table to look them up
+typedef struct sparse_plane{
+    Chunk **table; // open-addressing hash table of chunks (NULL for an empty slot), linear probing
+    size_t table_size; // number of slots (power of 2), kept at least twice the number of chunks
+    Chunk **chunks; // every chunk, in no particular order
+    size_t n_chunks; // number of chunks allocated
+    size_t max_chunks; // size of the chunks array
+    StepCounts counts; // births, deaths and bounding box of the last generation (see step_sparse)
+    int count_changes; // 1 to count births and deaths in counts
+}SparsePlane;
+
+// Prototype function definitions
+SparsePlane* create_sparse(void); // empty plane
+void free_sparse(SparsePlane *sp);
+void set_sparse_cell(SparsePlane *sp, long long row, long long col, int alive);
+int get_sparse_cell(const SparsePlane *sp, long long row, long long col);
+long long count_sparse(const SparsePlane *sp); // number of living cells
+SparsePlane* sparse_from_cells(const Board *board); // board cell (i,j) is placed at row i, column j
+void sparse_to_cells(const SparsePlane *sp, Board *board, long long row0, long long col0); // window with top left at (row0,col0)
+void sparse_to_bitboard(const SparsePlane *sp, BitBoard *bb, long long row0, long long col0);
+long long step_sparse(SparsePlane *sp, unsigned birth_mask, unsigned survive_mask, ThreadPool *pool);
+
+#endif // SPARSE_H
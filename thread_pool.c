@@ -0,0 +1,156 @@
+/*
+* Persistent pool of worker threads for stepping the board in horizontal stripes
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h> // sysconf
+
+#include "thread_pool.h"
+
+typedef struct worker_arg{ // argument handed to each worker when it is started
+    ThreadPool *pool;
+    int stripe;
+}WorkerArg;
+
+static void* worker_main(void *arg){
+    // Loop forever waiting for a task, run it for this worker's stripe and report back when done
+    WorkerArg *worker = (WorkerArg *)arg;
+    ThreadPool *pool = worker->pool;
+    int stripe = worker->stripe;
+    free(worker);
+
+    unsigned long n_seen = 0; // tasks this worker has run
+    pthread_mutex_lock(&pool->lock);
+    while (1){
+        while (pool->n_tasks == n_seen && !pool->quit){ // sleep until a new task is posted
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->quit){
+            break;
+        }
+        n_seen = pool->n_tasks;
+        StripeTask task = pool->task;
+        void *task_arg = pool->arg;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(task_arg, stripe, pool->n_threads); // run the stripe without holding the lock
+
+        pthread_mutex_lock(&pool->lock);
+        pool->n_running--;
+        if (pool->n_running == 0){ // last stripe done
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool* create_thread_pool(int n_threads){
+    /*
+    Start a pool of n_threads-1 workers which, with the calling thread, step n_threads stripes.
+    - Error checks for memory and thread creation
+    - Return pointer to the pool
+    */
+    if (n_threads < 1){
+        n_threads = 1;
+    }
+    ThreadPool *pool = (ThreadPool *)malloc(sizeof(ThreadPool));
+    if (pool == NULL){
+        printf("[ERROR] Out of memory whilst creating the thread pool\n");
+        exit(EXIT_FAILURE);
+    }
+    pool->n_threads = n_threads;
+    pool->task = NULL;
+    pool->arg = NULL;
+    pool->n_tasks = 0;
+    pool->n_running = 0;
+    pool->quit = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    pool->workers = (pthread_t *)malloc(n_threads * sizeof(pthread_t));
+    if (pool->workers == NULL){
+        printf("[ERROR] Out of memory whilst creating the thread pool\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 1; k < n_threads; k++){ // stripe 0 is run by the calling thread
+        WorkerArg *worker = (WorkerArg *)malloc(sizeof(WorkerArg));
+        if (worker == NULL){
+            printf("[ERROR] Out of memory whilst creating the thread pool\n");
+            exit(EXIT_FAILURE);
+        }
+        worker->pool = pool;
+        worker->stripe = k;
+        if (pthread_create(&pool->workers[k-1], NULL, worker_main, worker) != 0){
+            printf("[ERROR] Could not start worker thread %d\n", k);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return pool;
+}
+
+void run_thread_pool(ThreadPool *pool, StripeTask task, void *arg){
+    /*
+    Run task for every stripe in parallel and wait for all of them to finish.
+    Inputs: pool - thread pool (declared by create_thread_pool), NULL to run a single stripe on this thread
+            task - function to run for each stripe
+            arg - argument passed to every stripe
+    */
+    if (pool == NULL || pool->n_threads == 1){
+        task(arg, 0, 1);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->n_running = pool->n_threads - 1;
+    pool->n_tasks++;
+    pthread_cond_broadcast(&pool->start); // wake up the workers
+    pthread_mutex_unlock(&pool->lock);
+
+    task(arg, 0, pool->n_threads); // calling thread takes the first stripe
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->n_running > 0){ // wait for the other stripes
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void free_thread_pool(ThreadPool *pool){
+    // Stop the workers and free the pool
+    if (pool == NULL){
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int k = 1; k < pool->n_threads; k++){
+        pthread_join(pool->workers[k-1], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->workers);
+    free(pool);
+}
+
+int default_n_threads(void){
+    // Return the number of processors online, used when no thread count is given
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+}
+
+void stripe_range(int n_rows, int stripe, int n_stripes, int *row_begin, int *row_end){
+    /*
+    Split n_rows into n_stripes horizontal stripes of (nearly) equal height.
+    Inputs: stripe - index of the stripe, 0 to n_stripes-1
+            *row_begin, *row_end - set to the first row of the stripe and one past its last row
+    */
+    *row_begin = (int)((long long)n_rows * stripe / n_stripes);
+    *row_end = (int)((long long)n_rows * (stripe+1) / n_stripes);
+}
@@ -0,0 +1,41 @@
+/*
+* Persistent pool of worker threads for stepping the board in horizontal stripes
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: The workers are started once and then sleep until given a task. run_thread_pool runs the task
+              once for every stripe (one stripe per thread, the calling thread takes stripe 0) and returns
+              when all stripes have finished, so each call is one barrier between generations.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+
+// Task run for one stripe of the board. arg is shared by all stripes.
+typedef void (*StripeTask)(void *arg, int stripe, int n_stripes);
+
+// Define a structure with alias 'ThreadPool' for the workers and the task they are running
+typedef struct thread_pool{
+    int n_threads; // number of stripes, including the calling thread
+    pthread_t *workers; // n_threads-1 worker threads
+    pthread_mutex_t lock;
+    pthread_cond_t start; // signalled when a new task is posted
+    pthread_cond_t done; // signalled when the last stripe finishes
+    StripeTask task; // current task and its argument
+    void *arg;
+    unsigned long n_tasks; // number of tasks posted so far, workers wait for this to change
+    int n_running; // workers still running the current task
+    int quit; // flag to stop the workers
+}ThreadPool;
+
+// Prototype function definitions
+ThreadPool* create_thread_pool(int n_threads);
+void run_thread_pool(ThreadPool *pool, StripeTask task, void *arg);
+void free_thread_pool(ThreadPool *pool);
+int default_n_threads(void); // number of processors online
+void stripe_range(int n_rows, int stripe, int n_stripes, int *row_begin, int *row_end);
+
+#endif // THREAD_POOL_H
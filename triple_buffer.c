@@ -0,0 +1,99 @@
+/*
+* Triple buffer of frames passed from the simulation thread to the render thread
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "triple_buffer.h"
+
+TripleBuffer* create_triple_buffer(int n_rows, int n_cols){
+    /*
+    Create the three frames for a board of n_rows*n_cols, with nothing published.
+    - Error checks for memory
+    */
+    TripleBuffer *tb = (TripleBuffer *)malloc(sizeof(TripleBuffer));
+    if (tb == NULL){
+        printf("[ERROR] Out of memory whilst creating the frame buffers\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < 3; k++){
+        tb->frames[k].cells = create_bitboard(n_rows, n_cols);
+        tb->frames[k].generation = 0;
+        tb->frames[k].status[0] = '\0';
+    }
+    tb->back = 0;
+    tb->middle = 1;
+    tb->front = 2;
+    tb->fresh = 0;
+    tb->finished = 0;
+    pthread_mutex_init(&tb->lock, NULL);
+    return tb;
+}
+
+void free_triple_buffer(TripleBuffer *tb){
+    // Free the frames and the buffer
+    for (int k = 0; k < 3; k++){
+        free_bitboard(tb->frames[k].cells);
+    }
+    pthread_mutex_destroy(&tb->lock);
+    free(tb);
+}
+
+Frame* back_frame(TripleBuffer *tb){
+    // Frame owned by the writer, only the writer changes which frame this is
+    return &tb->frames[tb->back];
+}
+
+int frame_taken(TripleBuffer *tb){
+    // 1 if the reader has taken the last frame published (publishing now would not replace one it has not seen)
+    pthread_mutex_lock(&tb->lock);
+    int taken = !tb->fresh;
+    pthread_mutex_unlock(&tb->lock);
+    return taken;
+}
+
+void publish_frame(TripleBuffer *tb, int last){
+    /*
+    Publish the back frame, replacing any frame the reader has not taken yet.
+    Inputs: tb - triple buffer (declared by create_triple_buffer)
+            last - 1 if this is the writer's last frame, so the reader can stop once it has taken it
+    */
+    pthread_mutex_lock(&tb->lock);
+    int swap = tb->back;
+    tb->back = tb->middle;
+    tb->middle = swap;
+    tb->fresh = 1;
+    tb->finished = last;
+    pthread_mutex_unlock(&tb->lock);
+}
+
+const Frame* take_frame(TripleBuffer *tb, int *finished){
+    /*
+    Take the newest frame published. Return NULL if none has been published since the last call.
+    Inputs: tb - triple buffer (declared by create_triple_buffer)
+            *finished - set to 1 if the writer has published its last frame (checked with the same lock, so when it
+                        is 1 and NULL is returned, there are no more frames to come)
+    - The frame returned stays unchanged until the next call
+    */
+    pthread_mutex_lock(&tb->lock);
+    const Frame *frame = NULL;
+    if (tb->fresh){
+        int swap = tb->front;
+        tb->front = tb->middle;
+        tb->middle = swap;
+        tb->fresh = 0;
+        frame = &tb->frames[tb->front];
+    }
+    *finished = tb->finished;
+    pthread_mutex_unlock(&tb->lock);
+    return frame;
+}
+
+void reopen_triple_buffer(TripleBuffer *tb){
+    // Clear the finished flag before the writer starts again
+    pthread_mutex_lock(&tb->lock);
+    tb->finished = 0;
+    pthread_mutex_unlock(&tb->lock);
+}
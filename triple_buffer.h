@@ -0,0 +1,48 @@
+/*
+* Triple buffer of frames passed from the simulation thread to the render thread
+* Author: Lewis Howell, ljh252@exeter.ac.uk, 670023355
+*/
+
+/*
+ Description: Three bit-packed copies of the board. The writer (simulation) fills the back frame and publishes it,
+              swapping it with the middle frame. The reader (renderer) takes the middle frame whenever a new one has
+              been published, swapping it with the front frame it draws from. Neither side ever waits for the other:
+              the lock is only held to swap two indices, so the simulation runs at its own speed and the renderer
+              always draws the newest finished generation.
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <pthread.h>
+
+#include "bitboard.h"
+
+#define FRAME_STATUS_LENGTH 128 // longest status line kept with a frame
+
+// Define a structure with alias 'Frame' for one generation ready to draw
+typedef struct frame{
+    BitBoard *cells; // bit-packed copy of the board
+    long long generation;
+    char status[FRAME_STATUS_LENGTH]; // line shown below the board
+}Frame;
+
+// Define a structure with alias 'TripleBuffer' for the three frames and which side owns each one
+typedef struct triple_buffer{
+    Frame frames[3];
+    int back, middle, front; // indices of the frames owned by the writer, in between, and owned by the reader
+    int fresh; // 1 if the middle frame has been published and not yet taken by the reader
+    int finished; // 1 once the writer has published its last frame
+    pthread_mutex_t lock;
+}TripleBuffer;
+
+// Prototype function definitions
+TripleBuffer* create_triple_buffer(int n_rows, int n_cols);
+void free_triple_buffer(TripleBuffer *tb);
+Frame* back_frame(TripleBuffer *tb); // frame for the writer to fill
+int frame_taken(TripleBuffer *tb); // 1 if the reader has taken the last frame published
+void publish_frame(TripleBuffer *tb, int last); // last - 1 if the writer will publish no more frames
+const Frame* take_frame(TripleBuffer *tb, int *finished); // newest frame published, NULL if none since the last call
+void reopen_triple_buffer(TripleBuffer *tb); // clear the finished flag before the writer starts again
+
+#endif // TRIPLE_BUFFER_H